@@ -0,0 +1,50 @@
+@echo off
+rem Scans every sample program in place on a single thread and again on
+rem multiple threads, the two lots of tokens must be identical. Each sample is
+rem doubled up until it's over 1MB so it's big enough to be split between
+rem threads, on a machine with a single processor both scans are serial.
+setlocal
+
+set COMPILER=%~dp0..\Compiler_d.exe
+set WORKDIR=%TEMP%\compare_lexers
+set FAILURES=0
+
+if not exist "%WORKDIR%" mkdir "%WORKDIR%"
+
+for %%F in ("%~dp0*.txt") do call :compare "%%~fF"
+call :compare "%~dp0..\prog.txt"
+call :compare "%~dp0..\fp_test.txt"
+call :compare "%~dp0..\..\..\product evaluation\quicksort\quicksort.txt"
+call :compare "%~dp0..\..\..\product evaluation\bubblesort\bubblesort.txt"
+
+echo %FAILURES% sample(s) scanned differently
+pause
+exit /b %FAILURES%
+
+:compare
+if %~z1 EQU 0 goto :eof
+copy /y %1 "%WORKDIR%\sample.txt" > nul
+pushd "%WORKDIR%"
+
+:grow
+for %%S in (sample.txt) do if %%~zS GEQ 1048576 goto scan
+copy /y /b sample.txt+sample.txt doubled.txt > nul
+move /y doubled.txt sample.txt > nul
+goto grow
+
+:scan
+del /q Tokens.txt serial_tokens.txt 2> nul
+"%COMPILER%" sample.txt --dump-tokens --map-source > nul
+move /y Tokens.txt serial_tokens.txt > nul
+"%COMPILER%" sample.txt --dump-tokens --parallel-lex > nul
+fc /b serial_tokens.txt Tokens.txt > nul
+
+if errorlevel 1 (
+	echo FAILED: %~1
+	set /a FAILURES+=1
+) else (
+	echo passed: %~nx1
+)
+
+popd
+goto :eof
@@ -7,8 +7,7 @@
 #ifndef __CCODEGENERATOR_H__
 #define __CCODEGENERATOR_H__
 
-//forward decls
-class CTreeNode;
+#include "CTreeVisitor.h"
 
 //pretty much every instruction we generate doesn't allow
 //both of their operands to be in memory so we use this structure
@@ -20,8 +19,40 @@ struct InsnOp_t
 	bool InMemory;
 };
 
-class CCodeGenerator
+class CCodeGenerator;
+
+//works out where the value of an expression operand lives for
+//CCodeGenerator::ProcessExprOperand, filling in Op as it goes
+class COperandFinder : public CTreeVisitor<COperandFinder>
 {
+	friend class CTreeVisitor<COperandFinder>;
+
+public:
+	COperandFinder(CCodeGenerator &Gen, InsnOp_t &Op) : m_Gen(Gen), m_Op(Op) {};
+
+private:
+	//handlers for each type of node which can be an operand
+	void VisitVarDecl(CVarDeclTreeNode *VarDecl);
+	void VisitArrayRef(CArrayRefTreeNode *Ref);
+	void VisitLiteral(CLiteralTreeNode *Lit);
+	void VisitIdentifier(CIdentifierTreeNode *Id);
+	void VisitParameterDecl(CParameterDeclTreeNode *ParmDecl);
+	void VisitUnaryExpr(CUnaryExprTreeNode *Expr);
+	void VisitLiteralRef(CLiteralRefTreeNode *Ref);
+	void VisitNode(CTreeNode *Node);
+
+	//the code generator we're finding the operand for
+	CCodeGenerator &m_Gen;
+
+	//where the location of the operand is recorded
+	InsnOp_t &m_Op;
+};
+
+class CCodeGenerator : public CTreeVisitor<CCodeGenerator>
+{
+	friend class CTreeVisitor<CCodeGenerator>;
+	friend class COperandFinder;
+
 public:
 	CCodeGenerator(void) : m_CurrStmtNo(0) {};
 	~CCodeGenerator(void) {};
@@ -30,15 +61,48 @@ public:
 	//machine instructions, ouputting them to the specified file
 	void AssembleMIRTree(const string &OutputFile, CTreeNode *MirTree);
 
+	//start generating code for a program one global declaration at a time.
+	//The .data and .bss sections come first in the file but aren't complete
+	//until the last function's been lowered, so the code for the functions
+	//is kept in a temporary file until FinishAssembly is called
+	void BeginAssembly(const string &OutputFile);
+
+	//generate the code for a single global declaration in MIR form, in the
+	//same order as they appear in the program
+	void AssembleGlobalDecl(CTreeNode *Decl);
+
+	//write the data sections followed by the code for each function to the
+	//file passed to BeginAssembly, then remove the temporary file
+	void FinishAssembly(void);
+
+	//give up on the code started by BeginAssembly and remove the temporary file
+	void AbandonAssembly(void);
+
 private:
 
 	//output the data sections .data and .bss
 	void OutputDataSections(void);
 
+	//output the start of the .text section up to the first function
+	void OutputTextSectionHeader(void);
+
 	//look at the statement Stmt and delegate the code generation to 
 	//the necessary function that can handle it
 	void GenerateCodeForStatement(CTreeNode *Stmt);
 
+	//handlers GenerateCodeForStatement dispatches each type of stmt to
+	void VisitArrayDecl(CArrayDeclTreeNode *ArrDecl) {};
+	void VisitVarDecl(CVarDeclTreeNode *VarDecl) {};
+	void VisitAssignExpr(CAssignExprTreeNode *AssignExpr);
+	void VisitArithExpr(CArithExprTreeNode *Expr);
+	void VisitIfStmt(CIfStmtTreeNode *Stmt);
+	void VisitLabel(CLabelTreeNode *Label);
+	void VisitGotoExpr(CGotoExprTreeNode *Goto);
+	void VisitCallExpr(CCallExprTreeNode *Expr);
+	void VisitUnaryExpr(CUnaryExprTreeNode *Expr);
+	void VisitReturnStmt(CReturnStmtTreeNode *Stmt);
+	void VisitNode(CTreeNode *Node);
+
 	//specialist functions to handle the code gen for a specific stmt type
 	void GenerateCodeForAssignExpr(CTreeNode *AssignExpr);
 	void GenerateCodeForArithExpr(CTreeNode *Expr);
@@ -90,9 +154,18 @@ private:
 	//store the value of an array element to the top of the stack
 	void CalcArrayElementAddress(CTreeNode *ArrayRef, bool SaveEax);
 
+	//get the memory operand for an array element whose index is a literal,
+	//returns false if the address has to be calculated at run time instead
+	bool GetArrayElementLocation(CTreeNode *ArrayRef, InsnOp_t &Op);
+
 	//handle to the file we're outputting to
 	ofstream m_OutputFile;
 
+	//when generating code one declaration at a time, the name of the final
+	//assembly file and the temporary file the functions are written to
+	string m_AsmFileName;
+	string m_TextFileName;
+
 	//the current stmt number we're processing. Used for detecting
 	//when to load a spilled value from the stack frame rather than
 	//it's allocated register
@@ -98,6 +98,22 @@ public:
 	 */
 	void OutputExternDeclarations(ofstream &FileHandle);
 
+	/**
+	 * Read or write the contents of the store through an archive, this is
+	 * how it's saved along with the MIR in the MIR cache and restored again.
+	 * @param Ar The archive to transfer through, see CMirCache.h.
+	 */
+	template<typename Archive>
+	void Transfer(Archive &Ar)
+	{
+		Ar.StringMap(m_StrLiterals);
+		Ar.StringMap(m_FpLiterals);
+		Ar.Int(m_NextStrRef);
+		Ar.Int(m_NextFpRef);
+		Ar.NodeList(m_VarDecls);
+		Ar.StringList(m_BuiltinFuncs);
+	}
+
 private:
 
 	/**
@@ -10,6 +10,9 @@
 //forward decls
 class CMIRTreeRewriter;
 class CTreeNode;
+class CInternalErrorException;
+class CMirCache;
+class CCodeGenerator;
 
 /**
  * The main workhorse of the compiler. This is where each pass is executed
@@ -21,7 +24,7 @@ class CCompilerDriver
 {
 public:
 	CCompilerDriver(void);
-	~CCompilerDriver(void) {};
+	~CCompilerDriver(void);
 
 	/**
 	 * Compile a single input file.
@@ -44,12 +47,67 @@ private:
 	/** Cleanup any dump files from a previous run. */
 	void DeleteOldDumpFiles(void);
 
+	/**
+	 * Scan the input file on it's own and write each token to Tokens.txt,
+	 * using the same scanner options the parser will. This is how the
+	 * different scanners are checked against each other.
+	 */
+	void DumpTokens(void);
+
+	/**
+	 * Keep compiling the input file each time it's changed until the 
+	 * compiler is killed. The same parser is used each time so it only 
+	 * needs to parse the parts of the file which have changed.
+	 */
+	void WatchInputFile(void);
+
 	/**
 	 * First pass: parsing and semantic analysis.
 	 * @return Parse tree representation of the source code.
 	 */
 	CTreeNode* RunParser(void);
 
+	/**
+	 * Dump the parse tree to ParseTree.xml if it's been asked for.
+	 * @param ParseTree The parse tree contructed during the first pass.
+	 */
+	void DumpParseTree(CTreeNode *ParseTree);
+
+	/**
+	 * Run the second to sixth passes on a parse tree.
+	 * @param ParseTree The parse tree contructed during the first pass.
+	 * @param DestroyParseTree True to destroy the parse tree once we're 
+	 *        done with it.
+	 */
+	void CompileParseTree(CTreeNode *ParseTree, bool DestroyParseTree);
+
+	/**
+	 * Run the third to sixth passes on a MIR tree, then release it.
+	 * @param MirTree The MIR representation of the program.
+	 */
+	void CompileMirTree(CTreeNode *MirTree);
+
+	/**
+	 * Compile the input file one global declaration at a time, each one
+	 * goes through every pass and is released before the next is parsed.
+	 * Only the global data and the signature of each function are kept
+	 * until the end, so the memory used depends on the size of the largest
+	 * function rather than the whole program.
+	 * @return True if the assembly file was generated.
+	 */
+	bool StreamSourceFile(void);
+
+	/**
+	 * Run the second to sixth passes on a single global declaration,
+	 * leaving it's symbol pointing at a copy of the declaration on the heap.
+	 * @param Decl The declaration, in the parse tree's arena.
+	 * @param Globals Where the copy of the declaration is added.
+	 * @param CodeGen The code generator for the program.
+	 * @param MirTreeOut The MIR dump file, if it's been asked for.
+	 */
+	void CompileGlobalDecl(CTreeNode *Decl, CTreeNode *Globals, 
+	                       CCodeGenerator &CodeGen, ofstream &MirTreeOut);
+
 	/**
 	 * Second pass: rewrite the parse tree into MIR form.
 	 * @param ParseTree The parse tree contructed during the first pass.
@@ -57,6 +115,19 @@ private:
 	 */
 	CTreeNode *RewriteIntoMIRForm(CTreeNode *ParseTree);
 
+	/**
+	 * Forward the values held in compiler temporaries and remove the
+	 * temporaries which aren't needed, done as part of the second pass.
+	 * @param MirTree The MIR representation of the program.
+	 */
+	void RunCopyPropagator(CTreeNode *MirTree);
+
+	/**
+	 * Dump the MIR tree to MirTreeDump.txt if it's been asked for.
+	 * @param MirTree The MIR representation of the program.
+	 */
+	void DumpMirTree(CTreeNode *MirTree);
+
 	/**
 	 * Third pass: construction of CFG for data flow analysis.
 	 * @param MirTree The MIR representation of the program.
@@ -91,6 +162,12 @@ private:
 	/** Release the global singleton objects. */
 	void DeleteSingletons(void);
 
+	/**
+	 * Tell the user about an internal compiler error.
+	 * @param Err Details of the error.
+	 */
+	void ReportInternalError(CInternalErrorException &Err);
+
 	/**
 	 * Execute a program (either the assembler or linker) and
 	 * check it's exit code. Returns true if the program exited 
@@ -100,6 +177,9 @@ private:
 	 */
 	bool ExecuteProgram(const string &Prog);
 
+	/** True to dump the tokens the scanner produces for the input file. */
+	bool m_DumpTokens;
+
 	/** True to dump the parse tree representation of the program. */
 	bool m_DumpParseTree;
 
@@ -124,6 +204,27 @@ private:
 	/** True if we've been asked to save the generated assembly file. */
 	bool m_SaveAsmFile;
 
+	/** True to map the input file into memory and scan it in place. */
+	bool m_MapSourceFile;
+
+	/** True to scan large input files on multiple threads. */
+	bool m_ParallelLex;
+
+	/** True to have the scanner use it's transition table. */
+	bool m_TableScanner;
+
+	/** True to recompile the input file every time it's changed. */
+	bool m_WatchInputFile;
+
+	/** True to reuse the MIR lowered from an identical source file. */
+	bool m_UseMirCache;
+
+	/** True to compile each function as soon as it's been parsed. */
+	bool m_StreamFunctions;
+
+	/** Cache of lowered MIR trees, NULL unless it's being used. */
+	CMirCache *m_MirCache;
+
 	/** Input file we're compiling. */
 	string m_InputFile;
 
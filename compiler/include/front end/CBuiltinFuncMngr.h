@@ -45,6 +45,16 @@ public:
 
 private:
 
+	/**
+	 * Bind a builtin function decl to it's symbol. When parsing a new symbol 
+	 * is added for it, in the MIR the symbol the parser bound calls to is 
+	 * pointed at the MIR decl instead.
+	 * @param Name Name of the builtin function.
+	 * @param FnDecl The function decl created for it.
+	 * @param InMir True if the decl is being created for the MIR.
+	 */
+	void BindBuiltin(const string &Name, CFunctionDeclTreeNode *FnDecl, bool InMir);
+
 	/**
 	 * List of builtin functions keyed by their name. The value
 	 * part of the map is the parameter type the function expects
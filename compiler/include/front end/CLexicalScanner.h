@@ -9,8 +9,6 @@
 
 #include "TokenTypes.h"
 
-typedef map<string, TokenType> TokenMap;
-
 /**
  * Definition of a token scanned from the input file. This is the 
  * representation used throughout the rest of the front-end for dealing
@@ -26,16 +24,27 @@ struct Token_t
 
 	/** What type of token this is. */
 	TokenType Type;
+
+	/**
+	 * When the scanner is reading from a mapped file this points at the
+	 * first character of the token inside the mapped view, otherwise it's
+	 * NULL. The span is only valid for as long as the scanner which 
+	 * produced the token.
+	 */
+	const char *SrcSpan;
+
+	/** Number of characters covered by SrcSpan. */
+	long SrcSpanLength;
 };
 
 /**
  * A simple deterministic based automaton to handle the recognition of the 
- * various tokens that the language defines. To make recognition easier we 
- * store the string of each token alongside it's type in a std::map so once
- * a token has been scanned, we can determine it's type in constant time. To
- * add a new token to the scanner add a new enumeration value for it in 
- * TokenTypes.h and add code to one of the InitialiseXXX functions to add it
- * to the token map so it will be recognised. 
+ * various tokens that the language defines. Once a token has been scanned it's
+ * type is determined by switching on it's length and leading character so at 
+ * most a couple of string comparisons are needed and nothing gets allocated.
+ * To add a new token to the scanner add a new enumeration value for it in 
+ * TokenTypes.h and add a case for it to either ClassifyWord or 
+ * ClassifyOperator so it will be recognised. 
  * <br><br>
  * Internally the scanner buffers it's input to minimise the amount of file
  * operations required. The exact size of the buffer is controlled by
@@ -44,6 +53,41 @@ struct Token_t
  * buffer could improve performance at the expense of more memory used whilst a 
  * smaller buffer lessens memory requirements but impacts performance as it will
  * need to be refreshed more often.
+ * <br><br>
+ * For large input files the scanner can instead map the whole file into memory
+ * and scan it in place. In this mode there's no buffer to refresh and the 
+ * characters making up a token aren't copied one at a time as it's scanned, 
+ * instead each token is handed out as a span pointing straight into the 
+ * mapped view.
+ * <br><br>
+ * As the whole file is available up front when it's mapped, every token is
+ * scanned in one go when the file is opened. Only the type, position, length
+ * and line number of each token are kept, in separate arrays which are walked
+ * by index as the parser asks for tokens. Peeking and pushing back tokens is
+ * then just a case of moving an index around and looking any number of tokens
+ * ahead costs the same as looking at the next one.
+ * <br><br>
+ * Large mapped files can also be scanned in parallel. The file is split into
+ * chunks at line starts and each chunk is scanned on it's own thread by a 
+ * separate scanner, the results are then stitched together in order. As a 
+ * chunk could turn out to have started inside a comment or string literal, 
+ * each one is checked against where the previous chunk actually finished and 
+ * it's rescanned from there if they don't agree, so the tokens are always the 
+ * same as scanning the file from start to finish.
+ * <br><br>
+ * The scanner can also find where each token ends by walking a transition
+ * table rather than through the hand written ScanXXXToken functions. Each
+ * character is mapped to a class with a single lookup, so it doesn't depend
+ * on the locale like isalpha and isdigit do, and the class and current state
+ * then give the next state. Both tables are built by the compiler so there's 
+ * nothing to set up at runtime.
+ * <br><br>
+ * When the compiler is watching a file for changes, RescanInputFile reads it
+ * in again and only rescans from just before the first changed character. As 
+ * soon as a token is scanned which starts at the same place in the unchanged 
+ * tail of the file as one of the old tokens, the rest of the old tokens are 
+ * kept, moved along by however many characters and lines the edit added or 
+ * removed.
  */
 class CLexicalScanner
 {
@@ -54,9 +98,17 @@ public:
 	/**
 	 * Set the file we're reading tokens from.
 	 * @param File Name of the file we're scanning.
+	 * @param MapFile True to map the whole file into memory and scan it in 
+	 *        place rather than reading it through the input buffer.
+	 * @param ParallelScan True to split a large mapped file into chunks
+	 *        which are scanned on separate threads. Only used if MapFile 
+	 *        is true.
+	 * @param TableDriven True to find the end of each token using the 
+	 *        transition table instead of the hand written scanning functions.
 	 * @return True if the file was opened ok, false on error.
 	 */
-	bool SetInputFile(const string &File);
+	bool SetInputFile(const string &File, bool MapFile = false, 
+	                  bool ParallelScan = false, bool TableDriven = false);
 
 	/** 
 	 * Determine if there are any more tokens to come.
@@ -73,12 +125,20 @@ public:
 	/**
 	 * Take a look at the next token without actually consuming it. This
 	 * will be the next token returned by GetNextToken. This only works for
-	 * a single token lookahead, if more is required then the necessary tokens
-	 * can be reinserted using PushbackToken.
+	 * a single token lookahead, use PeekTokenType to look any further.
 	 * @return A new Token_t object for the peeked token.
 	 */
 	Token_t PeekNextToken(void);
 
+	/**
+	 * Find out the type of a token still to come without consuming it or
+	 * changing which token PeekNextToken will return next.
+	 * @param Ahead Number of tokens past the one GetNextToken would return
+	 *        next, zero to look at that token itself.
+	 * @return The type of the token.
+	 */
+	TokenType PeekTokenType(size_t Ahead = 0);
+
 	/**
 	 * Push a token back into the input stream, this will be the next token
 	 * returned on the next call to GetNextToken or PeekNextToken.
@@ -95,43 +155,219 @@ public:
 	 */
 	long CurrentLineNumber(void);
 
+	/**
+	 * Read the input file in again after it's been changed, only scanning
+	 * the tokens which could have been affected by the change. The file is
+	 * read into memory rather than mapped so it can still be written to. If
+	 * no file has been scanned yet, the whole file is scanned.
+	 * @param File Name of the file we're scanning.
+	 * @param TableDriven True to use the transition table to scan tokens.
+	 * @param DamageStart Set to the index of the first token which was 
+	 *        rescanned.
+	 * @param OldDamageEnd Set to the index of the first of the old tokens 
+	 *        which was kept after the rescanned ones.
+	 * @param NewDamageEnd Set to the index of that same token now.
+	 * @return True if the file was read ok, false on error.
+	 */
+	bool RescanInputFile(const string &File, bool TableDriven, size_t &DamageStart,
+	                     size_t &OldDamageEnd, size_t &NewDamageEnd);
+
+	/**
+	 * Find out which of the buffered tokens GetNextToken will return next.
+	 * @return The index of the next token.
+	 */
+	size_t CurrentTokenIndex(void);
+
+	/**
+	 * Move to a different token in the buffers, discarding any peeked 
+	 * tokens. 
+	 * @param Idx Index of the token GetNextToken should return next.
+	 */
+	void SeekToToken(size_t Idx);
+
+	/**
+	 * Find out which line a buffered token is on.
+	 * @param Idx Index of the token.
+	 * @return The line number of the token.
+	 */
+	long TokenLineNumber(size_t Idx);
+
+	/**
+	 * Hash the text of a range of buffered tokens.
+	 * @param First Index of the first token to hash.
+	 * @param End Index of the token after the last one to hash.
+	 * @return The hash of the tokens.
+	 */
+	unsigned int HashTokens(size_t First, size_t End);
+
 private:
 
-	/** Add any keyword tokens to the token map. */
-	void InitialiseKeywordsList(void);
+	/** Classes of characters which share the same transitions. */
+	enum CharClass
+	{
+		CHARCLASS_OTHER,
+		CHARCLASS_LETTER,
+		CHARCLASS_DIGIT,
+		CHARCLASS_DOT,
+		CHARCLASS_QUOTE,
+		CHARCLASS_EQUALS,
+		CHARCLASS_END,
+
+		NUM_CHARCLASSES
+	};
+
+	/** States of the table driven scanner. */
+	enum ScanState
+	{
+		SCANSTATE_START,
+		SCANSTATE_IDENTIFIER,
+		SCANSTATE_INTEGER,
+		SCANSTATE_FRACTION,
+		SCANSTATE_STRING,
+		SCANSTATE_STRING_END,
+		SCANSTATE_OPERATOR,
+		SCANSTATE_OPERATOR_END,
+
+		NUM_SCANSTATES,
+
+		/** Not a real state, the current character isn't part of the token. */
+		SCANSTATE_DONE = NUM_SCANSTATES
+	};
+
+	/** Eat whitespace and comments which are ignored. */
+	void EatWhitespaceAndComments(void);
+
+	/**
+	 * Scan the next token from the input. The characters making up the 
+	 * token are from m_TokenStart up to m_ForwardPtr when scanning in place,
+	 * otherwise they're in m_CurrTokenStr.
+	 */
+	void ScanToken(void);
 
-	/** Add the variable type tokens to the token map. */
-	void InitialiseTypeTokens(void);
+	/**
+	 * Scan the next token from the input buffer.
+	 * @return A new Token_t object for the scanned token.
+	 */
+	Token_t ScanNextToken(void);
 
-	/** Add the control statement tokens - if/while etc  to the token map */
-	void InitialiseControlStmtTokens(void);
+	/** Scan the whole of a mapped file into the token buffers. */
+	void BufferAllTokens(void);
 
-	/** Add those tokens which are related to functions to the token map. */
-	void InitialiseFunctionTokens(void);
+	/**
+	 * Scan tokens from a mapped file into the token buffers until we run
+	 * out of input or reach a token which starts at or after End.
+	 * @param End First character which is past the range being scanned.
+	 */
+	void BufferTokens(const char *End);
 
-	/** Add any tokens not covered above to the token map. */
-	void InitialiseMiscTokens(void);
+	/**
+	 * Split a mapped file into chunks, scan each of them on a separate
+	 * thread and then stitch the tokens from each one together in order.
+	 * @param NumChunks The number of chunks to split the file into.
+	 */
+	void BufferTokensInParallel(size_t NumChunks);
 
-	/** 
-	 * See if a token value is a keyword. 
-	 * @param TokStr The value of the token being checked.
-	 * @return True if the token's value is a keyword, false if it's not.
+	/**
+	 * Scan the chunk of a mapped file from m_ForwardPtr up to m_ChunkEnd
+	 * into the token buffers, line numbers are counted from the start of 
+	 * the chunk.
 	 */
-	bool IsKeyword(const string &TokStr);
+	void ScanChunk(void);
 
-	/** 
-	 * See if this token is covered by the misc tokens map.
-	 * @param TokStr The token value to check.
-	 * @return True if the token is a misc token, false if it's not.
+	/**
+	 * Entry point for the threads started by BufferTokensInParallel.
+	 * @param Scanner The scanner for the chunk to be scanned.
+	 * @return Always zero.
 	 */
-	bool IsMiscToken(const string &TokStr);
+	static unsigned long __stdcall ScanChunkThread(void *Scanner);
 
-	/** Eat whitespace and comments which are ignored. */
-	void EatWhitespaceAndComments(void);
+	/**
+	 * Build a token from the token buffers.
+	 * @param Idx Index of the token in the buffers.
+	 * @return A new Token_t object for the token, or an empty one if Idx is
+	 *         past the last token in the file.
+	 */
+	Token_t MakeBufferedToken(size_t Idx);
+
+	/**
+	 * Keep track of the furthest token in the buffers that's been handed out
+	 * so CurrentLineNumber behaves as if we were scanning as we went.
+	 * @param Idx Index of the token being handed out.
+	 */
+	void NoteTokenScanned(size_t Idx);
+
+	/**
+	 * Version of EatWhitespaceAndComments for when we're scanning in place.
+	 * As the whole file is in one NULL terminated block we can look at it a
+	 * word at a time rather than one character at a time.
+	 */
+	void EatWhitespaceAndCommentsInPlace(void);
+
+	/**
+	 * Skip a run of whitespace when scanning in place, counting any newlines.
+	 * @param Ptr The first character to look at.
+	 * @return The first character which isn't whitespace.
+	 */
+	const char* SkipWhitespaceInPlace(const char *Ptr);
+
+	/**
+	 * Skip the body of a comment when scanning in place, counting any newlines.
+	 * @param Ptr The first character after the opening comment delimiter.
+	 * @return The first character after the closing comment delimiter or the 
+	 *         NULL terminator if the comment isn't closed.
+	 */
+	const char* SkipCommentInPlace(const char *Ptr);
+
+	/**
+	 * Find which bytes in a word are a particular character.
+	 * @param Word Four characters read from the input in one go.
+	 * @param Ch The character to look for.
+	 * @return A mask with the top bit of each matching byte set.
+	 */
+	static unsigned int MatchBytes(unsigned int Word, char Ch);
+
+	/**
+	 * Count the bytes flagged in a mask returned by MatchBytes.
+	 * @param Mask The mask of matched bytes.
+	 * @return How many bytes were matched.
+	 */
+	static unsigned int CountMatchedBytes(unsigned int Mask);
 
 	/** Refresh the input buffer and reset m_ForwardPtr. */
 	void RefreshInputBuffer(void);
 
+	/**
+	 * Map the entire input file into memory for scanning in place. If 
+	 * the file can't be mapped we fall back to LoadInputFile.
+	 * @param File Name of the file we're scanning.
+	 * @return True if the file was mapped or loaded ok, false on error.
+	 */
+	bool MapInputFile(const string &File);
+
+	/**
+	 * Read the entire input file into a NULL terminated buffer in
+	 * one go for scanning in place.
+	 * @param File Name of the file we're scanning.
+	 * @return True if the file was read ok, false on error.
+	 */
+	bool LoadInputFile(const string &File);
+
+	/** Release the view and handles created by MapInputFile. */
+	void UnmapInputFile(void);
+
+	/**
+	 * Determine if we've consumed every character in the input file.
+	 * @return True if there's nothing left to scan.
+	 */
+	bool InputExhausted(void);
+
+	/**
+	 * Move past the current character, adding it to the token being 
+	 * scanned. When scanning in place the characters aren't copied, the
+	 * token is taken from the mapped view once it's been fully scanned.
+	 */
+	void ConsumeChar(void);
+
 	/**
 	 * Increment the forward pointer and check to see if we've reached
 	 * the end of the input buffer. 
@@ -139,6 +375,13 @@ private:
 	 */
 	char IncForwardPtr(void);
 
+	/**
+	 * Consume the characters making up the next token by walking the 
+	 * transition table, the token is left in the same place as it would be
+	 * by the hand written ScanXXXToken functions.
+	 */
+	void ScanTokenWithTables(void);
+
 	/** 
 	 * Keep consuming characters from the input file until we reach a
 	 * character which isn't part of an identifier. The value of the identifier
@@ -162,19 +405,33 @@ private:
 	void ScanStringToken(void);
 
 	/**
-	 * Determine the type of the token we have in m_CurrTokenStr.
+	 * Determine the type of the token just scanned.
+	 * @param Str The characters making up the token.
+	 * @param Length Number of characters in Str.
 	 * @return The exact type of the token just scanned.
 	 */
-	TokenType GetTokenType(void);
+	TokenType GetTokenType(const char *Str, size_t Length);
 
-	/** Handle to the file we're reading tokens from. */
-	ifstream m_FileHandle;
+	/**
+	 * Determine if a word beginning with a letter or underscore is one of
+	 * the reserved words or just a name.
+	 * @param Str The characters making up the word.
+	 * @param Length Number of characters in Str.
+	 * @return The reserved word's token type or TOKTYPE_ID.
+	 */
+	TokenType ClassifyWord(const char *Str, size_t Length);
 
-	/** Token maps for keywords. */
-	TokenMap m_Keywords;
+	/**
+	 * Determine which operator or punctuation token the characters in 
+	 * Str make up.
+	 * @param Str The characters making up the token.
+	 * @param Length Number of characters in Str.
+	 * @return The operator's token type or TOKTYPE_ID if it's not recognised.
+	 */
+	TokenType ClassifyOperator(const char *Str, size_t Length);
 
-	/** Token map for misc tokens not covered by m_Keywords. */
-	TokenMap m_MiscTokens;
+	/** Handle to the file we're reading tokens from. */
+	ifstream m_FileHandle;
 
 	/**
 	 * Buffer of characters read from the input file in one
@@ -202,15 +459,103 @@ private:
 	/** Current line number we're scanning. */
 	long m_CurrLineNumber;
 
+	/** True if we're scanning a mapped or fully loaded file in place. */
+	bool m_MappedInput;
+
+	/** True to scan tokens using the transition table. */
+	bool m_TableDriven;
+
+	/** The class of every character, indexed by it's unsigned value. */
+	static const unsigned char ms_CharClasses[256];
+
+	/** 
+	 * The state to move to for each state and class of character, or 
+	 * SCANSTATE_DONE if the character ends the token. 
+	 */
+	static const unsigned char ms_Transitions[NUM_SCANSTATES][NUM_CHARCLASSES];
+
+	/** Win32 handle for the file being mapped. */
+	void *m_MappedFile;
+
+	/** Win32 handle for the file mapping object. */
+	void *m_FileMapping;
+
+	/** Start of the mapped view of the input file. */
+	char *m_MappedView;
+
+	/**
+	 * When scanning in place, the position in the mapped view of 
+	 * the first character of the token being scanned.
+	 */
+	const char *m_TokenStart;
+
+	/** First character of the file when scanning in place. */
+	const char *m_InputStart;
+
+	/** Number of characters in the file when scanning in place. */
+	size_t m_InputLength;
+
+	/** True to scan large mapped files on multiple threads. */
+	bool m_ParallelScan;
+
+	/** Files are only split into chunks of at least this many characters. */
+	const size_t m_MinScanChunkSize;
+
+	/** 
+	 * When scanning a chunk of a file, the position of the first token
+	 * in the chunk. 
+	 */
+	const char *m_ChunkStart;
+
+	/** When scanning a chunk of a file, the first character past the chunk. */
+	const char *m_ChunkEnd;
+
+	/** 
+	 * When scanning a chunk of a file, the line number of the first token 
+	 * in the chunk counting from the start of the chunk.
+	 */
+	long m_ChunkFirstLine;
+
 	/**
 	 * If we've peeked at any token, they're stored here until
 	 * we call GetNextToken again in which case we'll pop the top
 	 * token and return that instead of reading from the file.
 	 */
-	list<Token_t> m_PeekedTokens;
+	deque<Token_t> m_PeekedTokens;
+
+	/**
+	 * How many tokens at the front of m_PeekedTokens have been peeked at or
+	 * pushed back and will be discarded by ClearPeekedTokens. There can be
+	 * more tokens than this if PeekTokenType has looked further ahead.
+	 */
+	size_t m_NumPeekedTokens;
+
+	/** Type of each token in a mapped file. */
+	vector<TokenType> m_TokenTypes;
+
+	/** Offset from m_InputStart of each token in a mapped file. */
+	vector<long> m_TokenOffsets;
+
+	/** Number of characters in each token in a mapped file. */
+	vector<long> m_TokenLengths;
+
+	/** Line number of each token in a mapped file. */
+	vector<long> m_TokenLines;
+
+	/** Index of the token GetNextToken will return next from the buffers. */
+	size_t m_NextTokenIdx;
+
+	/** Number of tokens in the buffers which have been handed out so far. */
+	size_t m_NumScannedTokens;
+
+	/** 
+	 * True if we would have skipped the whitespace after the last token 
+	 * handed out if we were scanning as we went. 
+	 */
+	bool m_SkippedToNextToken;
 
-	/** Are we peeking at a token when we call GetNextToken? */
-	bool m_PeekingAtToken;
+	/** Line number of the very end of a mapped file. */
+	long m_EndLineNumber;
 };
 
 #endif
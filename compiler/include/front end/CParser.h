@@ -34,6 +34,43 @@ enum ExprContext
 	EC_FUNCCALLPARMS
 };
 
+/** 
+ * A global declaration kept from the last time a file was parsed so it 
+ * can be reused if it's unaffected by any changes made to the file since.
+ */
+struct ParsedDecl_t
+{
+	/** The tree for the declaration. */
+	CTreeNode *Decl;
+
+	/** Index of the first token of the declaration. */
+	size_t FirstToken;
+
+	/** Index of the token after the last one in the declaration. */
+	size_t EndToken;
+
+	/** Line number the declaration starts on. */
+	long FirstLine;
+
+	/** 
+	 * Hash of each global declaration before this one, if any of them
+	 * change this declaration has to be parsed again.
+	 */
+	unsigned int PrecedingDeclsHash;
+
+	/** Name of the symbol the declaration added to the global scope. */
+	string SymName;
+
+	/** Line number of the symbol. */
+	int SymLine;
+
+	/** Type of the symbol. */
+	TokenType SymType;
+
+	/** Builtin functions called from within the declaration. */
+	vector<string> BuiltinsUsed;
+};
+
 //forward decls
 class CTreeNode;
 class CArrayRefTreeNode;
@@ -53,15 +90,68 @@ class CParser
 {
 public:
 	CParser(void);
-	~CParser(void) {};
+	~CParser(void);
 
 	/**
 	 * Parse a single source file.
 	 * @param InputFile Filename of the file to parse.
+	 * @param MapFile True to have the scanner map the whole file into
+	 *        memory and scan it in place.
+	 * @param ParallelScan True to have the scanner split a large mapped file
+	 *        into chunks and scan them on separate threads.
+	 * @param TableDriven True to have the scanner use it's transition table
+	 *        to find the end of each token.
 	 * @return Parse tree for the file is successfull, NULL if any
 	 *         errors occurred.
 	 */
-	CTreeNode* ParseSourceFile(const string &InputFile);
+	CTreeNode* ParseSourceFile(const string &InputFile, bool MapFile = false,
+	                           bool ParallelScan = false, bool TableDriven = false);
+
+	/**
+	 * Parse a file again after it's been changed. Only the tokens and global
+	 * declarations affected by the changes made since the last time it was
+	 * parsed are scanned and parsed again, the trees for the rest of the
+	 * declarations are reused. A declaration is only reused if it's tokens
+	 * haven't changed and neither has any global declaration before it. The
+	 * first time this is called the whole file is parsed.
+	 * @param InputFile Filename of the file to parse.
+	 * @param TableDriven True to have the scanner use it's transition table
+	 *        to find the end of each token.
+	 * @return Parse tree for the file if successfull, NULL if any errors 
+	 *         occurred. The tree belongs to the parser and must not be
+	 *         destroyed by the caller.
+	 */
+	CTreeNode* ReparseSourceFile(const string &InputFile, bool TableDriven = false);
+
+	/**
+	 * Get ready to parse a source file one global declaration at a time
+	 * with ParseGlobalDecl rather than all at once.
+	 * @param InputFile Filename of the file to parse.
+	 * @param MapFile True to have the scanner map the whole file into
+	 *        memory and scan it in place.
+	 * @param ParallelScan True to have the scanner split a large mapped file
+	 *        into chunks and scan them on separate threads.
+	 * @param TableDriven True to have the scanner use it's transition table
+	 *        to find the end of each token.
+	 * @return True if the file was opened.
+	 */
+	bool BeginSourceFile(const string &InputFile, bool MapFile = false,
+	                     bool ParallelScan = false, bool TableDriven = false);
+
+	/**
+	 * Parse the next global declaration in the file opened by BeginSourceFile.
+	 * The declaration belongs to the caller, it's symbol stays in the global
+	 * scope so the declarations after it can refer to it.
+	 * @param Decl Set to the declaration, or NULL if it had any errors.
+	 * @return False once the end of the file has been reached.
+	 */
+	bool ParseGlobalDecl(CTreeNode *&Decl);
+
+	/**
+	 * See if any errors have been reported while parsing.
+	 * @return True if there's been at least one error.
+	 */
+	bool ErrorsOccurred(void) { return m_ErrorCount > 0; }
 
 private:
 
@@ -243,36 +333,19 @@ private:
 	bool ValidateFuncReturnsInfo(TokenType &RetType);
 
 	/**
-	 * Determine the precedence of an operator. The actual precedences
-	 * of each operator are initialised in the constructor.
-	 * @param Op The operator to get the precedence for.
-	 * @return An integer value representing an operators precedence.
-	 */
-	int OperatorPrecedence(TokenType Op);
-
-	/**
-	 * Reduce the expression on top of the expression stacks.
-	 * @param OpStack Stack of arithmetic/Boolean operators.
-	 * @param ValStack Stack of expression terms representing the values.
-	 * @return True if reduction succeeded, false on error.
+	 * Parse a term followed by any operators which bind at least as tightly 
+	 * as MinBindingPower along with their right hand sides. 
+	 * @param MinBindingPower Binding power of the weakest operator to include.
+	 * @param EndTokenType The token which terminates the whole expression.
+	 * @return A new tree node for the expression, NULL on error.
 	 */
-	bool ReduceExpression(stack<TokenType> &OpStack, stack<CTreeNode*> &ValStack);
-
-	/**
-	 * Destroy the expression stack if we hit an error during
-	 * parsing an expression.
-	 * @param ValStack Value stack to destroy.
-	 */
-	void DestroyExpressionStack(stack<CTreeNode*> &ValStack);
+	CTreeNode* ParseBinaryExpression(int MinBindingPower, TokenType EndTokenType);
 
 	/**
 	 * Helper method for ParseExpression to parse and verify an single term.
-	 * @param OpStack Operator stack to add the next operator to.
-	 * @param ParenLevel The current nesting level of parenthesis which we need
-	 *        to keep up to date when parsing a new expression term.
 	 * @return A new tree node for the term.
 	 */
-	CTreeNode* ParseExpressionTerm(stack<TokenType> &OpStack, int &ParenLevel);
+	CTreeNode* ParseExpressionTerm(void);
 
 	/**
 	 * Perform type checking on an expression to see if it's compatible
@@ -323,40 +396,6 @@ private:
 	 */
 	TokenType ExtractTypeFromGenericExpr(CTreeNode *Expr);
 
-	/**
-	 * Subroutine of ExtractTypeFromGenericExpr to handle
-	 * array references.
-	 * @param ArrRef Array reference tree node to extract the type from.
-	 * @return The type of the array being referenced.
-	 */
-	TokenType ExtractTypeFromArrayRef(CArrayRefTreeNode *ArrRef);
-
-	/**
-	 * Subroutine of ExtractTypeFromGenericExpr to handle identifiers 
-	 * which could refer to functions, variables or parameters.
-	 * @param Ident Identifier to get the type for.
-	 * @return The type of the decl the identifier refers to.
-	 */
-	TokenType ExtractTypeFromIdentifier(CIdentifierTreeNode *Ident);
-
-	/**
-	 * Subroutine of ExtractTypeFromGenericExpr to handle call_exprs. The
-	 * type of call_exprs is the return type of the function being called.
-	 * @param CallExpr Function call expr we're getting the type of.
-	 * @return The return type of the function being called.
-	 */
-	TokenType ExtractTypeFromCallExpr(CCallExprTreeNode *CallExpr);
-
-	/**
-	 * Subroutine of ExtractTypeFromGenericExpr to handle arithmetic expressions.
-	 * If the operator used is a Boolean operator, the whole expression is 
-	 * of type Boolean otherwise the type of an arithmetic expression is 
-	 * defined to be of the type appearing on the LHS.
-	 * @param BinExpr Expr to determine the type of.
-	 * @return The type of the expression.
-	 */
-	TokenType ExtractTypeFromArithExpr(CArithExprTreeNode *BinExpr);
-
 	/**
 	 * Typechecking of parameters appears in three locations, the code for which
 	 * is identical in both cases so it's extracted to a common method here that
@@ -413,6 +452,39 @@ private:
 	 */
 	bool IsFuncDeclAllowed(void);
 
+	/**
+	 * Subroutine of ReparseSourceFile to put back the entries a reused 
+	 * declaration made in the symbol table and global data store when it 
+	 * was first parsed.
+	 * @param Decl The declaration being reused.
+	 * @param FirstToken Index of the first token of the declaration now.
+	 */
+	void ReplayParsedDecl(ParsedDecl_t &Decl, size_t FirstToken);
+
+	/**
+	 * Subroutine of ReparseSourceFile to work out the hash of everything 
+	 * about a global declaration which could affect any of the declarations
+	 * after it.
+	 * @param Decl The declaration just parsed.
+	 * @param FirstToken Index of the first token of the declaration.
+	 * @param EndToken Index of the token after the declaration.
+	 * @return The hash of the declaration.
+	 */
+	unsigned int HashDeclInterface(CTreeNode *Decl, size_t FirstToken, size_t EndToken);
+
+	/**
+	 * Find the name of the symbol declared by a global declaration.
+	 * @param Decl A function, variable or array declaration.
+	 * @return The name of the function, variable or array.
+	 */
+	const string& GetDeclName(CTreeNode *Decl);
+
+	/**
+	 * Destroy all the declarations kept by ReparseSourceFile and the root
+	 * node that held them.
+	 */
+	void DiscardParsedDecls(void);
+
 	/** True if we're in the middle of parsing a function decl */
 	bool m_ParsingFuncDecl;
 
@@ -442,10 +514,19 @@ private:
 	int m_ErrorCount;
 
 	/**
-	 * A hash table of token strings and their equivalent operator precedence
-	 * used for fast look up during expression parsing.
+	 * How tightly each binary operator binds, indexed by token type. Zero
+	 * for anything which isn't a binary operator.
 	 */
-	map<TokenType, int> m_OpPrecs;
+	static const unsigned char ms_BindingPowers[NUM_TOKTYPES];
+
+	/** Global declarations from the last call to ReparseSourceFile. */
+	vector<ParsedDecl_t> m_ParsedDecls;
+
+	/** Root node returned by the last call to ReparseSourceFile. */
+	CTreeNode *m_ParsedRoot;
+
+	/** Builtin functions called since the start of the current declaration. */
+	vector<string> m_BuiltinsUsed;
 };
 
 #endif
@@ -21,24 +21,17 @@ struct Symbol_t
 	/** The name as it appears in the code. */
 	string Name;
 
+	/** Name interned in the atom table, this is what the symbol is keyed on. */
+	Atom NameAtom;
+
 	/** Pointer to the tree node representing the decl being declared. */
 	CTreeNode *IdPtr;
 
 	/** The type of the decl pointed to by IdPtr */
 	TokenType SymType;
-};
-
-//make it easier to change the symbol table data structure
-typedef map<string, Symbol_t> SymbolTableMap;
 
-/** Info about a single scope. */
-struct Scope_t
-{
-	/** Pointer to the previous scope. */
-	Scope_t *ParentScope;
-
-	/** All the symbols declared within this scope. */
-	SymbolTableMap Symbols;
+	/** How deeply nested the scope the symbol was declared in is, 0 for global scope. */
+	int ScopeDepth;
 };
 
 /**
@@ -47,13 +40,19 @@ struct Scope_t
  * is declared is stored within a particular scope with only variables
  * declared inside the current scope, or any directly accessible from it
  * being visible. Once a scope exits, all symbols within it are lost. 
- * Internally the scopes are represented as a singly linked list with pointers
- * to the previous scope stored at each point with the exception of the 
- * global scope which will always have a NULL parent. 
  * <br><br>
- * After the initial parsing phase, the contents of the symbol table are
- * discarded and rebuilt during the subsequent MIR lowering. This is to take
- * into account any new temporaries created during this pass.
+ * Internally there's a single table indexed by atom holding the innermost
+ * visible declaration of each name, so a lookup costs the same however deeply
+ * the scopes are nested. Every symbol added is pushed onto a stack along with 
+ * the declaration it shadowed, popping a scope then only has to walk back over
+ * the symbols added since it was opened, restoring what each one hid.
+ * <br><br>
+ * Names are only resolved once, by the parser. Each identifier it builds 
+ * keeps a pointer to the symbol it was bound to so the symbol objects 
+ * themselves live until the table is destroyed, even after their scope has
+ * closed. MIR lowering points each symbol at the declaration it was lowered
+ * into and adds any compiler temporaries it creates, after which the middle
+ * and back ends follow the bindings rather than looking names up.
  */
 class CSymbolTable : public ISingleton<CSymbolTable>
 {
@@ -79,8 +78,19 @@ public:
 	 * @param Ptr Pointer to the tree node constructed for this symbol.
 	 * @param LineNo Line number the symbol was declared on.
 	 * @param Type The declared type of the symbol being added.
+	 * @return The new symbol, this is what identifiers referring to the
+	 *         declaration should be bound to.
 	 */
-	void AddSymbol(const string &Name, CTreeNode *Ptr, int LineNo, TokenType Type);
+	Symbol_t* AddSymbol(const string &Name, CTreeNode *Ptr, int LineNo, TokenType Type);
+
+	/**
+	 * Add a copy of a symbol which doesn't belong to any scope, such as one
+	 * read back from the MIR cache. It can't be looked up by name, only the
+	 * trees bound to it can see it.
+	 * @param Sym The symbol to copy.
+	 * @return The new symbol.
+	 */
+	Symbol_t* RestoreSymbol(const Symbol_t &Sym);
 
 	/**
 	 * Check if the declaration for the identifier is
@@ -95,8 +105,20 @@ public:
 	Symbol_t* LookupIdentifier(const string &Identifier, bool LocalScopeOnly);
 
 	/**
-	 * Reset the table back to it's original state, destroying any
-	 * scopes we've got.
+	 * Same as above but for a name which has already been interned, such
+	 * as the IdAtom of an identifier tree node.
+	 * @param Identifier Atom for the name of the symbol to look up.
+	 * @param LocalScopeOnly Only look for the identifier in the current scope.
+	 * @return A pointer to the symbol object for the identifier if found, 
+	 *         otherwise NULL.
+	 */
+	Symbol_t* LookupIdentifier(Atom Identifier, bool LocalScopeOnly);
+
+	/**
+	 * Reset the table back to it's original state, closing any scopes we've
+	 * got. The symbols themselves aren't destroyed as trees kept from an 
+	 * earlier compile may still be bound to them, a global symbol is reused 
+	 * for the next global declaration with the same name.
 	 */
 	void Reset(void);
 
@@ -108,8 +130,26 @@ public:
 
 private:
 
-	/** Current scope we're adding symbols to (and any enclosing scopes). */
-	Scope_t *m_CurrentScope;
+	/** Innermost visible declaration of each name indexed by it's atom, NULL if none. */
+	vector<Symbol_t*> m_Visible;
+
+	/** The symbol used for each name declared at global scope, indexed by atom. */
+	vector<Symbol_t*> m_Globals;
+
+	/** 
+	 * Every symbol that's been created. A deque is used so pointers to them
+	 * stay valid as more symbols are added.
+	 */
+	deque<Symbol_t> m_Symbols;
+
+	/** Every symbol in a scope which is still open in the order they were added. */
+	vector<Symbol_t*> m_InScope;
+
+	/** Parallel to m_InScope, the symbol each one shadowed when it was added. */
+	vector<Symbol_t*> m_Shadowed;
+
+	/** Size of m_InScope at the point each nested scope was opened. */
+	vector<size_t> m_ScopeStarts;
 };
 
 #endif
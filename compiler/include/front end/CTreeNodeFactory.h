@@ -9,28 +9,78 @@
 
 #include "TokenTypes.h"
 #include "ISingleton.h"
+#include "CMemoryArena.h"
+#include "CTreeNode.h"
 
 //forward decls
-class CTreeNode;
 class CLiteralTreeNode;
 
 /**
  * This is the only class which can construct the different types
  * of tree nodes so we can ensure that all required attributes are 
  * set before the node is used.
+ * <br><br>
+ * Nodes can either be allocated individually or placed in one of two 
+ * arenas, one for the parse tree and one for the MIR. Every node in an 
+ * arena is freed at once when the arena is released so DestroyNode does
+ * nothing for them. A node in an arena must only ever have children from
+ * the same arena.
  */
 class CTreeNodeFactory : public ISingleton<CTreeNodeFactory>
 {
 public:
-	CTreeNodeFactory(void) {};
+	CTreeNodeFactory(void) : m_CurrArena(NA_HEAP) {};
 	~CTreeNodeFactory(void) {};
 
+	/**
+	 * Choose where the nodes built from now on are placed.
+	 * @param Arena The arena to use, or NA_HEAP to allocate each one separately.
+	 */
+	void UseNodeArena(NodeArena Arena);
+
+	/**
+	 * Find out where nodes are currently being placed.
+	 * @return The arena passed to the last call to UseNodeArena.
+	 */
+	NodeArena GetNodeArena(void);
+
+	/**
+	 * Free every node in an arena, any pointers to them are left dangling.
+	 * The arena can still be used afterwards.
+	 * @param Arena The arena to release, this can't be NA_HEAP.
+	 */
+	void ReleaseNodeArena(NodeArena Arena);
+
+	/**
+	 * Get the arena nodes are currently being placed in so other structures
+	 * with the same lifetime can be allocated alongside them.
+	 * @return The current arena, NULL if nodes are allocated individually.
+	 */
+	CMemoryArena* GetCurrentArena(void);
+
+	/**
+	 * Find out if a node which is never changed once it's built can be used
+	 * in place of a copy of itself. That's only safe if it's in the arena new
+	 * nodes are going in, so it lives exactly as long as the copy would. Nodes 
+	 * allocated on their own are always copied as each one is freed separately.
+	 * @param Node The node being copied.
+	 * @return True if the node can be shared instead of copied.
+	 */
+	bool CanShareNode(CTreeNode *Node);
+
 	/**
 	 * Build a new identifier tree node.
 	 * @param Name The name fof the identifier.
 	 */
 	CTreeNode* BuildIdentifier(const string &Name);
 
+	/**
+	 * Build a new identifier tree node from a name that's already been
+	 * interned, saving the lookup in the atom table.
+	 * @param Name Atom for the name of the identifier.
+	 */
+	CTreeNode* BuildIdentifier(Atom Name);
+
 	/**
 	 * Build a variable declaration
 	 * @param Name The variable's name.
@@ -75,10 +125,11 @@ public:
 	/**
 	 * Build a new array element access tree node.
 	 * @param Index Expression which forms the index of the element to access.
-	 * @param ArrName Name of the array variable being access.
+	 * @param ArrName Identifier for the array variable being access, this
+	 *        should already be bound to the array's symbol.
 	 * @param Type Type of the array being accessed.
 	 */
-	CTreeNode* BuildArrayRef(CTreeNode *Index, const string &ArrName, TokenType Type);
+	CTreeNode* BuildArrayRef(CTreeNode *Index, CTreeNode *ArrName, TokenType Type);
 
 	/**
 	 * Build a new if statement tree node.
@@ -164,6 +215,41 @@ public:
 	 * @param RefId Unique reference name to refer to the literal.
 	 */
 	CTreeNode* BuildLiteralRef(CTreeNode *Lit, const string &RefId);
+
+	/**
+	 * Build a tree node with no children and none of it's attributes set.
+	 * This is only for rebuilding trees read back from the MIR cache where
+	 * every attribute is restored straight after, use the other functions
+	 * to build new nodes.
+	 * @param Code The type of node to build.
+	 */
+	CTreeNode* BuildEmptyNode(TreeCode Code);
+
+private:
+
+	/**
+	 * Allocate a new tree node of type T, either in the current arena
+	 * or on it's own if there isn't one.
+	 * @return The new node, it's up to the caller to fill in the rest.
+	 */
+	template<typename T>
+	T* NewNode(void);
+
+	/**
+	 * Run the destructor of a node of type T when it's arena is released.
+	 * @param Node The node being destroyed.
+	 */
+	template<typename T>
+	static void DestroyArenaNode(void *Node);
+
+	/** Arena the parse tree is built in. */
+	CMemoryArena m_ParseTreeArena;
+
+	/** Arena the MIR tree and CFG are built in. */
+	CMemoryArena m_MirArena;
+
+	/** Arena new nodes are placed in. */
+	NodeArena m_CurrArena;
 };
 
 #endif
@@ -0,0 +1,158 @@
+//------------------------------------------------------------------------------------------
+// File: CTreeVisitor.h
+// Desc: Statically dispatched walks over the nodes of a tree
+// Auth: Lee Millward
+//------------------------------------------------------------------------------------------
+
+#ifndef __CTREEVISITOR_H__
+#define __CTREEVISITOR_H__
+
+#include "CTreeNode.h"
+#include "CIdentifierTreeNode.h"
+#include "CVarDeclTreeNode.h"
+#include "CArrayDeclTreeNode.h"
+#include "CLiteralTreeNode.h"
+#include "CArithExprTreeNode.h"
+#include "CBooleanExprTreeNode.h"
+#include "CUnaryExprTreeNode.h"
+#include "CArrayRefTreeNode.h"
+#include "CIfStmtTreeNode.h"
+#include "CWhileStmtTreeNode.h"
+#include "CAssignExprTreeNode.h"
+#include "CParameterListTreeNode.h"
+#include "CFunctionDeclTreeNode.h"
+#include "CParameterDeclTreeNode.h"
+#include "CReturnStmtTreeNode.h"
+#include "CCallExprTreeNode.h"
+#include "CRootTreeNode.h"
+#include "CLabelTreeNode.h"
+#include "CGotoExprTreeNode.h"
+#include "CLiteralRefTreeNode.h"
+
+/**
+ * Base for passes which need to do something different for each type of
+ * tree node. Visit looks at the code of the node once and hands it, cast to
+ * it's real type, to the matching handler in the derived class. The derived
+ * class is a template parameter so the handler is picked at compile time
+ * and can be inlined into the switch, there are no virtual calls involved.
+ * <br><br>
+ * A pass only needs to provide handlers for the nodes it expects to see,
+ * the rest end up in VisitNode which raises an ICE unless the derived class
+ * provides it's own. Anything the pass needs while walking the tree, such
+ * as the basic block being scanned, is kept in the derived class.
+ * <br><br>
+ * The handlers are looked up through the derived class so they can be
+ * private as long as it's made a friend of CTreeVisitor.
+ */
+template<typename Derived, typename RetType = void>
+class CTreeVisitor
+{
+public:
+	/**
+	 * Pass a node to the derived class's handler for it's type.
+	 * @param Node The node to visit.
+	 * @return Whatever the handler returns.
+	 */
+	RetType Visit(CTreeNode *Node)
+	{
+		SanityCheck(Node);
+
+		switch(Node->Code)
+		{
+		case TC_IDENTIFIER:
+			return Self()->VisitIdentifier(static_cast<CIdentifierTreeNode*>(Node));
+		case TC_VARDECL:
+			return Self()->VisitVarDecl(static_cast<CVarDeclTreeNode*>(Node));
+		case TC_ARRAYDECL:
+			return Self()->VisitArrayDecl(static_cast<CArrayDeclTreeNode*>(Node));
+		case TC_LITERAL:
+			return Self()->VisitLiteral(static_cast<CLiteralTreeNode*>(Node));
+		case TC_ARITH_EXPR:
+			return Self()->VisitArithExpr(static_cast<CArithExprTreeNode*>(Node));
+		case TC_BOOLEAN_EXPR:
+			return Self()->VisitBooleanExpr(static_cast<CBooleanExprTreeNode*>(Node));
+		case TC_UNARY_EXPR:
+			return Self()->VisitUnaryExpr(static_cast<CUnaryExprTreeNode*>(Node));
+		case TC_ARRAY_REF:
+			return Self()->VisitArrayRef(static_cast<CArrayRefTreeNode*>(Node));
+		case TC_IFSTMT:
+			return Self()->VisitIfStmt(static_cast<CIfStmtTreeNode*>(Node));
+		case TC_WHILESTMT:
+			return Self()->VisitWhileStmt(static_cast<CWhileStmtTreeNode*>(Node));
+		case TC_ASSIGN_EXPR:
+			return Self()->VisitAssignExpr(static_cast<CAssignExprTreeNode*>(Node));
+		case TC_PARAMETER_LIST:
+			return Self()->VisitParameterList(static_cast<CParameterListTreeNode*>(Node));
+		case TC_FUNCTIONDECL:
+			return Self()->VisitFunctionDecl(static_cast<CFunctionDeclTreeNode*>(Node));
+		case TC_PARMDECL:
+			return Self()->VisitParameterDecl(static_cast<CParameterDeclTreeNode*>(Node));
+		case TC_RETURNSTMT:
+			return Self()->VisitReturnStmt(static_cast<CReturnStmtTreeNode*>(Node));
+		case TC_CALLEXPR:
+			return Self()->VisitCallExpr(static_cast<CCallExprTreeNode*>(Node));
+		case TC_ROOT:
+			return Self()->VisitRoot(static_cast<CRootTreeNode*>(Node));
+		case TC_LABEL:
+			return Self()->VisitLabel(static_cast<CLabelTreeNode*>(Node));
+		case TC_GOTOEXPR:
+			return Self()->VisitGotoExpr(static_cast<CGotoExprTreeNode*>(Node));
+		case TC_LITERALREF:
+			return Self()->VisitLiteralRef(static_cast<CLiteralRefTreeNode*>(Node));
+		}
+
+		return Self()->VisitNode(Node);
+	}
+
+	/**
+	 * Visit each child of a node in turn, throwing away anything the
+	 * handlers return.
+	 * @param Node The node whose children we want to visit.
+	 */
+	void VisitChildren(CTreeNode *Node)
+	{
+		for(unsigned int i = 0; i < Node->GetNumChildren(); i++)
+			Visit(Node->GetChild(i));
+	}
+
+	//default handlers for each type of node, a derived class hides
+	//the ones for the nodes it's interested in
+	RetType VisitIdentifier(CIdentifierTreeNode *Node)       { return Self()->VisitNode(Node); }
+	RetType VisitVarDecl(CVarDeclTreeNode *Node)             { return Self()->VisitNode(Node); }
+	RetType VisitArrayDecl(CArrayDeclTreeNode *Node)         { return Self()->VisitNode(Node); }
+	RetType VisitLiteral(CLiteralTreeNode *Node)             { return Self()->VisitNode(Node); }
+	RetType VisitArithExpr(CArithExprTreeNode *Node)         { return Self()->VisitNode(Node); }
+	RetType VisitBooleanExpr(CBooleanExprTreeNode *Node)     { return Self()->VisitNode(Node); }
+	RetType VisitUnaryExpr(CUnaryExprTreeNode *Node)         { return Self()->VisitNode(Node); }
+	RetType VisitArrayRef(CArrayRefTreeNode *Node)           { return Self()->VisitNode(Node); }
+	RetType VisitIfStmt(CIfStmtTreeNode *Node)               { return Self()->VisitNode(Node); }
+	RetType VisitWhileStmt(CWhileStmtTreeNode *Node)         { return Self()->VisitNode(Node); }
+	RetType VisitAssignExpr(CAssignExprTreeNode *Node)       { return Self()->VisitNode(Node); }
+	RetType VisitParameterList(CParameterListTreeNode *Node) { return Self()->VisitNode(Node); }
+	RetType VisitFunctionDecl(CFunctionDeclTreeNode *Node)   { return Self()->VisitNode(Node); }
+	RetType VisitParameterDecl(CParameterDeclTreeNode *Node) { return Self()->VisitNode(Node); }
+	RetType VisitReturnStmt(CReturnStmtTreeNode *Node)       { return Self()->VisitNode(Node); }
+	RetType VisitCallExpr(CCallExprTreeNode *Node)           { return Self()->VisitNode(Node); }
+	RetType VisitRoot(CRootTreeNode *Node)                   { return Self()->VisitNode(Node); }
+	RetType VisitLabel(CLabelTreeNode *Node)                 { return Self()->VisitNode(Node); }
+	RetType VisitGotoExpr(CGotoExprTreeNode *Node)           { return Self()->VisitNode(Node); }
+	RetType VisitLiteralRef(CLiteralRefTreeNode *Node)       { return Self()->VisitNode(Node); }
+
+	/**
+	 * Called for any node the derived class doesn't have a handler for.
+	 * @param Node The unhandled node.
+	 */
+	RetType VisitNode(CTreeNode *Node)
+	{
+		InternalError("unhandled tree code");
+	}
+
+private:
+	/** The derived class, this is what the handlers are called on. */
+	Derived* Self(void)
+	{
+		return static_cast<Derived*>(this);
+	}
+};
+
+#endif
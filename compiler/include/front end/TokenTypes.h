@@ -66,7 +66,9 @@ enum TokenType
 	TOKTYPE_NOTEQ,
 	TOKTYPE_EQUALITY,
 	TOKTYPE_OR,
-	TOKTYPE_AND
+	TOKTYPE_AND,
+
+	NUM_TOKTYPES
 };
 
 #endif
@@ -8,28 +8,35 @@
 #define __TREECHILDINDICIES_H__
 
 //because the child nodes of a given CTreeNode* are stored in
-//a std::vector, we use standard notation to access them by index. This
+//an array, we use standard notation to access them by index. This
 //file stores the position of each child for the different array nodes so when
-//we access them in the code we use these identifiers rather than magic numbers
+//we access them in the code we use these identifiers rather than magic numbers.
+//Nodes which always have the same number of children also have that number
+//here, it's the size of the storage CFixedArityTreeNode reserves for them
 
 //array decls
 #define ARR_DECL_VAR    0
 #define ARR_DECL_BOUNDS 1
+#define ARR_DECL_NUM_CHILDREN 2
 
 //array references
 #define ARR_REF_INDEX	0
+#define ARR_REF_NUM_CHILDREN 1
 
 //assignment expressions
 #define ASSIGN_EXPR_ID	0
 #define ASSIGN_EXPR_RHS	1
+#define ASSIGN_EXPR_NUM_CHILDREN 2
 
 //arithmetic expressions
 #define ARITH_EXPR_LHS	0
 #define ARITH_EXPR_RHS	1
+#define ARITH_EXPR_NUM_CHILDREN 2
 
 //boolean/conditional expressions
 #define BLN_EXPR_LHS	0
 #define BLN_EXPR_RHS	1
+#define BLN_EXPR_NUM_CHILDREN 2
 
 //function decls
 #define FUNC_DECL_PARM_LIST	0
@@ -38,20 +45,25 @@
 #define IF_STMT_COND_EXPR	0
 #define IF_STMT_BODY			1
 #define IF_STMT_ELSE_BODY 2
+#define IF_STMT_NUM_CHILDREN 3
 
 //return statements
 #define RET_STMT_RET_EXPR	0
+#define RET_STMT_NUM_CHILDREN 1
 
 //unary expressions
 #define UNARY_EXPR_EXPR	0
+#define UNARY_EXPR_NUM_CHILDREN 1
 
 //while statements
 #define WHILE_STMT_COND_EXPR	0
 
 //parameter decls
 #define PARM_DECL_ID 0
+#define PARM_DECL_NUM_CHILDREN 1
 
 //literal references
 #define LITREF_LITERAL 0
+#define LITREF_NUM_CHILDREN 1
 
 #endif
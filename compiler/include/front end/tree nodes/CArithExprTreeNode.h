@@ -20,7 +20,7 @@
  * &nbsp;&nbsp; 0. LHS of the expression <br>
  * &nbsp;&nbsp; 1. RHS of the expression
 */
-class CArithExprTreeNode : public CTreeNode
+class CArithExprTreeNode : public CFixedArityTreeNode<ARITH_EXPR_NUM_CHILDREN>
 {
 private:
 	CArithExprTreeNode(void) {}
@@ -42,11 +42,18 @@ public:
 	/** Operator for this expression */
 	TokenType Operator;
 
+	/** 
+	 * Type of the value of this expression, worked out by the parser 
+	 * when the node is built so type checking doesn't need to go back 
+	 * down the tree for it.
+	 */
+	TokenType ExprType;
+
 	/**
 	 * Inherited from CTreeNode.
 	 * @see CTreeNode.
 	 */
-	void DumpAsParseTreeNode(TiXmlElement *XmlNode);
+	void DumpAsParseTreeNode(CXmlWriter &XmlOut);
 
 	/**
 	 * Inherited from CTreeNode.
@@ -58,7 +65,9 @@ public:
 	 * Inherited from CTreeNode. If either operand of the expression is
 	 * itself another expression, perform the necessary simplification 
 	 * by breaking it down into smaller expressions using compiler generated
-	 * temporary variables.
+	 * temporary variables. Expressions whose value is already known, or
+	 * which are an identity such as x + 0, are folded by CConstantFolder
+	 * without creating any temporaries.
 	 */
 	CTreeNode* RewriteIntoMIRForm(CTreeNode *Stmts);
 
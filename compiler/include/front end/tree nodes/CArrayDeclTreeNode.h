@@ -18,7 +18,7 @@
  * &nbsp;&nbsp; 0. Var decl <br>
  * &nbsp;&nbsp; 1. Bounds
 */
-class CArrayDeclTreeNode : public CTreeNode
+class CArrayDeclTreeNode : public CFixedArityTreeNode<ARR_DECL_NUM_CHILDREN>
 {
 private:
 	CArrayDeclTreeNode(void) {}
@@ -33,7 +33,7 @@ public:
 	 * Inherited from CTreeNode.
 	 * @see CTreeNode.
 	 */
-	void DumpAsParseTreeNode(TiXmlElement *XmlNode);
+	void DumpAsParseTreeNode(CXmlWriter &XmlOut);
 
 	/**
 	 * Inherited from CTreeNode.
@@ -15,7 +15,7 @@
  * <b>Children:</b><br>
  * &nbsp;&nbsp; 0. Index expression
 */
-class CArrayRefTreeNode : public CTreeNode
+class CArrayRefTreeNode : public CFixedArityTreeNode<ARR_REF_NUM_CHILDREN>
 {
 private:
 	CArrayRefTreeNode(void) {}
@@ -36,7 +36,7 @@ public:
 	 * Inherited from CTreeNode.
 	 * @see CTreeNode.
 	 */
-	void DumpAsParseTreeNode(TiXmlElement *XmlNode);
+	void DumpAsParseTreeNode(CXmlWriter &XmlOut);
 
 	/**
 	 * Inherited from CTreeNode.
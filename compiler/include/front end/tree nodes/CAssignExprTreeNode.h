@@ -16,7 +16,7 @@
  * &nbsp;&nbsp; 0. the identifier or array decl being assigned to <br>
  * &nbsp;&nbsp; 1. expression the identifier is being assigned.
 */
-class CAssignExprTreeNode : public CTreeNode
+class CAssignExprTreeNode : public CFixedArityTreeNode<ASSIGN_EXPR_NUM_CHILDREN>
 {
 private:
 	CAssignExprTreeNode(void) {}
@@ -31,7 +31,7 @@ public:
 	 * Inherited from CTreeNode.
 	 * @see CTreeNode.
 	 */
-	void DumpAsParseTreeNode(TiXmlElement *XmlNode);
+	void DumpAsParseTreeNode(CXmlWriter &XmlOut);
 
 	/**
 	 * Inherited from CTreeNode.
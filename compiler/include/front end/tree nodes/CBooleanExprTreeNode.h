@@ -24,7 +24,7 @@ class CIdentifierTreeNode;
  * &nbsp;&nbsp; 0. LHS of the expression <br>
  * &nbsp;&nbsp; 1. RHS of the expression.
  */
-class CBooleanExprTreeNode : public CTreeNode
+class CBooleanExprTreeNode : public CFixedArityTreeNode<BLN_EXPR_NUM_CHILDREN>
 {
 private:
 	CBooleanExprTreeNode(void) {}
@@ -61,7 +61,7 @@ public:
 	 * Inherited from CTreeNode.
 	 * @see CTreeNode.
 	 */
-	void DumpAsParseTreeNode(TiXmlElement *XmlNode);
+	void DumpAsParseTreeNode(CXmlWriter &XmlOut);
 
 	/**
 	 * Inherited from CTreeNode.
@@ -74,6 +74,7 @@ public:
 	 * or arithmetic equivalents using the literal values 0 and 1 
 	 * instead of "true" and "false". For relation expressions these
 	 * transformations aren't applied, only the normal simplifications.
+	 * Comparing two constants is folded into the literal 1 or 0.
 	 */
 	CTreeNode* RewriteIntoMIRForm(CTreeNode *Stmts);
 
@@ -8,6 +8,10 @@
 #define __CCALLEXPRTREENODE_H__
 
 #include "CTreeNode.h"
+#include "TokenTypes.h"
+
+//forward decls
+struct Symbol_t;
 
 /** 
  * Representation of a function call in the IR
@@ -29,11 +33,17 @@ public:
 	/** Name of the function we're calling. */
 	string FuncName;
 
+	/** Return type of the function being called, filled in by the parser. */
+	TokenType ExprType;
+
+	/** Symbol for the function being called, bound by the parser. */
+	Symbol_t *Binding;
+
 	/**
 	 * Inherited from CTreeNode.
 	 * @see CTreeNode.
 	 */
-	void DumpAsParseTreeNode(TiXmlElement *XmlNode);
+	void DumpAsParseTreeNode(CXmlWriter &XmlOut);
 
 	/**
 	 * Inherited from CTreeNode.
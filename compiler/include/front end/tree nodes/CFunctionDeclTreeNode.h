@@ -8,11 +8,13 @@
 #define __CFUNCTIONDECLTREENODE_H__
 
 #include "CTreeNode.h"
+#include "CStmtList.h"
 #include "TokenTypes.h"
 #include "CControlFlowGraph.h"
 
 //forward decls
 struct BasicBlock_t;
+struct Symbol_t;
 
 /**
  * Declaration of a function within the IR. Includes the statements
@@ -27,7 +29,9 @@ struct BasicBlock_t;
  * <br><br>
  * <b>Children:</b><br>
  * &nbsp;&nbsp; 0. Parameter list <br>
- * &nbsp;&nbsp; 1 -> N. Statements making up the function body.
+ * <br>
+ * The statements making up the function body are kept in Body rather
+ * than as children, the basic blocks of the CFG are ranges of it.
  */
 class CFunctionDeclTreeNode : public CTreeNode
 {
@@ -49,6 +53,15 @@ public:
 	/** Name of the function. */
 	string Name;
 
+	/** 
+	 * Symbol the parser added for the function, MIR lowering points it at 
+	 * the lowered function so calls bound to it follow along.
+	 */
+	Symbol_t *Binding;
+
+	/** Statements making up the function body, in order. */
+	CStmtList Body;
+
 	/** CFG for this function. */
 	list<BasicBlock_t*> FuncCFG;
 
@@ -67,7 +80,7 @@ public:
 	 * Inherited from CTreeNode.
 	 * @see CTreeNode.
 	 */
-	void DumpAsParseTreeNode(TiXmlElement *XmlNode);
+	void DumpAsParseTreeNode(CXmlWriter &XmlOut);
 
 	/**
 	 * Inherited from CTreeNode.
@@ -77,11 +90,17 @@ public:
 
 	/**
 	 * Inherited from CTreeNode. Overriden here so we can clean
-	 * up the CFG before destroying ourselves.
+	 * up the CFG and the body before destroying ourselves.
 	 * @see CTreeNode.
 	 */
 	void DestroyNode();
 
+	/**
+	 * Inherited from CTreeNode, adds the statement to the end of Body.
+	 * @see CTreeNode.
+	 */
+	void AddStmt(CTreeNode *Stmt);
+
 	/**
 	 * Process each statement in the function to convert them to 
 	 * MIR form, adding the new statements to the function body
@@ -8,6 +8,10 @@
 #define __CIDENTIFIERTREENODE_H__ 
 
 #include "CTreeNode.h"
+#include "TokenTypes.h"
+
+//forward decls
+struct Symbol_t;
 
 /**
  * A simple tree node which simply stores the name
@@ -17,7 +21,7 @@
  * <b>Children:</b><br>
  * &nbsp;&nbsp; None.
  */
-class CIdentifierTreeNode : public CTreeNode
+class CIdentifierTreeNode : public CFixedArityTreeNode<0>
 {
 private:
 	CIdentifierTreeNode(void) {}
@@ -31,11 +35,24 @@ public:
 	/** Name of the identifier. */
 	string IdName;
 
+	/** IdName interned in the atom table, use this for comparing names. */
+	Atom IdAtom;
+
+	/** Declared type of the identifier, filled in by the parser. */
+	TokenType ExprType;
+
+	/**
+	 * Symbol for the declaration this identifier refers to, bound by the 
+	 * parser or when a compiler temporary is created. After MIR lowering
+	 * the symbol points at the MIR declaration.
+	 */
+	Symbol_t *Binding;
+
 	/**
 	 * Inherited from CTreeNode.
 	 * @see CTreeNode.
 	 */
-	void DumpAsParseTreeNode(TiXmlElement *XmlNode);
+	void DumpAsParseTreeNode(CXmlWriter &XmlOut);
 
 	/**
 	 * Inherited from CTreeNode.
@@ -23,7 +23,7 @@
  * &nbsp;&nbsp; 1. Body of the if statement. <br>
  * &nbsp;&nbsp; 2. Body of the else statement.
  */
-class CIfStmtTreeNode : public CTreeNode
+class CIfStmtTreeNode : public CFixedArityTreeNode<IF_STMT_NUM_CHILDREN>
 {
 private:
 	CIfStmtTreeNode(void) {}
@@ -32,13 +32,21 @@ private:
 	//only CTreeNodeFactory can instantiate tree nodes
 	friend class CTreeNodeFactory;
 
+	/**
+	 * Lower each statement in the 'then' or 'else' body in turn.
+	 * @param Body Which child holds the statements, IF_STMT_BODY or
+	 *        IF_STMT_ELSE_BODY.
+	 * @param Stmts Global MIR tree to add the statements to.
+	 */
+	void RewriteBodyIntoMIRForm(unsigned int Body, CTreeNode *Stmts);
+
 public:
 
 	/**
 	 * Inherited from CTreeNode.
 	 * @see CTreeNode.
 	 */
-	void DumpAsParseTreeNode(TiXmlElement *XmlNode);
+	void DumpAsParseTreeNode(CXmlWriter &XmlOut);
 
 	/**
 	 * Inherited from CTreeNode.
@@ -49,7 +57,9 @@ public:
 	/**
 	 * Perform the simplification of all children - the conditional, if body
 	 * and else body. When processing the two bodies it's a recursive process
-	 * to handle each statement in turn.
+	 * to handle each statement in turn. The bodies are laid out so only one
+	 * jump is taken whichever way the condition goes, and a condition known
+	 * at compile time doesn't need a comparison at all.
 	 * @see CTreeNode.
 	 */
 	CTreeNode* RewriteIntoMIRForm(CTreeNode *Stmts);
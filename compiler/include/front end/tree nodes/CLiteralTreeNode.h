@@ -17,7 +17,7 @@
  * <b>Children:</b><br>
  * &nbsp;&nbsp; None.
  */
-class CLiteralTreeNode : public CTreeNode
+class CLiteralTreeNode : public CFixedArityTreeNode<0>
 {
 private:
 	CLiteralTreeNode(void) {}
@@ -38,7 +38,7 @@ public:
 	 * Inherited from CTreeNode.
 	 * @see CTreeNode.
 	 */
-	void DumpAsParseTreeNode(TiXmlElement *XmlNode);
+	void DumpAsParseTreeNode(CXmlWriter &XmlOut);
 	
 	/**
 	 * Inherited from CTreeNode.
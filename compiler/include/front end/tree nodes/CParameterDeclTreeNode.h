@@ -19,7 +19,7 @@
  * <b>Children:</b><br>
  * &nbsp;&nbsp; 0. Identifier for this decl.
  */
-class CParameterDeclTreeNode : public CTreeNode
+class CParameterDeclTreeNode : public CFixedArityTreeNode<PARM_DECL_NUM_CHILDREN>
 {
 private:
 	CParameterDeclTreeNode(void) {}
@@ -43,7 +43,7 @@ public:
 	 * Inherited from CTreeNode.
 	 * @see CTreeNode.
 	 */
-	void DumpAsParseTreeNode(TiXmlElement *XmlNode);
+	void DumpAsParseTreeNode(CXmlWriter &XmlOut);
 	
 	/**
 	 * Inherited from CTreeNode.
@@ -17,7 +17,7 @@
  * &nbsp;&nbsp; 0. Expression forming the value being returned.
  */
 
-class CReturnStmtTreeNode : public CTreeNode
+class CReturnStmtTreeNode : public CFixedArityTreeNode<RET_STMT_NUM_CHILDREN>
 {
 private:
 	CReturnStmtTreeNode(void) {}
@@ -32,7 +32,7 @@ public:
 	 * Inherited from CTreeNode.
 	 * @see CTreeNode.
 	 */
-	void DumpAsParseTreeNode(TiXmlElement *XmlNode);
+	void DumpAsParseTreeNode(CXmlWriter &XmlOut);
 
 	/**
 	 * Inherited from CTreeNode.
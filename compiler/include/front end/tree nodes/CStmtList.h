@@ -0,0 +1,93 @@
+//------------------------------------------------------------------------------------------
+// File: CStmtList.h
+// Desc: Doubly linked list of statements threaded through the tree nodes themselves
+// Auth: Lee Millward
+//------------------------------------------------------------------------------------------
+
+#ifndef __CSTMTLIST_H__
+#define __CSTMTLIST_H__
+
+//forward decls
+class CTreeNode;
+
+/**
+ * A sequence of statements such as the body of a function. Rather than
+ * holding the statements in a separate container, each statement carries
+ * it's own PrevStmt and NextStmt links so inserting, removing or moving a
+ * statement anywhere in the list takes constant time and never invalidates
+ * a pointer to any other statement. As the links are part of the node, a
+ * statement can only be in one list at a time.
+ * <br><br>
+ * The list is walked by following the links from the front:
+ * <br><br>
+ * for(CTreeNode *Stmt = List.Front(); Stmt; Stmt = Stmt->NextStmt)
+ * <br><br>
+ * The list doesn't own the statements, they're freed along with whichever
+ * node or arena holds them.
+ */
+class CStmtList
+{
+public:
+	CStmtList(void) : m_Head(NULL), m_Tail(NULL), m_Size(0) {};
+
+	/** @return The first statement or NULL if the list is empty. */
+	CTreeNode* Front(void) { return m_Head; };
+
+	/** @return The last statement or NULL if the list is empty. */
+	CTreeNode* Back(void) { return m_Tail; };
+
+	/** @return The number of statements in the list. */
+	unsigned int Size(void) { return m_Size; };
+
+	/** @return True if there's no statements in the list. */
+	bool Empty(void) { return m_Size == 0; };
+
+	/**
+	 * Add a statement to the end of the list.
+	 * @param Stmt The statement to add, it can't already be in a list.
+	 */
+	void PushBack(CTreeNode *Stmt);
+
+	/**
+	 * Add a statement in front of one already in the list.
+	 * @param Pos The statement to insert before, if it's NULL the new
+	 *        statement is added to the end of the list.
+	 * @param Stmt The statement to add, it can't already be in a list.
+	 */
+	void InsertBefore(CTreeNode *Pos, CTreeNode *Stmt);
+
+	/**
+	 * Add a statement after one already in the list.
+	 * @param Pos The statement to insert after, if it's NULL the new
+	 *        statement is added to the front of the list.
+	 * @param Stmt The statement to add, it can't already be in a list.
+	 */
+	void InsertAfter(CTreeNode *Pos, CTreeNode *Stmt);
+
+	/**
+	 * Unlink a statement from the list, the statement itself is left
+	 * alone so it can be added somewhere else or destroyed.
+	 * @param Stmt The statement to remove, must be in this list.
+	 */
+	void Remove(CTreeNode *Stmt);
+
+	/** Unlink and destroy every statement in the list. */
+	void DestroyStmts(void);
+
+private:
+
+	//a statement can only be in one list so lists can't be copied
+	CStmtList(const CStmtList&);
+	CStmtList& operator = (const CStmtList&);
+
+	/** First statement in the list. */
+	CTreeNode *m_Head;
+
+	/** Last statement in the list. */
+	CTreeNode *m_Tail;
+
+	/** Number of statements in the list. */
+	unsigned int m_Size;
+};
+
+#endif
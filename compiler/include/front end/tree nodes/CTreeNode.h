@@ -10,8 +10,11 @@
 #include <vector>
 using namespace std;
 
+#include "TokenTypes.h"
+
 //forward decls
-class TiXmlElement;
+class CXmlWriter;
+class CVarDeclTreeNode;
 
 /** The different types of trees that can be built by CTreeNodeFactory. */
 enum TreeCode
@@ -38,6 +41,19 @@ enum TreeCode
 	TC_LITERALREF
 };
 
+/** Where CTreeNodeFactory places the tree nodes it builds. */
+enum NodeArena
+{
+	/** Each node is allocated on it's own and freed by DestroyNode. */
+	NA_HEAP = 0,
+
+	/** Nodes making up the parse tree. */
+	NA_PARSE_TREE,
+
+	/** Nodes making up the MIR tree along with it's CFG. */
+	NA_MIR
+};
+
 /**
  * The core representation of the program used by the compiler from the 
  * front-end down through the back-end. Every tree node created has a 
@@ -61,26 +77,60 @@ enum TreeCode
  * The process of lowering a parse tree into it's equivalent form is specific
  * to type of node being lowering so each specialisation of this class is
  * required to implement the necessary functionality to handle it.
+ * <br><br>
+ * Most nodes always have the same number of children, an arith_expr always
+ * has an LHS and an RHS for example. Those nodes derive from 
+ * CFixedArityTreeNode which holds the children inside the node itself, so 
+ * building one doesn't need a separate allocation for them. Only nodes with
+ * a variable number of children, such as the root or a parameter list, keep
+ * them in an array which grows as they're added.
+ * <br><br>
+ * The statements making up a function's body aren't children at all, they're
+ * kept in a CStmtList threaded through the PrevStmt and NextStmt links of each
+ * statement so the passes can add, remove and move them in constant time.
  */
 class CTreeNode
 {
 public:
-	CTreeNode(void) {}
-	virtual ~CTreeNode(void) {}
+	/** Construct a node with any number of children. */
+	CTreeNode(void);
+
+	/**
+	 * Construct a node which can have at most a fixed number of children.
+	 * @param FixedChildren Storage for the children, owned by the derived
+	 *        class. Can be NULL if NumFixedChildren is 0.
+	 * @param NumFixedChildren The most children the node can have.
+	 */
+	CTreeNode(CTreeNode **FixedChildren, unsigned int NumFixedChildren);
+
+	virtual ~CTreeNode(void);
 
 	/** What type of tree this is. */
 	TreeCode Code;
 
+	/** 
+	 * The arena the node was placed in. Unless it's NA_HEAP the node is freed
+	 * along with the rest of the arena instead of by DestroyNode.
+	 */
+	NodeArena Arena;
+
+	/** 
+	 * The statements either side of this one in the CStmtList it's in, both
+	 * are NULL if it isn't in a list.
+	 */
+	CTreeNode *PrevStmt;
+	CTreeNode *NextStmt;
+
 	/**
 	 * Output the contents of this tree node to an XML document to 
 	 * show the heirarchal structure of the parse tree. The contents of
 	 * the file doesn't include any new information about the input
 	 * program, it's merely intented to show the programmer how the 
 	 * compiler views the program.
-	 * @param XmlNode A parent XML document node to which this tree node
-	 *        will output it's contents to.
+	 * @param XmlOut Writer for the document, this tree node's elements
+	 *        are written inside whichever element is currently open.
 	 */
-	virtual void DumpAsParseTreeNode(TiXmlElement *XmlNode) = 0;
+	virtual void DumpAsParseTreeNode(CXmlWriter &XmlOut) = 0;
 
 	/**
 	 * Similiar to DumpAsParseTreeNode but instead this time the
@@ -92,18 +142,28 @@ public:
 	 */
 	virtual void DumpAsMIRTreeNode(ofstream &OutFile) = 0;
 
-	/** Destroy this node and any children. */
+	/** Destroy this node and any children, nodes in an arena are left alone. */
 	virtual void DestroyNode(void);
 
 	/**
 	 * Add a new tree node as a child of this one, optionally 
-	 * specifying the position it should have.
+	 * specifying the position it should have. Adding more children
+	 * than a fixed arity node has room for will cause an ICE.
 	 * @param NewChild The new tree node to add, should never be NULL.
 	 * @param Pos Position to insert the new child, if the value is
 	 *            -1 then it's added as the last child.
 	 */
 	void AddChild(CTreeNode *NewChild, unsigned int Pos = -1);
 
+	/**
+	 * Add a statement to the end of whatever this node holds its statements
+	 * in. MIR lowering adds the statements it creates through this so it 
+	 * doesn't need to know if it's building a function body or the root.
+	 * By default the statement is added as the last child.
+	 * @param Stmt The statement to add, should never be NULL.
+	 */
+	virtual void AddStmt(CTreeNode *Stmt);
+
 	/**
 	 * Find out the number of children this tree node has.
 	 * @return The number of children added.
@@ -144,7 +204,9 @@ public:
 	 * piece of memory. Instead, use this function so the above
 	 * snippet is now: a = b->CreateCopy(). Depending on the type of node
 	 * being copied this could result is quite a lot of extra memory being
-	 * allocated so should be used with caution.
+	 * allocated so should be used with caution. Nodes which are never changed
+	 * once built, identifiers and literals, hand back themselves instead if
+	 * they're in the arena the copy would be placed in.
 	 */
 	virtual CTreeNode *CreateCopy(void) = 0;
 
@@ -168,10 +230,61 @@ public:
 	 *         an identifier node referring to a new temporary variable.
 	 */
 	CTreeNode* ReplaceCallExpr(CTreeNode *Node, CTreeNode *Stmts);
+
+	/**
+	 * Create a new compiler temporary variable and add it to the symbol 
+	 * table, it's name is bound to the new symbol so any copies made of it
+	 * refer to the temporary.
+	 * @param Type The type of the new variable.
+	 * @return The var_decl for the temporary, it's the caller's responsibility
+	 *         to add it to the MIR tree.
+	 */
+	CVarDeclTreeNode* BuildTempVar(TokenType Type);
+private:
+
+	//tree nodes are only ever copied through CreateCopy
+	CTreeNode(const CTreeNode&);
+	CTreeNode& operator = (const CTreeNode&);
+
+	/** 
+	 * Any child nodes, either the derived class's fixed storage or
+	 * an array allocated to grow as children are added.
+	 */
+	CTreeNode **Children;
+
+	/** Number of children added so far. */
+	unsigned int NumChildren;
+
+	/** How many children there's room for in Children. */
+	unsigned int MaxChildren;
+
+	/** True if Children is the derived class's fixed storage. */
+	bool FixedArity;
+};
+
+/**
+ * Base for tree nodes which always have the same number of children. The
+ * space for them is part of the node so no extra allocation is needed.
+ * The number of children for each type of node lives in TreeChildIndicies.h
+ * along with their positions.
+ */
+template<unsigned int N>
+class CFixedArityTreeNode : public CTreeNode
+{
 protected:
+	CFixedArityTreeNode(void) : CTreeNode(FixedChildren, N) {}
 
-	/** Any child nodes. */
-	vector<CTreeNode*> Children;
+private:
+	/** Storage for the children. */
+	CTreeNode *FixedChildren[N];
+};
+
+/** Leaf nodes don't need any storage for children at all. */
+template<>
+class CFixedArityTreeNode<0> : public CTreeNode
+{
+protected:
+	CFixedArityTreeNode(void) : CTreeNode(NULL, 0) {}
 };
 
 #endif
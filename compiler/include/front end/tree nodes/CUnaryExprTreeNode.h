@@ -18,7 +18,7 @@
  * <b>Children:</b><br>
  * &nbsp;&nbsp; 0. Expression the operator acts upon. 
  */
-class CUnaryExprTreeNode : public CTreeNode
+class CUnaryExprTreeNode : public CFixedArityTreeNode<UNARY_EXPR_NUM_CHILDREN>
 {
 private:
 	CUnaryExprTreeNode(void) {}
@@ -32,11 +32,14 @@ public:
 	/** Operator for this expression. */
 	TokenType Operator;
 
+	/** Type of the operand, filled in by the parser. */
+	TokenType ExprType;
+
 	/**
 	 * Inherited from CTreeNode.
 	 * @see CTreeNode.
 	 */
-	void DumpAsParseTreeNode(TiXmlElement *XmlNode);
+	void DumpAsParseTreeNode(CXmlWriter &XmlOut);
 
 	/**
 	 * Inherited from CTreeNode.
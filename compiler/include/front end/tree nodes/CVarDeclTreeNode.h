@@ -24,7 +24,7 @@ class CIdentifierTreeNode;
  * <b>Children:</b><br>
  * &nbsp;&nbsp; None.
  */
-class CVarDeclTreeNode : public CTreeNode
+class CVarDeclTreeNode : public CFixedArityTreeNode<0>
 {
 private:
 	CVarDeclTreeNode(void);
@@ -138,7 +138,7 @@ public:
 	 * Inherited from CTreeNode.
 	 * @see CTreeNode.
 	 */
-	void DumpAsParseTreeNode(TiXmlElement *XmlNode);
+	void DumpAsParseTreeNode(CXmlWriter &XmlOut);
 
 	/**
 	 * Inherited from CTreeNode.
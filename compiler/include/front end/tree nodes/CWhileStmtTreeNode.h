@@ -27,13 +27,22 @@ private:
 	//only CTreeNodeFactory can instantiate tree nodes
 	friend class CTreeNodeFactory;
 
+	/**
+	 * Lower the loop condition and add a jump which depends on it's value.
+	 * @param JumpIfTrue True to jump when the condition holds, false to
+	 *        jump when it doesn't.
+	 * @param Target Label to jump to.
+	 * @param Stmts Global MIR tree to add the statements to.
+	 */
+	void AddLoopTest(bool JumpIfTrue, const string &Target, CTreeNode *Stmts);
+
 public:
 
 	/**
 	 * Inherited from CTreeNode.
 	 * @see CTreeNode.
 	 */
-	void DumpAsParseTreeNode(TiXmlElement *XmlNode);
+	void DumpAsParseTreeNode(CXmlWriter &XmlOut);
 
 	/**
 	 * Inherited from CTreeNode.
@@ -43,7 +52,9 @@ public:
 
 	/**
 	 * Inherited from CTreeNode. Calls this function on each
-	 * statement in the body.
+	 * statement in the body. The loop is rotated so the condition is
+	 * tested once before entering it and again at the bottom of the body,
+	 * leaving a single conditional jump on each iteration.
 	 * @see CTreeNode.
 	 */
 	CTreeNode* RewriteIntoMIRForm(CTreeNode *Stmts);
@@ -0,0 +1,138 @@
+//------------------------------------------------------------------------------------------
+// File: CConstantFolder.h
+// Desc: Folds expressions whose value is known at compile time during MIR lowering
+// Auth: Lee Millward
+//------------------------------------------------------------------------------------------
+
+#ifndef __CCONSTANTFOLDER_H__
+#define __CCONSTANTFOLDER_H__
+
+#include "TokenTypes.h"
+
+//forward decls
+class CTreeNode;
+
+/**
+ * Called by the arithmetic and Boolean expressions as they're lowered into
+ * MIR form to avoid creating temporaries for values which are already known.
+ * An expression whose operands are both constant is replaced by a literal
+ * holding it's value, one with only one constant operand may still reduce
+ * to a plain copy of the other when it's an identity such as x + 0 or x * 1.
+ * <br><br>
+ * An operand is constant if it's a literal or, once lowered, a reference to
+ * a floating point literal. The values are worked out the same way the
+ * generated code would, integers are 32 bit and wrap around on overflow and
+ * floating point values are single precision. Anything the code generator
+ * would treat differently, mixing integer and floating point operands or
+ * dividing by zero for example, is left alone so the folded program always
+ * does exactly what it would have done.
+ * <br><br>
+ * Every integer literal the folder builds is a TOKTYPE_INTLITERAL, the
+ * same as one which appeared in the source.
+ */
+class CConstantFolder
+{
+public:
+	/**
+	 * Fold an arithmetic expression with constant operands.
+	 * @param Lhs LHS of the expression, either lowered or a literal.
+	 * @param Rhs RHS of the expression, either lowered or a literal.
+	 * @param Op The arithmetic operator.
+	 * @param Stmts The MIR tree being built.
+	 * @return The value of the expression in MIR form or NULL if it
+	 *         can't be folded.
+	 */
+	static CTreeNode* FoldArithExpr(CTreeNode *Lhs, CTreeNode *Rhs, TokenType Op,
+		CTreeNode *Stmts);
+
+	/**
+	 * Fold a Boolean expression with constant operands into the literal 1
+	 * or 0 depending on whether it's true.
+	 * @param Lhs LHS of the expression, either lowered or a literal.
+	 * @param Rhs RHS of the expression, either lowered or a literal.
+	 * @param Op The relational or logical operator.
+	 * @return The value of the expression in MIR form or NULL if it
+	 *         can't be folded.
+	 */
+	static CTreeNode* FoldBooleanExpr(CTreeNode *Lhs, CTreeNode *Rhs, TokenType Op);
+
+	/**
+	 * Simplify an arithmetic expression where one side is an identifier and
+	 * the other a constant which makes the operation an identity, or makes
+	 * the result zero for an integer multiply. An identity on a global is
+	 * left alone since the global would then be read later than it was.
+	 * @param Lhs Lowered LHS of the expression.
+	 * @param Rhs Lowered RHS of the expression.
+	 * @param Op The arithmetic operator.
+	 * @return The identifier or a literal zero to use in place of the
+	 *         expression, or NULL if it can't be simplified.
+	 */
+	static CTreeNode* SimplifyArithExpr(CTreeNode *Lhs, CTreeNode *Rhs, TokenType Op);
+
+	/**
+	 * Find out if the lowered condition of an if statement is an integer
+	 * constant, such as a Boolean expression which has already been folded,
+	 * so the branch it controls is known at compile time.
+	 * @param CondExpr The lowered conditional expression.
+	 * @param Taken Receives true if the condition is non-zero.
+	 * @return True if the condition is constant.
+	 */
+	static bool FoldCondition(CTreeNode *CondExpr, bool &Taken);
+
+	/**
+	 * Build the opposite of a lowered conditional expression so a branch
+	 * can be taken when the condition is false instead of when it's true.
+	 * The code generated for the result tests the same flags with the
+	 * opposite jump so it's taken in exactly the cases the original wasn't.
+	 * @param CondExpr The lowered conditional expression, a Boolean
+	 *        expression is inverted in place.
+	 * @return The inverted expression or NULL if there isn't an exact
+	 *         inverse, such as for a floating point variable.
+	 */
+	static CTreeNode* InvertCondExpr(CTreeNode *CondExpr);
+
+private:
+
+	/** The value of a constant operand. */
+	struct ConstValue_t
+	{
+		/** True if the value is floating point. */
+		bool IsFloat;
+
+		/** The value if it's an integer. */
+		int IntVal;
+
+		/** The value if it's floating point. */
+		float FloatVal;
+	};
+
+	/**
+	 * Find out if an operand is constant and what it's value is.
+	 * @param Node The operand.
+	 * @param Val Receives the value.
+	 * @return True if the operand is constant.
+	 */
+	static bool GetConstValue(CTreeNode *Node, ConstValue_t &Val);
+
+	/**
+	 * Work out the value of an arithmetic operation on two constants of
+	 * the same type.
+	 * @param Lhs Value of the LHS.
+	 * @param Rhs Value of the RHS.
+	 * @param Op The arithmetic operator.
+	 * @param Result Receives the result.
+	 * @return True if the result could be worked out.
+	 */
+	static bool EvaluateArithOp(const ConstValue_t &Lhs, const ConstValue_t &Rhs,
+		TokenType Op, ConstValue_t &Result);
+
+	/**
+	 * Build a literal holding a value in MIR form.
+	 * @param Val The value.
+	 * @param Stmts The MIR tree being built.
+	 * @return The literal, or a reference to it if it's floating point.
+	 */
+	static CTreeNode* BuildConstant(const ConstValue_t &Val, CTreeNode *Stmts);
+};
+
+#endif
@@ -9,6 +9,7 @@
 #define __CCONTROLFLOWGRAPH_H__
 
 #include "CIdentifierTreeNode.h"
+#include "CStmtList.h"
 #include "CUtilFuncs.h"
 
 //forward decls
@@ -18,13 +19,66 @@ class CFunctionDeclTreeNode;
  * Representation of a single basic block within the CFG. The edges 
  * between nodes are represented by Preds and Succs, together these 
  * give the flow of control for a function.
+ * <br><br>
+ * A block doesn't hold it's own copy of it's statements, it's the range
+ * of the function body from FirstStmt to LastStmt. Statements should be 
+ * added to or removed from a block through InsertStmtBefore, InsertStmtAfter
+ * and RemoveStmt which keep the block and the function body in step. The
+ * statements are walked with:
+ * <br><br>
+ * for(CTreeNode *Stmt = Bb->FirstStmt; Stmt; Stmt = Bb->GetNextStmt(Stmt))
  */
 struct BasicBlock_t
 {
-	BasicBlock_t() : ExitBb(false), BbId(0), Fallthru(false) {}
+	BasicBlock_t() : FuncBody(NULL), FirstStmt(NULL), LastStmt(NULL), NumStmts(0), 
+		ExitBb(false), BbId(0), Fallthru(false) {}
 
-	/** Sequence of statements contained by this block. */
-	list<CTreeNode*> Stmts;
+	/**
+	 * Extend the block to cover the statement which follows it in the 
+	 * function body, used when the blocks are first partitioned.
+	 * @param Stmt The statement after LastStmt, or the first statement of
+	 *        the block if it's empty.
+	 */
+	void ExtendToStmt(CTreeNode *Stmt);
+
+	/**
+	 * Add a new statement to the block and the function body.
+	 * @param Pos Statement in this block to insert in front of.
+	 * @param Stmt The statement to add.
+	 */
+	void InsertStmtBefore(CTreeNode *Pos, CTreeNode *Stmt);
+
+	/**
+	 * Add a new statement to the block and the function body.
+	 * @param Pos Statement in this block to insert after.
+	 * @param Stmt The statement to add.
+	 */
+	void InsertStmtAfter(CTreeNode *Pos, CTreeNode *Stmt);
+
+	/**
+	 * Take a statement out of the block and the function body, the
+	 * statement itself isn't destroyed.
+	 * @param Stmt Statement in this block to remove.
+	 */
+	void RemoveStmt(CTreeNode *Stmt);
+
+	/**
+	 * @param Stmt A statement in this block.
+	 * @return The statement after Stmt or NULL if Stmt ends the block.
+	 */
+	CTreeNode* GetNextStmt(CTreeNode *Stmt) { return Stmt == LastStmt ? NULL : Stmt->NextStmt; }
+
+	/** Body of the function this block is part of. */
+	CStmtList *FuncBody;
+
+	/** First statement in the block, NULL if it's empty. */
+	CTreeNode *FirstStmt;
+
+	/** Last statement in the block, NULL if it's empty. */
+	CTreeNode *LastStmt;
+
+	/** Number of statements in the block. */
+	unsigned int NumStmts;
 
 	/** Successors for this block. */
 	set<BasicBlock_t*, CompBasicBlocks> Successors;
@@ -59,7 +113,6 @@ struct BasicBlock_t
 
 //iterator typedefs to make changing the containers easier
 typedef set<BasicBlock_t*, CompBasicBlocks>::iterator BasicBlockItr;
-typedef list<CTreeNode*>::iterator BasicBlockStmtItr;
 
 /**
  * Control flow graph construction pass of the compiler to be run
@@ -97,6 +150,14 @@ private:
 	 */
 	void ComputeEdges(CFunctionDeclTreeNode **FnDecl);
 
+	/**
+	 * Create a new empty basic block, it's placed in the tree node 
+	 * factory's current arena if it's using one.
+	 * @param FuncBody Body of the function the block is part of.
+	 * @return The new basic block.
+	 */
+	BasicBlock_t* BuildBasicBlock(CStmtList *FuncBody);
+
 	/**
 	 * Determine if the statement passed is classified as a leader
 	 * statement that marks the beginning of a new basic block.
@@ -125,7 +186,7 @@ private:
 	 * blocks entry label. The multimap search algorithms are logarithmic in nature so
 	 * we reduce the complexity by an order of magnitude.
 	 */
-	multimap<string, BasicBlock_t*> m_Edges;
+	multimap<Atom, BasicBlock_t*> m_Edges;
 };
 
 #endif
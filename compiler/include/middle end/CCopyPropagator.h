@@ -0,0 +1,141 @@
+//------------------------------------------------------------------------------------------
+// File: CCopyPropagator.h
+// Desc: Removes compiler temporaries which only pass a value on to somewhere else
+// Auth: Lee Millward
+//------------------------------------------------------------------------------------------
+
+#ifndef __CCOPYPROPAGATOR_H__
+#define __CCOPYPROPAGATOR_H__
+
+#include "CStmtList.h"
+
+//forward decls
+class CTreeNode;
+class CFunctionDeclTreeNode;
+class CVarDeclTreeNode;
+struct Symbol_t;
+
+/**
+ * Run over each function once it's been lowered into MIR form to get rid
+ * of the temporaries lowering creates just to hold a value for a moment,
+ * such as the result of a call or an array element from ReplaceCallExpr
+ * and ReplaceArrayRefs. Every temporary removed is one less live interval
+ * for the register allocator and one less move in the generated code.
+ * <br><br>
+ * Only the patterns lowering produces are looked for, where a temporary
+ * is declared and assigned straight away:
+ * <br><br>
+ * 1. The temporary is read once, by the next statement. If that statement
+ *    copies it somewhere, "T = arr[i]; x = T", the value is assigned to
+ *    the destination directly, "x = arr[i]". If the temporary is a copy of
+ *    another variable, "T = y; z = z + T", the variable is used in it's
+ *    place, "z = z + y". A copy which ends up storing a variable to
+ *    itself is removed altogether.
+ * <br><br>
+ * 2. The temporary is a copy of another temporary which isn't read again,
+ *    "T2 = T1; T2 = T2 / 2", in which case the two are coalesced into one,
+ *    "T1 = T1 / 2".
+ * <br><br>
+ * 3. The temporary is worked out over a few statements then copied to a
+ *    variable, "T = y; T = T + 1; x = T", which isn't read until then. The
+ *    statements are made to work on the variable instead, "x = y; x = x + 1".
+ * <br><br>
+ * A temporary is only replaced by something of the same type so the code
+ * generator handles the statement the same way it would have before.
+ */
+class CCopyPropagator
+{
+public:
+	CCopyPropagator(void) : m_Body(NULL) {};
+
+	/**
+	 * Forward and coalesce the temporaries in a function's body.
+	 * @param FnDecl The function, in MIR form.
+	 */
+	void PropagateCopies(CFunctionDeclTreeNode *FnDecl);
+
+private:
+
+	/**
+	 * Try to forward the value of a temporary to the statement which
+	 * reads it.
+	 * @param TempDecl The temporary's var_decl.
+	 * @param Next Receives the statement to carry on from.
+	 * @return True if the temporary was removed.
+	 */
+	bool ForwardTemp(CVarDeclTreeNode *TempDecl, CTreeNode *&Next);
+
+	/**
+	 * Try to coalesce a temporary with the one it's a copy of.
+	 * @param TempDecl The temporary's var_decl.
+	 * @param Next Receives the statement to carry on from.
+	 * @return True if the temporary was removed.
+	 */
+	bool CoalesceTemp(CVarDeclTreeNode *TempDecl, CTreeNode *&Next);
+
+	/**
+	 * Try to have the statements which work out a temporary's value
+	 * work on the variable it's copied to instead.
+	 * @param TempDecl The temporary's var_decl.
+	 * @param Next Receives the statement to carry on from.
+	 * @return True if the temporary was removed.
+	 */
+	bool RetargetTemp(CVarDeclTreeNode *TempDecl, CTreeNode *&Next);
+
+	/**
+	 * Find out if a statement assigns a value to a symbol.
+	 * @param Stmt The statement, can be NULL.
+	 * @param Sym The symbol.
+	 * @return True if Stmt is an assign_expr whose LHS is Sym.
+	 */
+	bool IsAssignTo(CTreeNode *Stmt, Symbol_t *Sym);
+
+	/**
+	 * Find out if an expression is a reference to a compiler temporary.
+	 * @param Expr The expression.
+	 * @return The temporary's symbol or NULL.
+	 */
+	Symbol_t* GetTempSymbol(CTreeNode *Expr);
+
+	/**
+	 * Adjust the number of references to each symbol ahead of us by the
+	 * number in an expression.
+	 * @param Expr Expression or statement to count the references in.
+	 * @param Delta 1 to add them, -1 to take them away.
+	 */
+	void CountRefs(CTreeNode *Expr, int Delta);
+
+	/**
+	 * Count the references to one symbol in an expression.
+	 * @param Expr Expression or statement to look through.
+	 * @param Sym The symbol.
+	 * @return The number of identifiers bound to Sym.
+	 */
+	unsigned int CountRefsTo(CTreeNode *Expr, Symbol_t *Sym);
+
+	/**
+	 * Replace the references to one symbol in an expression.
+	 * @param Expr Expression or statement to look through.
+	 * @param Sym The symbol to replace.
+	 * @param With The identifier to replace it with.
+	 * @return The number of references replaced.
+	 */
+	unsigned int ReplaceRefs(CTreeNode *Expr, Symbol_t *Sym, CTreeNode *With);
+
+	/**
+	 * Find out if the code generator treats two values the same way.
+	 * @return True if they're both floating point or both not.
+	 */
+	bool IsSameKindOfValue(CTreeNode *A, CTreeNode *B);
+
+	/** Body of the function being processed. */
+	CStmtList *m_Body;
+
+	/**
+	 * Number of references to each symbol in the statements we haven't
+	 * passed yet, including the one we're looking at.
+	 */
+	map<Symbol_t*, int> m_Refs;
+};
+
+#endif
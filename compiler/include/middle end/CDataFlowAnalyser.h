@@ -7,9 +7,40 @@
 #ifndef __CDATAFLOWANALYSER_H__
 #define __CDATAFLOWANALYSER_H__
 
+#include "CTreeVisitor.h"
+
 //forward decls
 struct BasicBlock_t;
-class CFunctionDeclTreeNode;
+
+/**
+ * Walks an expression adding every variable it reads to the "uses" set
+ * of a basic block.
+ */
+class CUseScanner : public CTreeVisitor<CUseScanner>
+{
+	friend class CTreeVisitor<CUseScanner>;
+
+public:
+	/**
+	 * @param Block Basic block any uses found are added to.
+	 */
+	CUseScanner(BasicBlock_t *Block) : m_Block(Block) {};
+
+private:
+	//handlers for each type of node which can appear in an expression
+	void VisitIdentifier(CIdentifierTreeNode *Id);
+	void VisitUnaryExpr(CUnaryExprTreeNode *Expr);
+	void VisitArithExpr(CArithExprTreeNode *Expr);
+	void VisitBooleanExpr(CBooleanExprTreeNode *Expr);
+	void VisitCallExpr(CCallExprTreeNode *Expr);
+	void VisitArrayRef(CArrayRefTreeNode *Ref);
+	void VisitLiteral(CLiteralTreeNode *Lit) {};
+	void VisitLiteralRef(CLiteralRefTreeNode *Ref) {};
+	void VisitNode(CTreeNode *Node);
+
+	/** Basic block we're scanning for uses. */
+	BasicBlock_t *m_Block;
+};
 
 /**
  * Implementation of a worklist based solver for the use-defs and 
@@ -17,10 +48,12 @@ class CFunctionDeclTreeNode;
  * at a time and works but continually solving the equations for each
  * block in the functions CFG until a solution is converged upon. 
  */
-class CDataFlowAnalyser
+class CDataFlowAnalyser : public CTreeVisitor<CDataFlowAnalyser>
 {
+	friend class CTreeVisitor<CDataFlowAnalyser>;
+
 public:
-	CDataFlowAnalyser(void) {};
+	CDataFlowAnalyser(void) : m_CurrBlock(NULL) {};
 	~CDataFlowAnalyser(void) {};
 
 	/** 
@@ -73,23 +106,18 @@ private:
 	 */
 	void DumpDataFlowInformation(list<BasicBlock_t*> &Graph, string FuncName);
 
-	/**
-	 * Scan a tree node for var uses, adding any found to the "uses"
-	 * set of the basic block.
-	 * @param Stmt Generic stmt we're looking for uses in.
-	 * @param Block Basic block we're scanning for uses.
-	 */
-	void ScanStmtForUses(CTreeNode *Stmt, BasicBlock_t *Block);
-
-	/** 
-	 * Subroutine of ScanStmtForUses to specifically handle identifier
-	 * tree nodes as they have far greater potential for referencing 
-	 * other values in the program.
-	 * @param Id Identifier node we're looking at for uses of other variables.
-	 * @param Block Current basic block being processed where we'll add
-	 *        any uses to.
-	 */
-	void ScanIdentifierNodeForUses(CTreeNode *Id, BasicBlock_t *Block);
+	//handlers for each type of statement ComputeUseDefs can find in a
+	//block, they add what the statement defines and uses to m_CurrBlock
+	void VisitVarDecl(CVarDeclTreeNode *VarDecl);
+	void VisitAssignExpr(CAssignExprTreeNode *AssignExpr);
+	void VisitReturnStmt(CReturnStmtTreeNode *RetStmt);
+	void VisitIfStmt(CIfStmtTreeNode *IfStmt);
+	void VisitCallExpr(CCallExprTreeNode *CallExpr);
+	void VisitArrayDecl(CArrayDeclTreeNode *ArrDecl);
+	void VisitBooleanExpr(CBooleanExprTreeNode *Expr);
+	void VisitLabel(CLabelTreeNode *Label) {};
+	void VisitGotoExpr(CGotoExprTreeNode *Goto) {};
+	void VisitNode(CTreeNode *Node);
 
 	/**
 	 * Helper function to compare two sets for equality. Although the 
@@ -112,6 +140,9 @@ private:
 	 */
 	int m_CurrStmtNo;
 
+	/** Basic block ComputeUseDefs is currently scanning. */
+	BasicBlock_t *m_CurrBlock;
+
 	/** Worklist of remaining blocks to process. */
 	deque<BasicBlock_t*> m_Worklist;
 };
@@ -0,0 +1,510 @@
+//------------------------------------------------------------------------------------------
+// File: CMirCache.h
+// Desc: On disk cache of lowered MIR trees, keyed by the source they were built from
+// Auth: Lee Millward
+//------------------------------------------------------------------------------------------
+
+#ifndef __CMIRCACHE_H__
+#define __CMIRCACHE_H__
+
+#include "CTreeVisitor.h"
+#include "CSymbolTable.h"
+
+/**
+ * Moves the attributes of each type of tree node through an archive. The
+ * same code finds every node which needs saving, saves them and loads them
+ * back in again so the three can never disagree about the layout of a node.
+ * <br><br>
+ * An archive provides Int, Bool, Str, Enum, NodeRef and SymbolRef functions
+ * which each take a reference to the value being transferred. Children are
+ * transferred separately as they're the same for every type of node.
+ */
+template<typename Archive>
+class CMirNodeTransfer : public CTreeVisitor<CMirNodeTransfer<Archive> >
+{
+	friend class CTreeVisitor<CMirNodeTransfer<Archive> >;
+
+public:
+	/**
+	 * @param Ar The archive to transfer each node's attributes through.
+	 */
+	CMirNodeTransfer(Archive &Ar) : m_Ar(Ar) {};
+
+private:
+	void VisitIdentifier(CIdentifierTreeNode *Id)
+	{
+		m_Ar.Str(Id->IdName);
+		m_Ar.Int(Id->IdAtom);
+		m_Ar.Enum(Id->ExprType);
+		m_Ar.SymbolRef(Id->Binding);
+	}
+
+	void VisitVarDecl(CVarDeclTreeNode *VarDecl)
+	{
+		m_Ar.NodeRef(VarDecl->VarId);
+		m_Ar.NodeRef(VarDecl->InitExpression);
+		m_Ar.Bool(VarDecl->IsConst);
+		m_Ar.Enum(VarDecl->VarType);
+		m_Ar.Bool(VarDecl->Spilled);
+		m_Ar.Int(VarDecl->SpillPoint);
+		m_Ar.Int(VarDecl->StackFrameAddr);
+		m_Ar.Enum(VarDecl->AllocatedReg);
+		m_Ar.Bool(VarDecl->GlobalVar);
+		m_Ar.Int(VarDecl->DeclPoint);
+	}
+
+	void VisitLiteral(CLiteralTreeNode *Lit)
+	{
+		m_Ar.Enum(Lit->LitType);
+		m_Ar.Str(Lit->LitValue);
+	}
+
+	void VisitArithExpr(CArithExprTreeNode *Expr)
+	{
+		m_Ar.Enum(Expr->Operator);
+		m_Ar.Enum(Expr->ExprType);
+	}
+
+	void VisitBooleanExpr(CBooleanExprTreeNode *Expr)
+	{
+		m_Ar.Enum(Expr->Operator);
+	}
+
+	void VisitUnaryExpr(CUnaryExprTreeNode *Expr)
+	{
+		m_Ar.Enum(Expr->Operator);
+		m_Ar.Enum(Expr->ExprType);
+	}
+
+	void VisitArrayRef(CArrayRefTreeNode *Ref)
+	{
+		m_Ar.NodeRef(Ref->ArrName);
+		m_Ar.Enum(Ref->ArrType);
+	}
+
+	void VisitFunctionDecl(CFunctionDeclTreeNode *FnDecl)
+	{
+		//the CFG is built after the tree is cached
+		SanityCheck(FnDecl->FuncCFG.empty());
+
+		m_Ar.Enum(FnDecl->RetType);
+		m_Ar.Int(FnDecl->NumParameters);
+		m_Ar.Str(FnDecl->Name);
+		m_Ar.SymbolRef(FnDecl->Binding);
+		m_Ar.Int(FnDecl->StackFrameSize);
+		m_Ar.Int(FnDecl->SpillVarsOffset);
+		m_Ar.StmtList(FnDecl->Body);
+	}
+
+	void VisitParameterDecl(CParameterDeclTreeNode *ParmDecl)
+	{
+		m_Ar.Enum(ParmDecl->Type);
+		m_Ar.Bool(ParmDecl->IsConst);
+		m_Ar.Int(ParmDecl->Position);
+	}
+
+	void VisitCallExpr(CCallExprTreeNode *Expr)
+	{
+		m_Ar.Str(Expr->FuncName);
+		m_Ar.Enum(Expr->ExprType);
+		m_Ar.SymbolRef(Expr->Binding);
+	}
+
+	void VisitLabel(CLabelTreeNode *Label)
+	{
+		m_Ar.Str(Label->Name);
+		m_Ar.Int(Label->NameAtom);
+	}
+
+	void VisitGotoExpr(CGotoExprTreeNode *Goto)
+	{
+		m_Ar.Str(Goto->Target);
+		m_Ar.Int(Goto->TargetAtom);
+	}
+
+	void VisitLiteralRef(CLiteralRefTreeNode *Ref)
+	{
+		m_Ar.Str(Ref->RefID);
+	}
+
+	//nodes which have nothing besides their children
+	void VisitArrayDecl(CArrayDeclTreeNode *ArrDecl) {};
+	void VisitIfStmt(CIfStmtTreeNode *IfStmt) {};
+	void VisitWhileStmt(CWhileStmtTreeNode *WhileStmt) {};
+	void VisitAssignExpr(CAssignExprTreeNode *AssignExpr) {};
+	void VisitParameterList(CParameterListTreeNode *ParmList) {};
+	void VisitReturnStmt(CReturnStmtTreeNode *RetStmt) {};
+	void VisitRoot(CRootTreeNode *Root) {};
+
+	/** Archive the attributes are transferred through. */
+	Archive &m_Ar;
+};
+
+/**
+ * Archive which finds every node and symbol that has to be saved, giving
+ * each one an id. Nothing is actually transferred.
+ */
+class CMirCollectArchive
+{
+public:
+	CMirCollectArchive(void) : m_NextNode(0) {};
+
+	void Int(int &Val) {};
+	void Bool(bool &Val) {};
+	void Str(string &Val) {};
+	template<typename T> void Enum(T &Val) {};
+	void StringMap(map<string, string> &Map) {};
+	void StringList(vector<string> &List) {};
+
+	template<typename T>
+	void NodeRef(T *&Node)
+	{
+		if(Node)
+			AddNode(Node);
+	}
+
+	void SymbolRef(Symbol_t *&Sym);
+	void NodeList(list<CTreeNode*> &List);
+	void StmtList(CStmtList &List);
+
+	/**
+	 * Give a node an id if it hasn't already got one.
+	 * @param Node The node to add.
+	 */
+	void AddNode(CTreeNode *Node);
+
+	/**
+	 * Add everything which can be reached from the nodes added so far.
+	 * @param FollowSymbols True to also add the declarations the symbols
+	 *        found point at, along with everything reachable from them.
+	 */
+	void AddReachable(bool FollowSymbols);
+
+	/** @return The nodes found so far in the order of their ids. */
+	const vector<CTreeNode*>& GetNodes(void) { return m_Nodes; };
+
+	/** @return The symbols found so far in the order of their ids. */
+	const vector<Symbol_t*>& GetSymbols(void) { return m_Symbols; };
+
+	/** @return The id of a node which has been added. */
+	int GetNodeId(CTreeNode *Node);
+
+	/** @return The id of a symbol which has been added. */
+	int GetSymbolId(Symbol_t *Sym);
+
+private:
+	/** Every node found, indexed by id. */
+	vector<CTreeNode*> m_Nodes;
+
+	/** The id of each node found. */
+	map<CTreeNode*, int> m_NodeIds;
+
+	/** Every symbol found, indexed by id. */
+	vector<Symbol_t*> m_Symbols;
+
+	/** The id of each symbol found. */
+	map<Symbol_t*, int> m_SymbolIds;
+
+	/** Id of the first node AddReachable hasn't looked at yet. */
+	unsigned int m_NextNode;
+};
+
+/** Archive which writes everything transferred through it into a buffer. */
+class CMirWriteArchive
+{
+public:
+	/**
+	 * @param Ids The collector used to find what's being written, nodes
+	 *        and symbols are written as their ids from it.
+	 */
+	CMirWriteArchive(CMirCollectArchive &Ids) : m_Ids(Ids) {};
+
+	void Int(int &Val);
+	void Bool(bool &Val);
+	void Str(string &Val);
+	void StringMap(map<string, string> &Map);
+	void StringList(vector<string> &List);
+	void NodeList(list<CTreeNode*> &List);
+	void StmtList(CStmtList &List);
+	void SymbolRef(Symbol_t *&Sym);
+
+	template<typename T>
+	void Enum(T &Val)
+	{
+		int Temp = (int)Val;
+		Int(Temp);
+	}
+
+	template<typename T>
+	void NodeRef(T *&Node)
+	{
+		int Id = Node ? m_Ids.GetNodeId(Node) : -1;
+		Int(Id);
+	}
+
+	/** @return Everything written so far. */
+	const string& GetBuffer(void) { return m_Buffer; };
+
+private:
+	/** Where the ids of nodes and symbols come from. */
+	CMirCollectArchive &m_Ids;
+
+	/** The bytes written so far. */
+	string m_Buffer;
+};
+
+/**
+ * Archive which reads back what a CMirWriteArchive wrote, straight out of
+ * a cache file mapped into memory. Running off the end of the data raises
+ * an ICE.
+ */
+class CMirReadArchive
+{
+public:
+	/**
+	 * @param Data The data to read from.
+	 * @param Size Size of Data in bytes.
+	 */
+	CMirReadArchive(const char *Data, size_t Size) : m_Data(Data), m_Size(Size), m_Pos(0) {};
+
+	void Int(int &Val);
+	void Bool(bool &Val);
+	void Str(string &Val);
+	void StringMap(map<string, string> &Map);
+	void StringList(vector<string> &List);
+	void NodeList(list<CTreeNode*> &List);
+	void StmtList(CStmtList &List);
+	void SymbolRef(Symbol_t *&Sym);
+
+	template<typename T>
+	void Enum(T &Val)
+	{
+		int Temp;
+		Int(Temp);
+		Val = (T)Temp;
+	}
+
+	template<typename T>
+	void NodeRef(T *&Node)
+	{
+		int Id;
+		Int(Id);
+		Node = static_cast<T*>(GetNode(Id));
+	}
+
+	/**
+	 * Set the nodes which are referred to by their ids from now on.
+	 * @param Nodes The nodes, indexed by id.
+	 */
+	void SetNodes(const vector<CTreeNode*> &Nodes) { m_Nodes = Nodes; };
+
+	/**
+	 * Set the symbols which are referred to by their ids from now on.
+	 * @param Symbols The symbols, indexed by id.
+	 */
+	void SetSymbols(const vector<Symbol_t*> &Symbols) { m_Symbols = Symbols; };
+
+	/** @return True if everything has been read. */
+	bool AtEnd(void) { return m_Pos == m_Size; };
+
+private:
+	/** @return The node with the id, NULL for an id of -1. */
+	CTreeNode* GetNode(int Id);
+
+	/**
+	 * Move past some bytes, raising an ICE if there aren't enough left.
+	 * @return The first byte moved past.
+	 */
+	const char* Advance(size_t Len);
+
+	/** The data being read. */
+	const char *m_Data;
+
+	/** Size of m_Data in bytes. */
+	size_t m_Size;
+
+	/** Offset of the next byte to read. */
+	size_t m_Pos;
+
+	/** The nodes read so far, indexed by id. */
+	vector<CTreeNode*> m_Nodes;
+
+	/** The symbols read so far, indexed by id. */
+	vector<Symbol_t*> m_Symbols;
+};
+
+/**
+ * Keeps the MIR lowered from each source file on disk so compiling the same
+ * source again can skip the front end entirely. Each file is keyed by a hash
+ * of the source text and of the compiler's own executable, so a cached tree
+ * is only used if both are exactly the same as when it was lowered.
+ * <br><br>
+ * Along with the tree the file holds the symbols it's bound to, the atom
+ * table and the contents of CGlobalDataStore since lowering adds to all of
+ * them. Loading a tree maps the file into memory and reads each node straight
+ * out of it into the MIR arena, leaving it ready for the CFG to be built.
+ * <br><br>
+ * The number of hits and misses is kept in the cache directory along with
+ * the cached trees.
+ */
+class CMirCache
+{
+public:
+	/**
+	 * @param CacheDir Directory the cache files are kept in, it's created
+	 *        if it doesn't exist.
+	 */
+	CMirCache(const string &CacheDir);
+	~CMirCache(void);
+
+	/**
+	 * Look for a tree lowered from the same source by the same compiler. On
+	 * a hit the tree is rebuilt in the MIR arena along with everything it
+	 * refers to. This must be done before anything is added to the atom table
+	 * so the atoms come out the same as when the tree was saved.
+	 * @param SourceFile The source file being compiled.
+	 * @return The MIR tree or NULL if there's nothing cached for the source.
+	 */
+	CTreeNode* Lookup(const string &SourceFile);
+
+	/**
+	 * Save a freshly lowered tree under the key worked out by Lookup. This
+	 * must be done before the parse tree is destroyed as there may be symbols
+	 * which still point into it.
+	 * @param MirTree The MIR tree lowered from the source passed to Lookup.
+	 */
+	void Store(CTreeNode *MirTree);
+
+	/** Tell the user whether Lookup hit and how the cache has done overall. */
+	void ReportStatistics(void);
+
+private:
+
+	/**
+	 * Work out the key for a source file.
+	 * @param SourceFile The source file being compiled.
+	 * @return True if the key was computed, false if a file couldn't be read.
+	 */
+	bool ComputeKey(const string &SourceFile);
+
+	/**
+	 * Add the hash of a file's contents to a hash value.
+	 * @param File Name of the file to hash.
+	 * @param Hash The hash value to add to.
+	 * @return True if the file was hashed, false if it couldn't be read.
+	 */
+	bool HashFile(const string &File, unsigned int *Hash);
+
+	/**
+	 * Add some bytes to a hash value. Two different 32 bit hashes are kept
+	 * to give 64 bits in all.
+	 * @param Bytes The bytes to add.
+	 * @param Len Number of bytes to add.
+	 * @param Hash The hash value to add to.
+	 */
+	static void HashBytes(const char *Bytes, size_t Len, unsigned int *Hash);
+
+	/**
+	 * Read a cache file back in.
+	 * @param Data Contents of the file.
+	 * @param Size Size of the file in bytes.
+	 * @return The MIR tree or NULL if the file isn't for our key.
+	 */
+	CTreeNode* LoadTree(const char *Data, size_t Size);
+
+	/**
+	 * Read or write the header at the start of each cache file.
+	 * @param Ar The archive to transfer it through.
+	 * @return True if the header read is for our key, always true if writing.
+	 */
+	template<typename Archive>
+	bool TransferHeader(Archive &Ar)
+	{
+		int Magic = MIR_CACHE_MAGIC;
+		int Version = MIR_CACHE_VERSION;
+		int KeyLo = (int)m_Key[0];
+		int KeyHi = (int)m_Key[1];
+
+		Ar.Int(Magic);
+		Ar.Int(Version);
+		Ar.Int(KeyLo);
+		Ar.Int(KeyHi);
+
+		return Magic == MIR_CACHE_MAGIC && Version == MIR_CACHE_VERSION &&
+		       KeyLo == (int)m_Key[0] && KeyHi == (int)m_Key[1];
+	}
+
+	/**
+	 * Read or write a symbol.
+	 * @param Ar The archive to transfer it through.
+	 * @param Sym The symbol.
+	 */
+	template<typename Archive>
+	static void TransferSymbol(Archive &Ar, Symbol_t &Sym)
+	{
+		Ar.Str(Sym.Name);
+		Ar.Int(Sym.NameAtom);
+		Ar.Int(Sym.LineNo);
+		Ar.Enum(Sym.SymType);
+		Ar.Int(Sym.ScopeDepth);
+		Ar.NodeRef(Sym.IdPtr);
+	}
+
+	/**
+	 * Map a file into memory, unmapping any file already mapped.
+	 * @param File Name of the file to map.
+	 * @return True if the file was mapped. An empty file can't be mapped
+	 *         so the view will be NULL for one.
+	 */
+	bool MapFile(const string &File);
+
+	/** Unmap the file mapped by MapFile. */
+	void UnmapFile(void);
+
+	/**
+	 * Count a hit or miss, saving the running totals.
+	 * @param Hit True for a hit, false for a miss.
+	 */
+	void UpdateStatistics(bool Hit);
+
+	/** @return Name of the cache file for our key. */
+	string GetCacheFileName(void);
+
+	/** Identifies a cache file, the first four bytes of the file. */
+	static const int MIR_CACHE_MAGIC = 0x4352494d;
+
+	/** Bumped whenever the layout of a cache file changes. */
+	static const int MIR_CACHE_VERSION = 2;
+
+	/** Directory holding the cache files. */
+	string m_CacheDir;
+
+	/** Key for the source passed to Lookup. */
+	unsigned int m_Key[2];
+
+	/** True if m_Key has been computed. */
+	bool m_KeyValid;
+
+	/** True if the last Lookup found a tree. */
+	bool m_Hit;
+
+	/** Total number of hits, including earlier runs. */
+	int m_NumHits;
+
+	/** Total number of misses, including earlier runs. */
+	int m_NumMisses;
+
+	/** Handle of the file mapped by MapFile. */
+	void *m_MappedFile;
+
+	/** Handle of the mapping of m_MappedFile. */
+	void *m_FileMapping;
+
+	/** The mapped view of the file, NULL for an empty one. */
+	char *m_MappedView;
+
+	/** Size of the mapped file in bytes. */
+	size_t m_MappedSize;
+};
+
+#endif
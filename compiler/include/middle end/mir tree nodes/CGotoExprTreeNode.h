@@ -21,7 +21,7 @@
  * <b>Children:</b><br>
  * &nbsp;&nbsp; None.
  */
-class CGotoExprTreeNode : public CTreeNode
+class CGotoExprTreeNode : public CFixedArityTreeNode<0>
 {
 private:
 	CGotoExprTreeNode(void) {}
@@ -35,11 +35,14 @@ public:
 	/** Target of the jump. */
 	string Target;
 
+	/** Target interned in the atom table. */
+	Atom TargetAtom;
+
 	/**
 	 * Inherited from CTreeNode. Should never be called.
 	 * @see CTreeNode.
 	 */
-	void DumpAsParseTreeNode(TiXmlElement *XmlNode)
+	void DumpAsParseTreeNode(CXmlWriter &XmlOut)
 	{
 		//should never happen
 		InternalError("attempt to dump goto expr as parse tree node");
@@ -16,7 +16,7 @@
  * of a CGotoExprTreeNode. Is only generated during MIR lowering
  * and should never appear in the higher level parse tree representation.
  */
-class CLabelTreeNode : public CTreeNode
+class CLabelTreeNode : public CFixedArityTreeNode<0>
 {
 private:
 	CLabelTreeNode(void) {}
@@ -30,11 +30,14 @@ public:
 	/** Name of the label. */
 	string Name;
 
+	/** Name interned in the atom table. */
+	Atom NameAtom;
+
 	/**
 	 * Inherited from CTreeNode. Should never be called.
 	 * @see CTreeNode.
 	 */
-	void DumpAsParseTreeNode(TiXmlElement *XmlNode)
+	void DumpAsParseTreeNode(CXmlWriter &XmlOut)
 	{
 		//shouldn't happen as label's don't appear in the
 		//higher level representation
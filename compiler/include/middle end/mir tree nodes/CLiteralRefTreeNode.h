@@ -19,7 +19,7 @@
  * <b>Children:</b><br>
  * &nbsp;&nbsp; 0. Literal being referred to.
  */
-class CLiteralRefTreeNode : public CTreeNode
+class CLiteralRefTreeNode : public CFixedArityTreeNode<LITREF_NUM_CHILDREN>
 {
 private:
 
@@ -56,7 +56,7 @@ public:
 	 * Inherited from CTreeNode. Should never be called.
 	 * @see CTreeNode.
 	 */
-	void DumpAsParseTreeNode(TiXmlElement *XmlNode)
+	void DumpAsParseTreeNode(CXmlWriter &XmlOut)
 	{
 		InternalError("attempt to dump literal ref as parse tree node");
 	}
@@ -67,6 +67,10 @@ public:
 	 */
 	CTreeNode* CreateCopy(void)
 	{
+		//neither the ref nor it's literal are changed once built
+		if(CTreeNodeFactory::GetSingletonPtr()->CanShareNode(this))
+			return this;
+
 		return CTreeNodeFactory::GetSingletonPtr()->BuildLiteralRef(
 			GetChild(LITREF_LITERAL), RefID);
 	}
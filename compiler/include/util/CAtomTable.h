@@ -0,0 +1,101 @@
+//------------------------------------------------------------------------------------------
+// File: CAtomTable.h
+// Desc: Interns the names of identifiers, temporaries and labels.
+// Auth: Lee Millward
+//------------------------------------------------------------------------------------------
+
+#ifndef __CATOMTABLE_H__
+#define __CATOMTABLE_H__
+
+#include "ISingleton.h"
+
+/** 
+ * Handle to a name stored in the atom table, two atoms are equal if and 
+ * only if the names they were interned from are equal.
+ */
+typedef int Atom;
+
+/** Returned by CAtomTable::FindAtom for names which haven't been interned. */
+const Atom NULL_ATOM = -1;
+
+/**
+ * Every identifier, compiler temporary and label name used throughout the 
+ * compiler is interned here when it's tree node is created and handed out as
+ * a small dense integer. Comparing two names or using them as the key in a 
+ * set or map then only needs an integer comparison rather than a string one.
+ * <br><br>
+ * Internally the names are kept in a vector indexed by their atom with an
+ * open addressed hash table mapping each name back to it's atom. Atoms are
+ * never freed, the table only grows until it's destroyed at the end of 
+ * compilation.
+ */
+class CAtomTable : public ISingleton<CAtomTable>
+{
+public:
+	CAtomTable(void);
+	~CAtomTable(void) {}
+
+	/**
+	 * Get the atom for a name, adding it to the table if it's not already
+	 * been seen.
+	 * @param Name The name to intern.
+	 * @return The atom for Name.
+	 */
+	Atom Intern(const string &Name);
+
+	/**
+	 * Look up the atom for a name without adding it to the table.
+	 * @param Name The name to look up.
+	 * @return The atom for Name or NULL_ATOM if it's never been interned.
+	 */
+	Atom FindAtom(const string &Name);
+
+	/**
+	 * Get the name an atom was interned from.
+	 * @param Name The atom to look up.
+	 * @return The name the atom refers to.
+	 */
+	const string& GetName(Atom Name);
+
+	/**
+	 * Find out how many names have been interned, the atoms handed out
+	 * so far run from 0 up to one less than this.
+	 * @return The number of names in the table.
+	 */
+	unsigned int GetNumAtoms(void);
+
+private:
+
+	/**
+	 * Hash a name using FNV-1a.
+	 * @param Name The name to hash.
+	 * @return The hash value for the name.
+	 */
+	unsigned int HashName(const string &Name);
+
+	/**
+	 * Find the bucket a name lives in, or the empty one it would be
+	 * inserted into if it's not in the table.
+	 * @param Name The name to look for.
+	 * @param Hash The hash value of Name.
+	 * @return Index into m_Buckets.
+	 */
+	size_t FindBucket(const string &Name, unsigned int Hash);
+
+	/** Double the number of buckets and rehash every name into them. */
+	void GrowBuckets(void);
+
+	/** Each interned name, indexed by it's atom. */
+	vector<string> m_Names;
+
+	/** The hash value of each name in m_Names. */
+	vector<unsigned int> m_Hashes;
+
+	/** 
+	 * Open addressed hash table of atoms, always a power of two in size
+	 * with empty buckets set to NULL_ATOM. 
+	 */
+	vector<Atom> m_Buckets;
+};
+
+#endif
@@ -0,0 +1,114 @@
+//------------------------------------------------------------------------------------------
+// File: CMemoryArena.h
+// Desc: Bump pointer allocator for objects which all die at the same time.
+// Auth: Lee Millward
+//------------------------------------------------------------------------------------------
+
+#ifndef __CMEMORYARENA_H__
+#define __CMEMORYARENA_H__
+
+/**
+ * Hands out memory for objects which are created one at a time but are all
+ * finished with at the same point, such as the nodes of a parse tree. Memory
+ * is carved off the end of large blocks by bumping a pointer so creating an
+ * object never needs a call into the heap, and rather than freeing each
+ * object individually the whole arena is released in one go.
+ * <br><br>
+ * The objects still have their destructors run when the arena is released
+ * as most of them own strings and containers of their own. Each allocation
+ * is prefixed with a small header linking it into a list along with it's
+ * destructor, releasing the arena walks that list and then hands the blocks
+ * back. No tree walk is needed and nothing is freed one node at a time.
+ */
+class CMemoryArena
+{
+public:
+	/**
+	 * Create an empty arena, no memory is allocated until the first object is.
+	 * @param BlockSize Size in bytes of each block objects are carved from.
+	 */
+	CMemoryArena(size_t BlockSize = 64 * 1024);
+	~CMemoryArena(void);
+
+	/**
+	 * Default construct a new object of type T inside the arena. It lives
+	 * until the arena is released, it musn't be deleted.
+	 * @return The new object.
+	 */
+	template<typename T>
+	T* Construct(void)
+	{
+		void *Mem = Allocate(sizeof(T), &DestroyObject<T>);
+		return new(Mem) T();
+	}
+
+	/**
+	 * Carve space for a new object out of the current block, starting a
+	 * new one if there's not enough room left. This is for objects which 
+	 * can't be built by Construct, such as those with private constructors,
+	 * it's up to the caller to construct the object in the memory returned.
+	 * @param Size Size of the object in bytes.
+	 * @param Destructor Function to run the object's destructor on release.
+	 * @return Suitably aligned memory for the object.
+	 */
+	void* Allocate(size_t Size, void (*Destructor)(void*));
+
+	/**
+	 * Run the destructor of every object created in the arena, newest first,
+	 * and give back the memory they used. The arena can be used again
+	 * afterwards.
+	 */
+	void Release(void);
+
+	/**
+	 * Find out how many objects have been created since the arena was last
+	 * released.
+	 * @return The number of live objects in the arena.
+	 */
+	unsigned int GetNumObjects(void);
+
+private:
+
+	/** Header placed in front of every object in the arena. */
+	struct ArenaObject_t
+	{
+		/** The object created before this one. */
+		ArenaObject_t *Prev;
+
+		/** Runs the destructor of the object following the header. */
+		void (*Destructor)(void*);
+	};
+
+	/**
+	 * Run the destructor for an object of type T.
+	 * @param Obj The object being destroyed.
+	 */
+	template<typename T>
+	static void DestroyObject(void *Obj)
+	{
+		((T*)Obj)->~T();
+	}
+
+	/** Round a size up so whatever follows it is suitably aligned. */
+	static size_t AlignSize(size_t Size);
+
+	/** Every block allocated, the last one is the block being carved up. */
+	vector<char*> m_Blocks;
+
+	/** Next free byte in the current block. */
+	char *m_Next;
+
+	/** One past the last byte of the current block. */
+	char *m_End;
+
+	/** Size of each block, bigger objects get a block to themselves. */
+	size_t m_BlockSize;
+
+	/** The most recently created object, NULL if there's none. */
+	ArenaObject_t *m_LastObject;
+
+	/** Number of objects created since the last release. */
+	unsigned int m_NumObjects;
+};
+
+#endif
@@ -74,6 +74,13 @@ public:
 	 */
 	static string GenCompilerTempName(void);
 
+	/**
+	 * Find out if a variable is a compiler generated temporary.
+	 * @param Name The variable's name.
+	 * @return True if the name was created by GenCompilerTempName.
+	 */
+	static bool IsCompilerTempName(const string &Name);
+
 	/**
 	 * Create a new name for a label.
 	 * @return The name of the new label of the form "LXX" where XX 
@@ -81,6 +88,12 @@ public:
 	 */
 	static string GenNewLabel(void);
 
+	/**
+	 * Restart the numbering of compiler temporaries and labels, so a file
+	 * compiled again by the same process gets the same names.
+	 */
+	static void ResetGeneratedNames(void);
+
 	/**
 	 * Convert a hard-register to it's equilavent name such as "eax" etc.
 	 * @param Reg The enumeration we'd like to get the name for.
@@ -102,6 +115,10 @@ public:
 	 * @return A _decl tree node for Node.
 	 */
 	static CTreeNode *GetDeclFromNode(CTreeNode *Node);
+
+private:
+	static int ms_TempNum;
+	static int ms_LabelNum;
 };
 
 /**
@@ -117,6 +134,7 @@ struct CompBasicBlocks
 /**
  * During data flow analysis we want to compare two CIdentifierTreeNode's
  * for equality to determine if we've already added a node to a given set.
+ * Identifiers are ordered by their atoms rather than their names.
  */
 struct CompIdentifiers
 {
@@ -0,0 +1,81 @@
+//------------------------------------------------------------------------------------------
+// File: CXmlWriter.h
+// Desc: Writes an XML document straight out to a file one element at a time.
+// Auth: Lee Millward
+//------------------------------------------------------------------------------------------
+
+#ifndef __CXMLWRITER_H__
+#define __CXMLWRITER_H__
+
+/**
+ * Writes XML to a file as it's produced rather than building the whole
+ * document in memory first. Elements are opened and closed in the order
+ * they appear in the file and are written out straight away, the only thing
+ * kept is the name of each element which is still open so the memory used
+ * depends on how deeply the elements are nested, not on how many there are.
+ * <br><br>
+ * The layout matches what TinyXML saves, each element goes on it's own line
+ * indented by four spaces per level, elements holding only text are written
+ * on one line and empty elements are closed with "/>".
+ */
+class CXmlWriter
+{
+public:
+	CXmlWriter(void) : m_StartTagOpen(false) {};
+
+	/**
+	 * Create the file the document is written to.
+	 * @param FileName Name of the file, any existing file is replaced.
+	 * @return True if the file was created.
+	 */
+	bool Open(const string &FileName);
+
+	/** Finish the document and close the file, every element must be closed. */
+	void Close(void);
+
+	/**
+	 * Start a new element inside the current one, anything written until
+	 * the matching call to CloseElement goes inside it.
+	 * @param Name Name of the element.
+	 */
+	void OpenElement(const string &Name);
+
+	/** Close the element opened by the last call to OpenElement. */
+	void CloseElement(void);
+
+	/**
+	 * Write an element holding only some text inside the current one.
+	 * @param Name Name of the element.
+	 * @param Text The text, any characters with a special meaning in XML
+	 *        are escaped.
+	 */
+	void WriteElement(const string &Name, const string &Text);
+
+private:
+
+	/** Start a new line for an element, indented to the current depth. */
+	void BeginLine(void);
+
+	/** Finish the start tag of the current element if it's still open. */
+	void FinishStartTag(void);
+
+	/**
+	 * Write some text, escaping the characters XML treats specially.
+	 * @param Text The text to write.
+	 */
+	void WriteEscaped(const string &Text);
+
+	/** The file being written. */
+	ofstream m_File;
+
+	/** Names of the elements which are open, innermost last. */
+	vector<string> m_OpenElements;
+
+	/**
+	 * True if nothing's been written inside the innermost element yet, it's
+	 * start tag is left open so it can be closed with "/>" if it's empty.
+	 */
+	bool m_StartTagOpen;
+};
+
+#endif
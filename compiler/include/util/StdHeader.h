@@ -10,6 +10,8 @@
 #include <fstream>
 #include <map>
 #include <list>
+#include <vector>
+#include <deque>
 #include <stack>
 #include <iostream>
 #include <algorithm>
@@ -36,6 +38,7 @@ using namespace std;
 #include "CInternalErrorException.h"
 
 //stable headers which aren't likely to change very often (if at all)
+#include "CAtomTable.h"
 #include "CUtilFuncs.h"
 #include "CTreeNodeFactory.h"
 #include "TreeChildIndicies.h"
\ No newline at end of file
@@ -31,28 +31,42 @@ void CCodeGenerator::AssembleMIRTree(const string &OutputFile, CTreeNode *MirTre
 	SanityCheck(m_OutputFile.is_open());
 
 	OutputDataSections();
-
-	m_OutputFile << "[section .text]" << endl << endl;
-	m_OutputFile << "global _main" << endl << endl;
-	CGlobalDataStore::GetSingletonPtr()->OutputExternDeclarations(m_OutputFile);
+	OutputTextSectionHeader();
 
 	//take each statement in turn and generate the assembly code for it
-	for(unsigned int i = 0; i < MirTree->GetNumChildren(); i++, m_CurrStmtNo++)
-	{
-		//filter out anything which isn't a function
-		if(MirTree->GetChild(i)->Code != TC_FUNCTIONDECL)
-			continue;
+	for(unsigned int i = 0; i < MirTree->GetNumChildren(); i++)
+		AssembleGlobalDecl(MirTree->GetChild(i));
+
+	m_OutputFile.close();
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CCodeGenerator::BeginAssembly(const string &OutputFile)
+{
+	m_AsmFileName = OutputFile;
+	m_TextFileName = OutputFile + ".text";
 
-		CFunctionDeclTreeNode *FnDecl;
-		FnDecl = (CFunctionDeclTreeNode*)MirTree->GetChild(i);
+	m_OutputFile.open(m_TextFileName.c_str());
+	SanityCheck(m_OutputFile.is_open());
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CCodeGenerator::AssembleGlobalDecl(CTreeNode *Decl)
+{
+	//filter out anything which isn't a function
+	if(Decl->Code == TC_FUNCTIONDECL)
+	{
+		CFunctionDeclTreeNode *FnDecl = (CFunctionDeclTreeNode*)Decl;
 
 		//output the name of the function followed by the prologue
 		m_OutputFile << endl << FnDecl->Name << ":" << endl;
 		OutputFunctionPrologue(FnDecl->StackFrameSize);
 
 		//go through the function body and generate the code for each stmt in it
-		for(unsigned int j = 1; j < FnDecl->GetNumChildren(); j++)
-			GenerateCodeForStatement(FnDecl->GetChild(j));
+		for(CTreeNode *Stmt = FnDecl->Body.Front(); Stmt; Stmt = Stmt->NextStmt)
+			GenerateCodeForStatement(Stmt);
 
 		//if the function returns void we won't have output the epilogue
 		//so do that now
@@ -60,7 +74,40 @@ void CCodeGenerator::AssembleMIRTree(const string &OutputFile, CTreeNode *MirTre
 			OutputFunctionEpilogue();
 	}
 
+	m_CurrStmtNo++;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CCodeGenerator::FinishAssembly(void)
+{
 	m_OutputFile.close();
+
+	ifstream TextFile(m_TextFileName.c_str());
+	SanityCheck(TextFile.is_open());
+
+	m_OutputFile.open(m_AsmFileName.c_str());
+	SanityCheck(m_OutputFile.is_open());
+
+	OutputDataSections();
+	OutputTextSectionHeader();
+
+	//the code for the functions goes after the header, copy it 
+	//across as it is
+	if(TextFile.peek() != EOF)
+		m_OutputFile << TextFile.rdbuf();
+
+	m_OutputFile.close();
+	TextFile.close();
+	remove(m_TextFileName.c_str());
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CCodeGenerator::AbandonAssembly(void)
+{
+	m_OutputFile.close();
+	remove(m_TextFileName.c_str());
 }
 //-------------------------------------------------------------
 
@@ -76,148 +123,151 @@ void CCodeGenerator::OutputDataSections(void)
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
-void CCodeGenerator::GenerateCodeForStatement(CTreeNode *Stmt)
+void CCodeGenerator::OutputTextSectionHeader(void)
 {
-	switch(Stmt->Code)
-	{
-	case TC_ARRAYDECL:
-	case TC_VARDECL:
-		{
-			//var/array decls are ignored
-			break;
-		}
+	m_OutputFile << "[section .text]" << endl << endl;
+	m_OutputFile << "global _main" << endl << endl;
+	CGlobalDataStore::GetSingletonPtr()->OutputExternDeclarations(m_OutputFile);
+}
+//-------------------------------------------------------------
 
-	case TC_ASSIGN_EXPR:
-		{
-			GenerateCodeForAssignExpr(Stmt);
-			break;
-		}
+//-------------------------------------------------------------
+void CCodeGenerator::GenerateCodeForStatement(CTreeNode *Stmt)
+{
+	Visit(Stmt);
+	++m_CurrStmtNo;
+}
+//-------------------------------------------------------------
 
-	case TC_ARITH_EXPR:
-		{
-			GenerateCodeForArithExpr(Stmt);
-			break;
-		}
+//-------------------------------------------------------------
+void CCodeGenerator::VisitAssignExpr(CAssignExprTreeNode *AssignExpr)
+{
+	GenerateCodeForAssignExpr(AssignExpr);
+}
+//-------------------------------------------------------------
 
-	case TC_IFSTMT:
-		{
-			GenerateCodeForIfStmt(Stmt);
-			break;
-		}
+//-------------------------------------------------------------
+void CCodeGenerator::VisitArithExpr(CArithExprTreeNode *Expr)
+{
+	GenerateCodeForArithExpr(Expr);
+}
+//-------------------------------------------------------------
 
-	case TC_LABEL:
-		{
-			m_OutputFile << ((CLabelTreeNode*)Stmt)->Name << ":" << endl;
-			break;
-		}
+//-------------------------------------------------------------
+void CCodeGenerator::VisitIfStmt(CIfStmtTreeNode *Stmt)
+{
+	GenerateCodeForIfStmt(Stmt);
+}
+//-------------------------------------------------------------
 
-	case TC_GOTOEXPR:
-		{
-			//a goto on it's own is an unconditional jump
-			m_OutputFile << "\tjmp\t" << ((CGotoExprTreeNode*)Stmt)->Target << endl;
-			break;
-		}
+//-------------------------------------------------------------
+void CCodeGenerator::VisitLabel(CLabelTreeNode *Label)
+{
+	m_OutputFile << Label->Name << ":" << endl;
+}
+//-------------------------------------------------------------
 
-	case TC_CALLEXPR:
-		{
-			GenerateCodeForCallExpr(Stmt);
-			break;
-		}
+//-------------------------------------------------------------
+void CCodeGenerator::VisitGotoExpr(CGotoExprTreeNode *Goto)
+{
+	//a goto on it's own is an unconditional jump
+	m_OutputFile << "\tjmp\t" << Goto->Target << endl;
+}
+//-------------------------------------------------------------
 
-	case TC_UNARY_EXPR:
-		{
-			GenerateCodeForNegExpr(Stmt);
-			break;
-		}
+//-------------------------------------------------------------
+void CCodeGenerator::VisitCallExpr(CCallExprTreeNode *Expr)
+{
+	GenerateCodeForCallExpr(Expr);
+}
+//-------------------------------------------------------------
 
-	case TC_RETURNSTMT:
-		{
-			GenerateCodeForReturnStmt(Stmt);
-			break;
-		}
+//-------------------------------------------------------------
+void CCodeGenerator::VisitUnaryExpr(CUnaryExprTreeNode *Expr)
+{
+	GenerateCodeForNegExpr(Expr);
+}
+//-------------------------------------------------------------
 
-	default:
-		{
-			InternalError("unhandled stmt type");
-			break;
-		}
-	}
+//-------------------------------------------------------------
+void CCodeGenerator::VisitReturnStmt(CReturnStmtTreeNode *Stmt)
+{
+	GenerateCodeForReturnStmt(Stmt);
+}
+//-------------------------------------------------------------
 
-	++m_CurrStmtNo;
+//-------------------------------------------------------------
+void CCodeGenerator::VisitNode(CTreeNode *Node)
+{
+	InternalError("unhandled stmt type");
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
 void CCodeGenerator::ProcessExprOperand(CTreeNode *ExprOp, InsnOp_t &Op)
 {
-	switch(ExprOp->Code)
-	{
-	case TC_VARDECL:
-		{
-			ProcessVarDeclExprOperand(ExprOp, Op);
-			return;
-		}
-
-	case TC_ARRAY_REF:
-		{
-			//get the underlying var_decl
-			CArrayRefTreeNode *Ref = (CArrayRefTreeNode*)ExprOp;
-			CArrayDeclTreeNode *ArrDecl = (CArrayDeclTreeNode*)CUtilFuncs::GetDeclFromNode(
-																			Ref->ArrName);
-			CVarDeclTreeNode *ArrVar = (CVarDeclTreeNode*)ArrDecl->GetChild(ARR_DECL_VAR);
-			CTreeNode *Index = Ref->GetChild(ARR_REF_INDEX);
+	COperandFinder(*this, Op).Visit(ExprOp);
+}
+//-------------------------------------------------------------
 
-			//get the base address of the array in the stack frame
-			int BaseAddr = ArrVar->StackFrameAddr;
+//-------------------------------------------------------------
+void COperandFinder::VisitVarDecl(CVarDeclTreeNode *VarDecl)
+{
+	m_Gen.ProcessVarDeclExprOperand(VarDecl, m_Op);
+}
+//-------------------------------------------------------------
 
-			if(Index->Code == TC_LITERAL)
-			{
-				//calculate the offset address in the array for the
-				//element being accessed
-				int ElementOffset = CUtilFuncs::GetLiteralValue<int>(
-						(CLiteralTreeNode*)Index) * 4;
+//-------------------------------------------------------------
+void COperandFinder::VisitArrayRef(CArrayRefTreeNode *Ref)
+{
+	//only an element with a literal index has a fixed location, any other
+	//has it's address calculated by CalcArrayElementAddress
+	m_Gen.GetArrayElementLocation(Ref, m_Op);
+	m_Op.InMemory = true;
+}
+//-------------------------------------------------------------
 
-				Op.Loc = CalcStackFrameAddress(false, ElementOffset + BaseAddr);
-			}
-			
-			Op.InMemory = true;
-			return;
-		}
+//-------------------------------------------------------------
+void COperandFinder::VisitLiteral(CLiteralTreeNode *Lit)
+{
+	m_Op.InMemory = false;
+	m_Op.Loc = Lit->LitValue;
+}
+//-------------------------------------------------------------
 
-	case TC_LITERAL:
-		{
-			Op.InMemory = false;
-			Op.Loc = ((CLiteralTreeNode*)ExprOp)->LitValue;
-			return;
-		}
+//-------------------------------------------------------------
+void COperandFinder::VisitIdentifier(CIdentifierTreeNode *Id)
+{
+	Visit(CUtilFuncs::GetDeclFromNode(Id));
+}
+//-------------------------------------------------------------
 
-	case TC_IDENTIFIER:
-		{
-			ProcessExprOperand(CUtilFuncs::GetDeclFromNode(ExprOp), Op);
-			return;
-		}
+//-------------------------------------------------------------
+void COperandFinder::VisitParameterDecl(CParameterDeclTreeNode *ParmDecl)
+{
+	m_Op.InMemory = true;
+	m_Op.Loc = m_Gen.CalcStackFrameAddress(true, ParmDecl->Position);
+}
+//-------------------------------------------------------------
 
-	case TC_PARMDECL:
-		{
-			Op.InMemory = true;
-			Op.Loc = CalcStackFrameAddress(true, ((CParameterDeclTreeNode*)ExprOp)->Position);
-			return;
-		}	
+//-------------------------------------------------------------
+void COperandFinder::VisitUnaryExpr(CUnaryExprTreeNode *Expr)
+{
+	SanityCheck(Expr->GetChild(UNARY_EXPR_EXPR)->Code != TC_IDENTIFIER);
+	Visit(Expr->GetChild(UNARY_EXPR_EXPR));
+}
+//-------------------------------------------------------------
 
-	case TC_UNARY_EXPR:
-		{
-			SanityCheck(ExprOp->GetChild(UNARY_EXPR_EXPR)->Code != TC_IDENTIFIER);
-			ProcessExprOperand(ExprOp->GetChild(UNARY_EXPR_EXPR), Op);
-			return;
-		}
+//-------------------------------------------------------------
+void COperandFinder::VisitLiteralRef(CLiteralRefTreeNode *Ref)
+{
+	m_Gen.GetDeclLocation(Ref, m_Op);
+}
+//-------------------------------------------------------------
 
-	case TC_LITERALREF:
-		{
-			GetDeclLocation(ExprOp, Op);
-			return;
-		}
-	}
-	
+//-------------------------------------------------------------
+void COperandFinder::VisitNode(CTreeNode *Node)
+{
 	InternalError("unknown LHS type");
 }
 //-------------------------------------------------------------
@@ -984,9 +1034,6 @@ void CCodeGenerator::GenerateCodeForArrayAssignExpr(CTreeNode *Lhs, CTreeNode *R
 {
 	if(Lhs->Code == TC_ARRAY_REF)
 	{
-		//store the address of the array element to the top of the stack
-		CalcArrayElementAddress(Lhs, true);
-
 		//check to see if we have something like arr[foo] = arr[bar]
 		if(Rhs->Code == TC_ARRAY_REF)
 		{
@@ -1016,7 +1063,8 @@ void CCodeGenerator::CalcArrayElementAddress(CTreeNode *ArrRef, bool SaveEax)
 
 	//get the array declaration being references
 	CArrayRefTreeNode *Ref = (CArrayRefTreeNode*)ArrRef;
-	Symbol_t *Sym = CSymbolTable::GetSingletonPtr()->LookupIdentifier(Ref->ArrName->IdName, false);
+	Symbol_t *Sym = Ref->ArrName->Binding;
+	SanityCheck(Sym);
 	CArrayDeclTreeNode *ArrDecl = (CArrayDeclTreeNode*)Sym->IdPtr;
 	
 	//we need access to the underlying var_decl for details about whether it's
@@ -1069,6 +1117,46 @@ void CCodeGenerator::CalcArrayElementAddress(CTreeNode *ArrRef, bool SaveEax)
 }
 //-------------------------------------------------------------
 
+//-------------------------------------------------------------
+bool CCodeGenerator::GetArrayElementLocation(CTreeNode *ArrRef, InsnOp_t &Op)
+{
+	CTreeNode *Index = ArrRef->GetChild(ARR_REF_INDEX);
+
+	if(Index->Code != TC_LITERAL)
+		return false;
+
+	//get the array declaration being referenced
+	CArrayRefTreeNode *Ref = (CArrayRefTreeNode*)ArrRef;
+	CArrayDeclTreeNode *ArrDecl = (CArrayDeclTreeNode*)CUtilFuncs::GetDeclFromNode(
+																	Ref->ArrName);
+	CVarDeclTreeNode *Var = (CVarDeclTreeNode*)ArrDecl->GetChild(ARR_DECL_VAR);
+
+	//an index outside of the array is left to the run time calculation
+	//rather than giving an address outside of the array's storage
+	int Element = CUtilFuncs::GetLiteralValue<int>(Index);
+	int Bounds = CUtilFuncs::GetLiteralValue<int>(ArrDecl->GetChild(ARR_DECL_BOUNDS));
+
+	if(Element < 0 || Element >= Bounds)
+		return false;
+
+	Op.InMemory = true;
+
+	//the elements of an array in the stack frame are at decreasing addresses
+	//from the first one, a global array's are at increasing addresses from
+	//it's label
+	if(!Var->GlobalVar)
+		Op.Loc = CalcStackFrameAddress(false, Var->StackFrameAddr + Element * 4);
+	else
+	{
+		stringstream ss;
+		ss << "dword [" << Var->VarId->IdName << " + " << Element * 4 << "]";
+		Op.Loc = ss.str();
+	}
+
+	return true;
+}
+//-------------------------------------------------------------
+
 //-------------------------------------------------------------
 void CCodeGenerator::ProcessArrToArrAssignment(CTreeNode *Lhs, CTreeNode *Rhs)
 {
@@ -1084,6 +1172,51 @@ void CCodeGenerator::ProcessArrToArrAssignment(CTreeNode *Lhs, CTreeNode *Rhs)
 		return;
 	}
 
+	//elements with literal indices can be copied between directly, using the
+	//stack since both are in memory
+	InsnOp_t LhsElemOp;
+	InsnOp_t RhsElemOp;
+	bool LhsDirect = GetArrayElementLocation(Lhs, LhsElemOp);
+	bool RhsDirect = GetArrayElementLocation(Rhs, RhsElemOp);
+
+	if(LhsDirect && RhsDirect)
+	{
+		m_OutputFile << "\tpush\t" << RhsElemOp.Loc << endl;
+		m_OutputFile << "\tpop\t" << LhsElemOp.Loc << endl;
+		return;
+	}
+
+	if(LhsDirect || RhsDirect)
+	{
+		//work out the address of the other element, leaving it and the saved
+		//eax on the stack
+		CalcArrayElementAddress(LhsDirect ? Rhs : Lhs, true);
+
+		//load the address into ecx to copy through
+		m_OutputFile << "\tpush\tecx" << endl;
+		m_OutputFile << "\tmov\tecx,[esp + 4]" << endl;
+
+		if(LhsDirect)
+		{
+			m_OutputFile << "\tpush\tdword [ecx]" << endl;
+			m_OutputFile << "\tpop\t" << LhsElemOp.Loc << endl;
+		}
+		else
+		{
+			m_OutputFile << "\tpush\t" << RhsElemOp.Loc << endl;
+			m_OutputFile << "\tpop\tdword [ecx]" << endl;
+		}
+
+		//restore ecx then remove the address and restore eax
+		m_OutputFile << "\tpop\tecx" << endl;
+		m_OutputFile << "\tadd\tesp, 4" << endl;
+		m_OutputFile << "\tpop\teax" << endl;
+		return;
+	}
+
+	//store the address of the LHS element to the top of the stack
+	CalcArrayElementAddress(Lhs, true);
+
 	/*
 	 After the call to CalcArrayElementAddress below, the stack will
 	 look like this:
@@ -1135,7 +1268,26 @@ void CCodeGenerator::ProcessLhsArrAssignment(CTreeNode *Lhs, CTreeNode *Rhs)
 
 	InsnOp_t RhsOp;
 	ProcessExprOperand(Rhs, RhsOp);
-			
+
+	//store straight to an element with a literal index
+	InsnOp_t ElemOp;
+
+	if(GetArrayElementLocation(Lhs, ElemOp))
+	{
+		if(RhsOp.InMemory)
+		{
+			m_OutputFile << "\tpush\t" << RhsOp.Loc << endl;
+			m_OutputFile << "\tpop\t" << ElemOp.Loc << endl;
+		}
+		else
+			m_OutputFile << "\tmov\t" << ElemOp.Loc << "," << RhsOp.Loc << endl;
+
+		return;
+	}
+
+	//store the address of the array element to the top of the stack
+	CalcArrayElementAddress(Lhs, true);
+
 	//move the address of the array element we're assigning to 
 	//into a temporary scratch reg
 	string ScratchReg = GetScratchReg(CUtilFuncs::GetDeclFromNode(Rhs));
@@ -1184,6 +1336,22 @@ void CCodeGenerator::ProcessRhsArrAssignment(CTreeNode *Lhs, CTreeNode *Rhs)
 	InsnOp_t LhsOp;
 	ProcessExprOperand(Lhs, LhsOp);
 
+	//load straight from an element with a literal index
+	InsnOp_t ElemOp;
+
+	if(GetArrayElementLocation(Rhs, ElemOp))
+	{
+		if(LhsOp.InMemory)
+		{
+			m_OutputFile << "\tpush\t" << ElemOp.Loc << endl;
+			m_OutputFile << "\tpop\t" << LhsOp.Loc << endl;
+		}
+		else
+			m_OutputFile << "\tmov\t" << LhsOp.Loc << "," << ElemOp.Loc << endl;
+
+		return;
+	}
+
 	//stack offset to load array element address from
 	string StackOffset = "+4";
 
@@ -1292,6 +1460,15 @@ void CCodeGenerator::LoadValToFpu(CTreeNode *Val)
 	}
 	else
 	{
+		//an element with a literal index can be loaded directly
+		InsnOp_t ElemOp;
+
+		if(GetArrayElementLocation(Val, ElemOp))
+		{
+			m_OutputFile << "\tfld\t" << ElemOp.Loc << endl;
+			return;
+		}
+
 		//calculate the array element to use, after this call we will 
 		//have 8 bytes on top of the stack (saved EAX and address) that
 		//will need to be removed before we exit this function
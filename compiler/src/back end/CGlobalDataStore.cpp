@@ -47,8 +47,14 @@ void CGlobalDataStore::AddGlobalVar(CTreeNode *VarDecl)
 
 	//HACK: something is clobbering the var decl pointers between adding
 	//the decl to the list and actually outputting them so we create a copy
-	//to get around this for now.
+	//to get around this for now. The copy has to outlive the parse tree so
+	//it can't go in the same arena
+	CTreeNodeFactory *TreeNodeFactory = CTreeNodeFactory::GetSingletonPtr();
+	NodeArena PrevArena = TreeNodeFactory->GetNodeArena();
+
+	TreeNodeFactory->UseNodeArena(NA_HEAP);
 	m_VarDecls.push_back(VarDecl->CreateCopy());
+	TreeNodeFactory->UseNodeArena(PrevArena);
 }
 //-------------------------------------------------------------
 
@@ -24,7 +24,7 @@ void CLinearScanAllocator::CalculateLiveIntervals(list<BasicBlock_t*> &FuncCFG)
 	for(BbItr = FuncCFG.begin(); BbItr != FuncCFG.end(); BbItr++)
 	{
 		AddNewLiveIntervals(*BbItr, StmtNo);
-		StmtNo += (int)(*BbItr)->Stmts.size();
+		StmtNo += (int)(*BbItr)->NumStmts;
 		CalculateEndPoints(*BbItr, StmtNo);
 	}
 }
@@ -48,8 +48,7 @@ void CLinearScanAllocator::AddNewLiveIntervals(BasicBlock_t *Bb, int StartStmtNo
 				LiveInterval_t NewLiveInterval;
 
 				//get the decl for this identifier so we can determine it's start point
-				Symbol_t *Sym = CSymbolTable::GetSingletonPtr()->LookupIdentifier(
-													(*ValItr)->IdName, false);
+				Symbol_t *Sym = (*ValItr)->Binding;
 				SanityCheck(Sym);
 
 				if(Sym->IdPtr->Code == TC_VARDECL)
@@ -59,14 +58,15 @@ void CLinearScanAllocator::AddNewLiveIntervals(BasicBlock_t *Bb, int StartStmtNo
 				}
 				else if(Sym->IdPtr->Code == TC_PARMDECL)
 				{
-					//we dont assign registers to parameters
-					return;
+					//we dont assign registers to parameters, but the values
+					//after it in the set still need an interval
+					continue;
 				}
 
 				//initialise the end point as the end of this basic block, this
 				//will be updated later on if needs be but it serves as a useful
 				//initial end point
-				NewLiveInterval.EndPoint = StartStmtNo + (int)Bb->Stmts.size();
+				NewLiveInterval.EndPoint = StartStmtNo + (int)Bb->NumStmts;
 				NewLiveInterval.Id = *ValItr;
 				NewLiveInterval.Active = true;
 
@@ -76,8 +76,8 @@ void CLinearScanAllocator::AddNewLiveIntervals(BasicBlock_t *Bb, int StartStmtNo
 			else
 			{
 				//see if it's end point needs to be updated
-				if(LiveInt->EndPoint < StartStmtNo + (int)Bb->Stmts.size())
-					LiveInt->EndPoint = StartStmtNo + (int)Bb->Stmts.size();
+				if(LiveInt->EndPoint < StartStmtNo + (int)Bb->NumStmts)
+					LiveInt->EndPoint = StartStmtNo + (int)Bb->NumStmts;
 			}
 		}
 	}
@@ -90,7 +90,7 @@ LiveInterval_t* CLinearScanAllocator::FindLiveInterval(CIdentifierTreeNode *Id)
 	list<LiveInterval_t>::iterator LiItr;
 	for(LiItr = m_LiveIntervals.begin(); LiItr != m_LiveIntervals.end(); LiItr++)
 	{
-		if((*LiItr).Id->IdName == Id->IdName)
+		if((*LiItr).Id->Binding == Id->Binding)
 			return &(*LiItr);
 	}
 
@@ -284,11 +284,18 @@ void CLinearScanAllocator::PurgeDeadIntervals(LiveInterval_t *Interval)
 		if(!(*Itr).Active)
 			continue;
 
+		//globals, floating point values and arrays are never given a
+		//register so there's nothing for them to hold on to or free
+		if((*Itr).Reg == REG_NONE)
+			continue;
+
 		if((*Itr).EndPoint >= Interval->StartPoint)
 			return;
 
-		//free the allocated register
+		//free the allocated register, the interval is dead from now on
+		//so it mustn't be freed again by a later purge
 		m_FreeRegs.push_back((*Itr).Reg);
+		(*Itr).Active = false;
 	}
 }
 //-------------------------------------------------------------
@@ -326,6 +333,10 @@ void CLinearScanAllocator::SpillInterval(LiveInterval_t *Interval)
 	SpilledVar->SpillPoint = Interval->StartPoint;
 	SpilledVar->StackFrameAddr = m_NextStackFrameAddr;
 
+	//the register it was given is still held by the value it came from,
+	//so the interval mustn't hand it back when it's purged
+	Interval->Reg = REG_NONE;
+
 	//update the stack addr for the next spilled var
 	m_NextStackFrameAddr += 4;
 }
@@ -334,10 +345,9 @@ void CLinearScanAllocator::SpillInterval(LiveInterval_t *Interval)
 //-------------------------------------------------------------
 CTreeNode* CLinearScanAllocator::GetDeclForInterval(LiveInterval_t *Interval)
 {
-	Symbol_t *VarSym = CSymbolTable::GetSingletonPtr()->LookupIdentifier(
-		Interval->Id->IdName, false);
+	Symbol_t *VarSym = Interval->Id->Binding;
 
-	//make sure the symbol was found
+	//make sure the identifier was bound
 	SanityCheck(VarSym);
 	return VarSym->IdPtr;
 }
@@ -350,12 +360,11 @@ void CLinearScanAllocator::DumpFinalRegisterAllocations(void)
 	DumpFile.open("RegisterAllocations.txt", ios::app);
 
 	list<LiveInterval_t>::iterator Itr = m_LiveIntervals.begin();
-	CSymbolTable *SymTable = CSymbolTable::GetSingletonPtr();
 	CVarDeclTreeNode *VarDecl = NULL;
 
 	for(; Itr != m_LiveIntervals.end(); Itr++)
 	{
-		Symbol_t *VarSym = SymTable->LookupIdentifier((*Itr).Id->IdName, false);
+		Symbol_t *VarSym = (*Itr).Id->Binding;
 		SanityCheck(VarSym);
 		
 		switch(VarSym->IdPtr->Code)
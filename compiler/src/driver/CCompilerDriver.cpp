@@ -10,29 +10,51 @@
 #include "CSymbolTable.h"
 #include "CParser.h"
 #include "CControlFlowGraph.h"
+#include "CCopyPropagator.h"
 #include "CFunctionDeclTreeNode.h"
+#include "CVarDeclTreeNode.h"
+#include "CArrayDeclTreeNode.h"
+#include "CIdentifierTreeNode.h"
 #include "CDataFlowAnalyser.h"
 #include "CLinearScanAllocator.h"
 #include "CCodeGenerator.h"
 #include "CGlobalDataStore.h"
 #include "CBuiltinFuncMngr.h"
+#include "CUtilFuncs.h"
+#include "CMirCache.h"
+#include "CXmlWriter.h"
 
 #include <windows.h>
 
 //-------------------------------------------------------------
 CCompilerDriver::CCompilerDriver(void)
 {
+	m_DumpTokens = false;
 	m_DumpParseTree = false;
 	m_DumpMirTree = false;
 	m_DumpCfg = false;
 	m_DumpDfInfo = false;
 	m_DumpLiveIntervals = false;
 	m_DumpFinalRegAllocs = false;
+	m_MapSourceFile = false;
+	m_ParallelLex = false;
+	m_TableScanner = false;
+	m_WatchInputFile = false;
+	m_UseMirCache = false;
+	m_StreamFunctions = false;
+	m_MirCache = NULL;
 
 	m_InputFile = "";
 }
 //-------------------------------------------------------------
 
+//-------------------------------------------------------------
+CCompilerDriver::~CCompilerDriver(void)
+{
+	delete m_MirCache;
+}
+//-------------------------------------------------------------
+
 //-------------------------------------------------------------
 void CCompilerDriver::CompileFile(int ArgCount, char *Arguments[])
 {
@@ -41,6 +63,7 @@ void CCompilerDriver::CompileFile(int ArgCount, char *Arguments[])
 	if(ArgCount < 2)
 	{
 		cout << "usage: <input-file>         [REQUIRED] input file to compile" << endl;
+		cout << "       --dump-tokens        [OPTIONAL] dump the tokens in the input file" << endl;
 		cout << "       --dump-parse-tree    [OPTIONAL] dump the parse tree" << endl;
 		cout << "       --dump-mir-tree      [OPTIONAL] dump the MIR tree" << endl;
 		cout << "       --dump-cfg           [OPTIONAL] dump the CFG for each function" << endl;
@@ -48,6 +71,12 @@ void CCompilerDriver::CompileFile(int ArgCount, char *Arguments[])
 		cout << "       --dump-live-int      [OPTIONAL] dump live intervals from RA" << endl;
 		cout << "       --dump-reg-allocs    [OPTIONAL] dump final register allocations" << endl;
 		cout << "       --save-assembly      [OPTIONAL] save the generated assembly code" << endl;
+		cout << "       --map-source         [OPTIONAL] map the input file into memory" << endl;
+		cout << "       --parallel-lex       [OPTIONAL] scan the input file on multiple threads" << endl;
+		cout << "       --table-scanner      [OPTIONAL] use the table driven scanner" << endl;
+		cout << "       --watch              [OPTIONAL] recompile whenever the input file changes" << endl;
+		cout << "       --mir-cache          [OPTIONAL] reuse the MIR from an unchanged input file" << endl;
+		cout << "       --stream-functions   [OPTIONAL] compile one function at a time to save memory" << endl;
 		return;
 	}
 
@@ -61,12 +90,55 @@ void CCompilerDriver::CompileFile(int ArgCount, char *Arguments[])
 		return;
 	}
 
+	//keep going until we're killed if we're watching the file
+	if(m_WatchInputFile)
+	{
+		WatchInputFile();
+		return;
+	}
+
 	try
 	{
+		if(m_DumpTokens)
+			DumpTokens();
+
 		ConstructSingletons();
 
-		//pass 1: semantic and syntactic analysis
+		//compile each declaration as soon as it's parsed instead of keeping
+		//the whole program in memory. The MIR cache needs the whole program
+		//so it isn't used
+		if(m_StreamFunctions)
+		{
+			if(StreamSourceFile())
+				RunAssemblerAndLinker();
+
+			DeleteSingletons();
+			return;
+		}
+
+		//if the same source has been through the same compiler before
+		//we can go straight to building the CFG. The parse tree can only
+		//be dumped by running the parser though
+		if(m_UseMirCache && !m_DumpParseTree)
+		{
+			m_MirCache = new CMirCache("MirCache");
+			CTreeNode *MirTree = m_MirCache->Lookup(m_InputFile);
+			m_MirCache->ReportStatistics();
+
+			if(MirTree)
+			{
+				DumpMirTree(MirTree);
+				CompileMirTree(MirTree);
+				RunAssemblerAndLinker();
+				DeleteSingletons();
+				return;
+			}
+		}
+
+		//pass 1: semantic and syntactic analysis, the parse tree is built 
+		//in it's own arena so it can be thrown away in one go afterwards
 		CBuiltinFuncMngr::GetSingletonPtr()->InitialiseBuiltins(false);
+		CTreeNodeFactory::GetSingletonPtr()->UseNodeArena(NA_PARSE_TREE);
 		CTreeNode *ParseTree = RunParser();
 
 		if(!ParseTree)
@@ -75,35 +147,8 @@ void CCompilerDriver::CompileFile(int ArgCount, char *Arguments[])
 			return;
 		}
 
-		//up to this point we've used the symbol for semantic checking 
-		//but now as we enter the middle/back-end it takes on a different
-		//purpose, we no longer care about scopes and instead use the
-		//information contained within it during the various passes. During 
-		//MIR lowering we rebuild the symbol table for variables only, unlike
-		//during parsing where we also store functions. FIXME: dont do this
-		CSymbolTable::GetSingletonPtr()->Reset();
-		CBuiltinFuncMngr::GetSingletonPtr()->DestroyBuiltins();
-		CBuiltinFuncMngr::GetSingletonPtr()->InitialiseBuiltins(true);
-
-		//pass 2: convert the parse tree to MIR form, after this stage
-		//we're done with the parse tree so destroy it
-		CTreeNode *MirTree = RewriteIntoMIRForm(ParseTree);
-		ParseTree->DestroyNode();
-		SanityCheck(MirTree);
-
-		//pass 3: build the CFG
-		ConstructControlFlowGraph(&MirTree);
-
-		//pass 4: perform data flow analysis for each function
-		RunDataFlowAnalyser(MirTree);
-
-		//pass 5: perform local register allocation for each function,
-		//any global variables will be stored in memory 
-		RunRegisterAllocator(MirTree);
-
-		//pass 6: code generation
-		RunCodeGenerator(MirTree);
-		MirTree->DestroyNode();
+		//passes 2 to 6
+		CompileParseTree(ParseTree, true);
 
 		//run the assembler and linker to generate the final executable
 		RunAssemblerAndLinker();
@@ -113,10 +158,7 @@ void CCompilerDriver::CompileFile(int ArgCount, char *Arguments[])
 	}
 	catch(CInternalErrorException &Err)
 	{
-		cout << "an internal compiler error has occurred, details: " << endl;
-		cout << "  function: " << Err.GetFunc() << endl;
-		cout << "  line: " << Err.GetLine() << endl;
-		cout << "  message: " << Err.GetMsg() << endl;
+		ReportInternalError(Err);
 		return;
 	}
 	catch(...)
@@ -128,6 +170,314 @@ void CCompilerDriver::CompileFile(int ArgCount, char *Arguments[])
 }
 //-------------------------------------------------------------
 
+//-------------------------------------------------------------
+void CCompilerDriver::WatchInputFile(void)
+{
+	ConstructSingletons();
+
+	//the parser hangs on to what it parsed the last time round
+	CParser Parser;
+	FILETIME LastWriteTime = {0, 0};
+
+	while(true)
+	{
+		//wait until the file's been written to since we last compiled it
+		WIN32_FILE_ATTRIBUTE_DATA FileInfo;
+
+		if(!GetFileAttributesEx(m_InputFile.c_str(), GetFileExInfoStandard, &FileInfo)
+		   || CompareFileTime(&FileInfo.ftLastWriteTime, &LastWriteTime) == 0)
+		{
+			Sleep(250);
+			continue;
+		}
+
+		LastWriteTime = FileInfo.ftLastWriteTime;
+		DeleteOldDumpFiles();
+
+		try
+		{
+			//the parser keeps it's trees between rounds so they can't go in an
+			//arena, the MIR one may still be in use if the last round failed
+			CTreeNodeFactory::GetSingletonPtr()->UseNodeArena(NA_HEAP);
+			CTreeNodeFactory::GetSingletonPtr()->ReleaseNodeArena(NA_MIR);
+
+			//start from a clean symbol table and global data each time
+			CSymbolTable::GetSingletonPtr()->Reset();
+			delete CGlobalDataStore::GetSingletonPtr();
+			CGlobalDataStore *TempGlobStore = new CGlobalDataStore();
+
+			CBuiltinFuncMngr::GetSingletonPtr()->DestroyBuiltins();
+			CBuiltinFuncMngr::GetSingletonPtr()->InitialiseBuiltins(false);
+			CUtilFuncs::ResetGeneratedNames();
+
+			//pass 1: only the declarations which have changed are parsed again, 
+			//the tree belongs to the parser so we musn't destroy it
+			CTreeNode *ParseTree = Parser.ReparseSourceFile(m_InputFile, m_TableScanner);
+
+			if(ParseTree)
+			{
+				DumpParseTree(ParseTree);
+				CompileParseTree(ParseTree, false);
+				RunAssemblerAndLinker();
+			}
+		}
+		catch(CInternalErrorException &Err)
+		{
+			ReportInternalError(Err);
+		}
+
+		cout << "watching " << m_InputFile << " for changes" << endl;
+	}
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CCompilerDriver::CompileParseTree(CTreeNode *ParseTree, bool DestroyParseTree)
+{
+	//every identifier was bound to it's symbol during parsing, so rather
+	//than rebuilding the symbol table MIR lowering just points each symbol
+	//at the declaration it's lowered into. The builtins are recreated
+	//with their MIR names and their symbols repointed the same way, they
+	//outlive the MIR so aren't placed in it's arena
+	CTreeNodeFactory *TreeNodeFactory = CTreeNodeFactory::GetSingletonPtr();
+	TreeNodeFactory->UseNodeArena(NA_HEAP);
+
+	CBuiltinFuncMngr::GetSingletonPtr()->DestroyBuiltins();
+	CBuiltinFuncMngr::GetSingletonPtr()->InitialiseBuiltins(true);
+
+	//pass 2: convert the parse tree to MIR form, after this stage
+	//we're done with the parse tree so destroy it. The MIR tree and
+	//everything hanging off it up to code generation goes in an arena
+	TreeNodeFactory->UseNodeArena(NA_MIR);
+	CTreeNode *MirTree = RewriteIntoMIRForm(ParseTree);
+
+	//symbols for names only seen in the parse tree may still point
+	//into it so the tree has to be saved before it's destroyed
+	if(m_MirCache)
+		m_MirCache->Store(MirTree);
+
+	if(DestroyParseTree)
+	{
+		ParseTree->DestroyNode();
+		TreeNodeFactory->ReleaseNodeArena(NA_PARSE_TREE);
+	}
+
+	//passes 3 to 6
+	CompileMirTree(MirTree);
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CCompilerDriver::CompileMirTree(CTreeNode *MirTree)
+{
+	//the CFG and everything built from it goes in the same arena
+	//as the tree, it's all released together at the end
+	CTreeNodeFactory *TreeNodeFactory = CTreeNodeFactory::GetSingletonPtr();
+	TreeNodeFactory->UseNodeArena(NA_MIR);
+	SanityCheck(MirTree);
+
+	//pass 3: build the CFG
+	ConstructControlFlowGraph(&MirTree);
+
+	//pass 4: perform data flow analysis for each function
+	RunDataFlowAnalyser(MirTree);
+
+	//pass 5: perform local register allocation for each function,
+	//any global variables will be stored in memory 
+	RunRegisterAllocator(MirTree);
+
+	//pass 6: code generation
+	RunCodeGenerator(MirTree);
+
+	TreeNodeFactory->ReleaseNodeArena(NA_MIR);
+	TreeNodeFactory->UseNodeArena(NA_HEAP);
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+bool CCompilerDriver::StreamSourceFile(void)
+{
+	CTreeNodeFactory *TreeNodeFactory = CTreeNodeFactory::GetSingletonPtr();
+	TreeNodeFactory->UseNodeArena(NA_HEAP);
+
+	//the builtins keep the names the parser knows them by since it still 
+	//needs them, nothing after the parser looks at the name of the 
+	//function a call is bound to
+	CBuiltinFuncMngr::GetSingletonPtr()->InitialiseBuiltins(false);
+
+	CParser Parser;
+
+	if(!Parser.BeginSourceFile(m_InputFile, m_MapSourceFile, m_ParallelLex, m_TableScanner))
+		return false;
+
+	//the dump files are written a declaration at a time too
+	CXmlWriter ParseTreeOut;
+	ofstream MirTreeOut;
+
+	if(m_DumpParseTree)
+	{
+		if(!ParseTreeOut.Open("ParseTree.xml"))
+			InternalError("unable to open parse tree dump file");
+
+		ParseTreeOut.OpenElement("parse_tree");
+	}
+
+	if(m_DumpMirTree)
+	{
+		MirTreeOut.open("MirTreeDump.txt");
+
+		if(!MirTreeOut.is_open())
+			InternalError("unable to open MIR dump tree file");
+	}
+
+	m_AsmFile = m_InputFile.substr(0, m_InputFile.find_last_of('.')) + ".asm";
+
+	CCodeGenerator CodeGen;
+	CodeGen.BeginAssembly(m_AsmFile);
+
+	//what the declarations still to come need to know about the ones
+	//which have been compiled, this is all that's kept of them
+	CTreeNode *Globals = TreeNodeFactory->BuildRootNode();
+	CTreeNode *Decl;
+
+	try
+	{
+		while(true)
+		{
+			TreeNodeFactory->UseNodeArena(NA_PARSE_TREE);
+
+			if(!Parser.ParseGlobalDecl(Decl))
+				break;
+
+			//after an error there's no point generating any more code but we
+			//carry on parsing to report any other errors. Anything parsed from
+			//then on is kept the same as when the whole file is parsed at once,
+			//an erroneous declaration may still be bound to a symbol
+			if(Parser.ErrorsOccurred())
+				continue;
+
+			if(Decl)
+			{
+				if(m_DumpParseTree)
+					Decl->DumpAsParseTreeNode(ParseTreeOut);
+
+				CompileGlobalDecl(Decl, Globals, CodeGen, MirTreeOut);
+			}
+
+			TreeNodeFactory->ReleaseNodeArena(NA_PARSE_TREE);
+		}
+	}
+	catch(...)
+	{
+		CodeGen.AbandonAssembly();
+		TreeNodeFactory->UseNodeArena(NA_HEAP);
+		Globals->DestroyNode();
+		throw;
+	}
+
+	if(m_DumpParseTree)
+	{
+		ParseTreeOut.CloseElement();
+		ParseTreeOut.Close();
+	}
+
+	MirTreeOut.close();
+	bool Success = !Parser.ErrorsOccurred();
+
+	if(Success)
+		CodeGen.FinishAssembly();
+	else
+	{
+		//nothing's dumped for a program with errors, the same as 
+		//when it's compiled all at once
+		CodeGen.AbandonAssembly();
+		DeleteOldDumpFiles();
+	}
+
+	TreeNodeFactory->ReleaseNodeArena(NA_PARSE_TREE);
+	TreeNodeFactory->UseNodeArena(NA_HEAP);
+	Globals->DestroyNode();
+
+	return Success;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CCompilerDriver::CompileGlobalDecl(CTreeNode *Decl, CTreeNode *Globals, 
+                                        CCodeGenerator &CodeGen, ofstream &MirTreeOut)
+{
+	CTreeNodeFactory *TreeNodeFactory = CTreeNodeFactory::GetSingletonPtr();
+	Symbol_t *Sym = NULL;
+
+	switch(Decl->Code)
+	{
+	case TC_FUNCTIONDECL:
+		Sym = ((CFunctionDeclTreeNode*)Decl)->Binding;
+		break;
+
+	case TC_VARDECL:
+		Sym = ((CVarDeclTreeNode*)Decl)->VarId->Binding;
+		break;
+
+	case TC_ARRAYDECL:
+		Sym = ((CVarDeclTreeNode*)Decl->GetChild(ARR_DECL_VAR))->VarId->Binding;
+		break;
+
+	default:
+		InternalError("unexpected global declaration");
+	}
+
+	SanityCheck(Sym);
+	TokenType SymType = Sym->SymType;
+
+	//copy the declaration as it was parsed to the heap for the parser
+	//to check any uses of it against, all it needs from a function is
+	//the signature. Globals stay bound to the copy when they're used in
+	//later functions, nothing after the parser treats a boolean any
+	//differently to the integer it's lowered into
+	TreeNodeFactory->UseNodeArena(NA_HEAP);
+	CTreeNode *Kept;
+
+	if(Decl->Code == TC_FUNCTIONDECL)
+	{
+		CFunctionDeclTreeNode *FnDecl = (CFunctionDeclTreeNode*)Decl;
+		CFunctionDeclTreeNode *Signature;
+
+		Signature = (CFunctionDeclTreeNode*)TreeNodeFactory->BuildFunctionDecl(FnDecl->Name, 
+			FnDecl->NumParameters, FnDecl->GetChild(FUNC_DECL_PARM_LIST)->CreateCopy(), 
+			FnDecl->RetType);
+
+		Signature->Binding = Sym;
+		Kept = Signature;
+	}
+	else
+		Kept = Decl->CreateCopy();
+
+	Globals->AddChild(Kept);
+
+	//lower it into a tree of it's own and run the rest of the passes over
+	//that, the tree and everything built from it is released afterwards
+	TreeNodeFactory->UseNodeArena(NA_MIR);
+	CTreeNode *MirTree = TreeNodeFactory->BuildRootNode();
+	MirTree->AddChild(Decl->RewriteIntoMIRForm(MirTree));
+	RunCopyPropagator(MirTree);
+
+	if(m_DumpMirTree)
+		MirTree->DumpAsMIRTreeNode(MirTreeOut);
+
+	ConstructControlFlowGraph(&MirTree);
+	RunDataFlowAnalyser(MirTree);
+	RunRegisterAllocator(MirTree);
+	CodeGen.AssembleGlobalDecl(MirTree->GetChild(0));
+
+	TreeNodeFactory->ReleaseNodeArena(NA_MIR);
+
+	//lowering pointed the symbol at the MIR, which has now gone
+	Sym->IdPtr = Kept;
+	Sym->SymType = SymType;
+}
+//-------------------------------------------------------------
+
 //-------------------------------------------------------------
 void CCompilerDriver::DecodeCommandLineArgs(int ArgCount, char *Arguments[])
 {
@@ -142,6 +492,12 @@ void CCompilerDriver::DecodeCommandLineArgs(int ArgCount, char *Arguments[])
 		}
 
 		//we've got one of the other options, decide which
+		if(!strcmp("--dump-tokens", Arguments[i]))
+		{
+			m_DumpTokens = true;
+			continue;
+		}
+
 		if(!strcmp("--dump-parse-tree", Arguments[i]))
 		{
 			m_DumpParseTree = true;
@@ -184,6 +540,44 @@ void CCompilerDriver::DecodeCommandLineArgs(int ArgCount, char *Arguments[])
 			continue;
 		}
 
+		if(!strcmp("--map-source", Arguments[i]))
+		{
+			m_MapSourceFile = true;
+			continue;
+		}
+
+		//the file has to be in memory to be split up between threads
+		if(!strcmp("--parallel-lex", Arguments[i]))
+		{
+			m_MapSourceFile = true;
+			m_ParallelLex = true;
+			continue;
+		}
+
+		if(!strcmp("--table-scanner", Arguments[i]))
+		{
+			m_TableScanner = true;
+			continue;
+		}
+
+		if(!strcmp("--watch", Arguments[i]))
+		{
+			m_WatchInputFile = true;
+			continue;
+		}
+
+		if(!strcmp("--mir-cache", Arguments[i]))
+		{
+			m_UseMirCache = true;
+			continue;
+		}
+
+		if(!strcmp("--stream-functions", Arguments[i]))
+		{
+			m_StreamFunctions = true;
+			continue;
+		}
+
 		cout << "error: unrecognised command line option '" << Arguments[i] << "'" << endl;
 		system("pause");
 		exit(1);
@@ -203,34 +597,63 @@ void CCompilerDriver::DeleteOldDumpFiles(void)
 }
 //-------------------------------------------------------------
 
+//-------------------------------------------------------------
+void CCompilerDriver::DumpTokens(void)
+{
+	CLexicalScanner Scanner;
+
+	if(!Scanner.SetInputFile(m_InputFile, m_MapSourceFile, m_ParallelLex, m_TableScanner))
+		return;
+
+	ofstream TokensOut("Tokens.txt");
+
+	if(!TokensOut.is_open())
+		InternalError("unable to open tokens dump file");
+
+	//one token per line so the dumps from two scanners can be diffed
+	while(Scanner.HasMoreTokens())
+	{
+		Token_t Tok = Scanner.GetNextToken();
+		TokensOut << Tok.LineNumber << " " << Tok.Type << " " << Tok.TokenValue << "\n";
+	}
+
+	TokensOut.close();
+}
+//-------------------------------------------------------------
+
 //-------------------------------------------------------------
 CTreeNode* CCompilerDriver::RunParser(void)
 {
 	CParser Parser;
-	CTreeNode *ParseTree = Parser.ParseSourceFile(m_InputFile);
+	CTreeNode *ParseTree = Parser.ParseSourceFile(m_InputFile, m_MapSourceFile, 
+	                                               m_ParallelLex, m_TableScanner);
 
 	//see if parsing completed without errors
 	if(!ParseTree)
 		return NULL;
 
-	//dump the parse tree if required
+	DumpParseTree(ParseTree);
+	return ParseTree;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CCompilerDriver::DumpParseTree(CTreeNode *ParseTree)
+{
 	if(m_DumpParseTree)
 	{
-		//for some reason allocating ParseTreeDoc on the stack triggers an exception
-		//in the mem mngr, might be a bug inside TinyXML???
-		TiXmlDocument *ParseTreeDoc = new TiXmlDocument();
-
-		//create the root node, then pass it to the parse tree to dump to
-		ParseTreeDoc->InsertEndChild(TiXmlElement("parse_tree"));
-		ParseTree->DumpAsParseTreeNode(ParseTreeDoc->RootElement());
-
-		//save the XML document representing the tree and free the doc object
-		ParseTreeDoc->SaveFile("ParseTree.xml");
-		delete ParseTreeDoc;
-		ParseTreeDoc = NULL;
-	}
+		//each node is written out as soon as it's visited rather than
+		//building the whole document in memory and saving it at the end
+		CXmlWriter ParseTreeOut;
 
-	return ParseTree;
+		if(!ParseTreeOut.Open("ParseTree.xml"))
+			InternalError("unable to open parse tree dump file");
+
+		ParseTreeOut.OpenElement("parse_tree");
+		ParseTree->DumpAsParseTreeNode(ParseTreeOut);
+		ParseTreeOut.CloseElement();
+		ParseTreeOut.Close();
+	}
 }
 //-------------------------------------------------------------
 
@@ -248,7 +671,35 @@ CTreeNode* CCompilerDriver::RewriteIntoMIRForm(CTreeNode *ParseTree)
 		RootMirNode->AddChild(Temp);
 	}
 
-	//dump the tree if required
+	RunCopyPropagator(RootMirNode);
+	DumpMirTree(RootMirNode);
+	return RootMirNode;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CCompilerDriver::RunCopyPropagator(CTreeNode *MirTree)
+{
+	CCopyPropagator Propagator;
+
+	for(unsigned int i = 0; i < MirTree->GetNumChildren(); i++)
+	{
+		if(MirTree->GetChild(i)->Code == TC_FUNCTIONDECL)
+		{
+			//get a pointer to the function
+			CFunctionDeclTreeNode *FnDecl;
+			FnDecl = (CFunctionDeclTreeNode*)MirTree->GetChild(i);
+
+			//remove the temporaries lowering didn't need
+			Propagator.PropagateCopies(FnDecl);
+		}
+	}
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CCompilerDriver::DumpMirTree(CTreeNode *MirTree)
+{
 	if(m_DumpMirTree)
 	{
 		ofstream MirTreeOut("MirTreeDump.txt");
@@ -256,11 +707,9 @@ CTreeNode* CCompilerDriver::RewriteIntoMIRForm(CTreeNode *ParseTree)
 		if(!MirTreeOut.is_open())
 			InternalError("unable to open MIR dump tree file");
 
-    RootMirNode->DumpAsMIRTreeNode(MirTreeOut);
+    MirTree->DumpAsMIRTreeNode(MirTreeOut);
 		MirTreeOut.close();
 	}
-
-	return RootMirNode;
 }
 //-------------------------------------------------------------
 
@@ -372,6 +821,7 @@ void CCompilerDriver::RunAssemblerAndLinker(void)
 //-------------------------------------------------------------
 void CCompilerDriver::ConstructSingletons(void)
 {
+	CAtomTable *TempAtomTable = new CAtomTable();
 	CTreeNodeFactory *TempTreeNodeFactory = new CTreeNodeFactory();
 	CSymbolTable *TempSymTable = new CSymbolTable();
 	CGlobalDataStore *TempGlobStore = new CGlobalDataStore();
@@ -386,6 +836,17 @@ void CCompilerDriver::DeleteSingletons(void)
 	delete CSymbolTable::GetSingletonPtr();
 	delete CGlobalDataStore::GetSingletonPtr();
 	delete CBuiltinFuncMngr::GetSingletonPtr();
+	delete CAtomTable::GetSingletonPtr();
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CCompilerDriver::ReportInternalError(CInternalErrorException &Err)
+{
+	cout << "an internal compiler error has occurred, details: " << endl;
+	cout << "  function: " << Err.GetFunc() << endl;
+	cout << "  line: " << Err.GetLine() << endl;
+	cout << "  message: " << Err.GetMsg() << endl;
 }
 //-------------------------------------------------------------
 
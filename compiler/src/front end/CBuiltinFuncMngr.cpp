@@ -23,7 +23,6 @@ void CBuiltinFuncMngr::InitialiseBuiltins(bool InMir)
 {
 	//save on typing later on
 	CTreeNodeFactory *TreeNodeFactory = CTreeNodeFactory::GetSingletonPtr();
-	CSymbolTable *SymTable = CSymbolTable::GetSingletonPtr();
 
 	//names of the builtin functions
 	string PrintStringName = InMir ? "_print_string" : "print_string";
@@ -41,7 +40,7 @@ void CBuiltinFuncMngr::InitialiseBuiltins(bool InMir)
 	PrintStringDecl = (CFunctionDeclTreeNode*)TreeNodeFactory->BuildFunctionDecl(
 		PrintStringName, 1, PrintStringParms, TOKTYPE_VOID);
 
-	SymTable->AddSymbol(PrintStringName, PrintStringDecl, 0, TOKTYPE_VOID);
+	BindBuiltin(PrintStringName, PrintStringDecl, InMir);
 	m_BuiltinFnDecls.push_back(PrintStringDecl);
 
 	//print_integer
@@ -54,7 +53,7 @@ void CBuiltinFuncMngr::InitialiseBuiltins(bool InMir)
 	PrintIntegerDecl = (CFunctionDeclTreeNode*)TreeNodeFactory->BuildFunctionDecl(
 		PrintIntegerName, 1, PrintIntegerParms, TOKTYPE_VOID);
 
-	SymTable->AddSymbol(PrintIntegerName, PrintIntegerDecl, 0, TOKTYPE_VOID);
+	BindBuiltin(PrintIntegerName, PrintIntegerDecl, InMir);
 	m_BuiltinFnDecls.push_back(PrintIntegerDecl);
 
 	//print_float
@@ -67,7 +66,7 @@ void CBuiltinFuncMngr::InitialiseBuiltins(bool InMir)
 	PrintFloatDecl = (CFunctionDeclTreeNode*)TreeNodeFactory->BuildFunctionDecl(
 		PrintFloatName, 1, PrintFloatParms, TOKTYPE_VOID);
 
-	SymTable->AddSymbol(PrintFloatName, PrintFloatDecl, 0, TOKTYPE_VOID);
+	BindBuiltin(PrintFloatName, PrintFloatDecl, InMir);
 	m_BuiltinFnDecls.push_back(PrintFloatDecl);
 
 	//print_boolean
@@ -80,7 +79,7 @@ void CBuiltinFuncMngr::InitialiseBuiltins(bool InMir)
 	PrintBooleanDecl = (CFunctionDeclTreeNode*)TreeNodeFactory->BuildFunctionDecl(
 		PrintBooleanName, 1, PrintBooleanParms, TOKTYPE_VOID);
 
-	SymTable->AddSymbol(PrintBooleanName, PrintBooleanDecl, 0, TOKTYPE_VOID);
+	BindBuiltin(PrintBooleanName, PrintBooleanDecl, InMir);
 	m_BuiltinFnDecls.push_back(PrintBooleanDecl);
 
 		//initialise the builtin functions list
@@ -94,6 +93,26 @@ void CBuiltinFuncMngr::InitialiseBuiltins(bool InMir)
 }
 //-------------------------------------------------------------
 
+//-------------------------------------------------------------
+void CBuiltinFuncMngr::BindBuiltin(const string &Name, CFunctionDeclTreeNode *FnDecl,
+																	 bool InMir)
+{
+	CSymbolTable *SymTable = CSymbolTable::GetSingletonPtr();
+
+	if(!InMir)
+	{
+		FnDecl->Binding = SymTable->AddSymbol(Name, FnDecl, 0, TOKTYPE_VOID);
+		return;
+	}
+
+	//calls were bound while parsing, to the symbol for the name without
+	//the leading underscore, so just repoint that at the MIR decl
+	FnDecl->Binding = SymTable->LookupIdentifier(Name.substr(1), false);
+	SanityCheck(FnDecl->Binding);
+	FnDecl->Binding->IdPtr = FnDecl;
+}
+//-------------------------------------------------------------
+
 //-------------------------------------------------------------
 void CBuiltinFuncMngr::DestroyBuiltins(void)
 {
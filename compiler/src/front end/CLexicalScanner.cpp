@@ -7,10 +7,108 @@
 #include "StdHeader.h"
 #include "CLexicalScanner.h"
 
+#include <windows.h>
+
+//short names for the character classes to keep the table below readable
+#define O CHARCLASS_OTHER
+#define L CHARCLASS_LETTER
+#define D CHARCLASS_DIGIT
+#define P CHARCLASS_DOT
+#define Q CHARCLASS_QUOTE
+#define S CHARCLASS_EQUALS
+#define E CHARCLASS_END
+
+//-------------------------------------------------------------
+const unsigned char CLexicalScanner::ms_CharClasses[256] = 
+{
+	E, O, O, O, O, O, O, O, O, O, O, O, O, O, O, O,
+	O, O, O, O, O, O, O, O, O, O, O, O, O, O, O, O,
+	O, O, Q, O, O, O, O, O, O, O, O, O, O, O, P, O,
+	D, D, D, D, D, D, D, D, D, D, O, O, O, S, O, O,
+	O, L, L, L, L, L, L, L, L, L, L, L, L, L, L, L,
+	L, L, L, L, L, L, L, L, L, L, L, O, O, O, O, L,
+	O, L, L, L, L, L, L, L, L, L, L, L, L, L, L, L,
+	L, L, L, L, L, L, L, L, L, L, L, O, O, O, O, O,
+	O, O, O, O, O, O, O, O, O, O, O, O, O, O, O, O,
+	O, O, O, O, O, O, O, O, O, O, O, O, O, O, O, O,
+	O, O, O, O, O, O, O, O, O, O, O, O, O, O, O, O,
+	O, O, O, O, O, O, O, O, O, O, O, O, O, O, O, O,
+	O, O, O, O, O, O, O, O, O, O, O, O, O, O, O, O,
+	O, O, O, O, O, O, O, O, O, O, O, O, O, O, O, O,
+	O, O, O, O, O, O, O, O, O, O, O, O, O, O, O, O,
+	O, O, O, O, O, O, O, O, O, O, O, O, O, O, O, O
+};
+//-------------------------------------------------------------
+
+#undef O
+#undef L
+#undef D
+#undef P
+#undef Q
+#undef S
+#undef E
+
+//shorter names for the states for the same reason
+#define START  SCANSTATE_START
+#define ID     SCANSTATE_IDENTIFIER
+#define NUM    SCANSTATE_INTEGER
+#define FRC    SCANSTATE_FRACTION
+#define STR    SCANSTATE_STRING
+#define STREND SCANSTATE_STRING_END
+#define OP     SCANSTATE_OPERATOR
+#define OPEND  SCANSTATE_OPERATOR_END
+#define DONE   SCANSTATE_DONE
+
 //-------------------------------------------------------------
-CLexicalScanner::CLexicalScanner(void) : m_InputBufferSize(4098)
+const unsigned char CLexicalScanner::ms_Transitions[NUM_SCANSTATES][NUM_CHARCLASSES] =
+{
+	//other   letter  digit   dot     quote   equals  end
+	{ OP,     ID,     NUM,    OP,     STR,    OP,     OP   }, //START
+	{ DONE,   ID,     ID,     DONE,   DONE,   DONE,   DONE }, //ID
+	{ DONE,   DONE,   NUM,    FRC,    DONE,   DONE,   DONE }, //NUM
+	{ DONE,   DONE,   FRC,    DONE,   DONE,   DONE,   DONE }, //FRC
+	{ STR,    STR,    STR,    STR,    STREND, STR,    DONE }, //STR
+	{ DONE,   DONE,   DONE,   DONE,   DONE,   DONE,   DONE }, //STREND
+	{ DONE,   DONE,   DONE,   DONE,   DONE,   OPEND,  DONE }, //OP
+	{ DONE,   DONE,   DONE,   DONE,   DONE,   DONE,   DONE }  //OPEND
+};
+//-------------------------------------------------------------
+
+#undef START
+#undef ID
+#undef NUM
+#undef FRC
+#undef STR
+#undef STREND
+#undef OP
+#undef OPEND
+#undef DONE
+
+//-------------------------------------------------------------
+CLexicalScanner::CLexicalScanner(void) : m_InputBufferSize(4098), 
+                                         m_MinScanChunkSize(256 * 1024)
 {
 	m_InputBuffer = NULL;
+
+	m_MappedInput = false;
+	m_TableDriven = false;
+	m_MappedFile = NULL;
+	m_FileMapping = NULL;
+	m_MappedView = NULL;
+	m_TokenStart = NULL;
+	m_InputStart = NULL;
+	m_InputLength = 0;
+
+	m_ParallelScan = false;
+	m_ChunkStart = NULL;
+	m_ChunkEnd = NULL;
+	m_ChunkFirstLine = 0;
+
+	m_NextTokenIdx = 0;
+	m_NumPeekedTokens = 0;
+	m_NumScannedTokens = 0;
+	m_EndLineNumber = 0;
+	m_SkippedToNextToken = false;
 }
 //-------------------------------------------------------------
 
@@ -20,116 +118,74 @@ CLexicalScanner::~CLexicalScanner(void)
 	delete [] m_InputBuffer;
 	m_InputBuffer = NULL;
 
+	UnmapInputFile();
 	m_FileHandle.close();
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
-bool CLexicalScanner::SetInputFile(const string &File)
+bool CLexicalScanner::SetInputFile(const string &File, bool MapFile, 
+                                   bool ParallelScan, bool TableDriven)
 {
-	//try and open it
-	m_FileHandle.open(File.c_str());
+	m_MappedInput = MapFile;
+	m_ParallelScan = ParallelScan;
+	m_TableDriven = TableDriven;
 
-	if(!m_FileHandle.is_open())
+	if(m_MappedInput)
 	{
-		cout << "error: unable to open file " + File << endl;
-		return false;
+		//map the whole file, m_ForwardPtr is left pointing at the first character
+		if(!MapInputFile(File))
+		{
+			cout << "error: unable to open file " + File << endl;
+			return false;
+		}
+
+		m_InputStart = m_ForwardPtr;
 	}
+	else
+	{
+		//try and open it
+		m_FileHandle.open(File.c_str());
 
-	//allocate the buffers and read in the first lot of characters
-	m_InputBuffer = new char[m_InputBufferSize + 2];
+		if(!m_FileHandle.is_open())
+		{
+			cout << "error: unable to open file " + File << endl;
+			return false;
+		}
+
+		//allocate the buffers and read in the first lot of characters
+		m_InputBuffer = new char[m_InputBufferSize + 2];
+		RefreshInputBuffer();
+	}
 
-	RefreshInputBuffer();
 	m_CurrLineNumber = 1;
 
 	//clear out the current token
 	m_CurrTokenStr = "";
-	m_PeekingAtToken = false;
+	m_PeekedTokens.clear();
+	m_NumPeekedTokens = 0;
 
-	//build the reserved id's list
-	InitialiseKeywordsList();
 	EatWhitespaceAndComments();
-	return true;
-}
-//-------------------------------------------------------------
-
-//-------------------------------------------------------------
-void CLexicalScanner::InitialiseKeywordsList(void)
-{
-	InitialiseTypeTokens();
-	InitialiseControlStmtTokens();
-	InitialiseFunctionTokens();
-	InitialiseMiscTokens();
-
-	//Boolean literals
-	m_Keywords.insert(make_pair("true", TOKTYPE_TRUE));
-	m_Keywords.insert(make_pair("false", TOKTYPE_FALSE));
-}
-//-------------------------------------------------------------
 
-//-------------------------------------------------------------
-void CLexicalScanner::InitialiseTypeTokens(void)
-{
-	m_Keywords.insert(make_pair("integer", TOKTYPE_INTEGERTYPE));
-	m_Keywords.insert(make_pair("float", TOKTYPE_FLOATTYPE));
-	m_Keywords.insert(make_pair("boolean", TOKTYPE_BOOLEANTYPE));
-	m_Keywords.insert(make_pair("string", TOKTYPE_STRINGTYPE));
-	m_Keywords.insert(make_pair("const", TOKTYPE_CONST));
-}
-//-------------------------------------------------------------
+	//when the whole file is in memory we scan it all in one go
+	if(m_MappedInput)
+		BufferAllTokens();
 
-//-------------------------------------------------------------
-void CLexicalScanner::InitialiseControlStmtTokens(void)
-{
-	m_Keywords.insert(make_pair("if", TOKTYPE_IF));
-	m_Keywords.insert(make_pair("else", TOKTYPE_ELSE));
-	m_Keywords.insert(make_pair("end_if", TOKTYPE_ENDIF));
-	m_Keywords.insert(make_pair("while", TOKTYPE_WHILE));
-	m_Keywords.insert(make_pair("end_while", TOKTYPE_END_WHILE));
-}
-//-------------------------------------------------------------
-
-//-------------------------------------------------------------
-void CLexicalScanner::InitialiseFunctionTokens(void)
-{
-	m_Keywords.insert(make_pair("function", TOKTYPE_FUNCTION));
-	m_Keywords.insert(make_pair("returns", TOKTYPE_RETURNS));
-	m_Keywords.insert(make_pair("end_function", TOKTYPE_END_FUNCTION));
-	m_Keywords.insert(make_pair("return", TOKTYPE_RETURN));
-	m_Keywords.insert(make_pair("void", TOKTYPE_VOID));
-}
-//-------------------------------------------------------------
-
-//-------------------------------------------------------------
-void CLexicalScanner::InitialiseMiscTokens(void)
-{
-	m_MiscTokens.insert(make_pair("=", TOKTYPE_ASSIGNMENT));
-	m_MiscTokens.insert(make_pair("(", TOKTYPE_OPENPAREN));
-	m_MiscTokens.insert(make_pair(")", TOKTYPE_CLOSEPAREN));
-	m_MiscTokens.insert(make_pair(";", TOKTYPE_SEMICOLON));
-	m_MiscTokens.insert(make_pair("<", TOKTYPE_LESSTHAN));
-	m_MiscTokens.insert(make_pair("<=", TOKTYPE_LESSTHANEQ));
-	m_MiscTokens.insert(make_pair(">", TOKTYPE_GREATTHAN));
-	m_MiscTokens.insert(make_pair(">=", TOKTYPE_GREATTHANEQ));
-	m_MiscTokens.insert(make_pair("!", TOKTYPE_NOT));
-	m_MiscTokens.insert(make_pair("!=", TOKTYPE_NOTEQ));
-	m_MiscTokens.insert(make_pair("==", TOKTYPE_EQUALITY));
-	m_MiscTokens.insert(make_pair("or", TOKTYPE_OR));
-	m_MiscTokens.insert(make_pair("and", TOKTYPE_AND));
-	m_MiscTokens.insert(make_pair("[", TOKTYPE_OPENSQRPAREN));
-	m_MiscTokens.insert(make_pair("]", TOKTYPE_CLOSESQRPAREN));
-	m_MiscTokens.insert(make_pair(",", TOKTYPE_COMMA));
-
-	m_MiscTokens.insert(make_pair("-", TOKTYPE_MINUS));
-	m_MiscTokens.insert(make_pair("+", TOKTYPE_PLUS));
-	m_MiscTokens.insert(make_pair("/", TOKTYPE_DIVIDE));
-	m_MiscTokens.insert(make_pair("*", TOKTYPE_MULTIPLY));
+	return true;
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
 void CLexicalScanner::EatWhitespaceAndComments(void)
 {
+	//the whole file is contiguous in memory when scanning in place
+	//so we can skip over it a word at a time instead
+	if(m_MappedInput)
+	{
+		EatWhitespaceAndCommentsInPlace();
+		return;
+	}
+
 	bool EndOfWs = false;
 
 	while(!EndOfWs)
@@ -151,8 +207,14 @@ void CLexicalScanner::EatWhitespaceAndComments(void)
 						++m_CurrLineNumber;
 
 					if(*m_ForwardPtr == 0)
+					{
 						RefreshInputBuffer();
 
+						//unterminated comment at the end of the file
+						if(InputExhausted())
+							return;
+					}
+
 					if(*m_ForwardPtr == '*')
 					{
 						IncForwardPtr();
@@ -174,10 +236,12 @@ void CLexicalScanner::EatWhitespaceAndComments(void)
 			}
 		}
 
-		//check for whitespace
+		//check for whitespace, carriage returns only turn up when scanning
+		//in place since we don't get the text mode translation of ifstream
 		else if(*m_ForwardPtr == ' '
             || *m_ForwardPtr == '\t'
-            || *m_ForwardPtr == '\n')
+            || *m_ForwardPtr == '\n'
+            || *m_ForwardPtr == '\r')
 		{
 			//skip it
 			do
@@ -189,7 +253,8 @@ void CLexicalScanner::EatWhitespaceAndComments(void)
 			}
 			while(*m_ForwardPtr == ' '
             || *m_ForwardPtr == '\t'
-            || *m_ForwardPtr == '\n');
+            || *m_ForwardPtr == '\n'
+            || *m_ForwardPtr == '\r');
 		}
 		else
 			EndOfWs = true;
@@ -200,17 +265,13 @@ void CLexicalScanner::EatWhitespaceAndComments(void)
 }
 //-------------------------------------------------------------
 
-//-------------------------------------------------------------
-bool CLexicalScanner::IsKeyword(const string &TokStr)
-{
-	TokenMap::iterator itr = m_Keywords.find(TokStr);
-	return !(itr == m_Keywords.end());
-}
-//-------------------------------------------------------------
-
 //-------------------------------------------------------------
 void CLexicalScanner::RefreshInputBuffer(void)
 {
+	//nothing to do if the whole file is already in memory
+	if(m_MappedInput)
+		return;
+
 	//if we're not at the end of the file, read the next lot in
 	if(!m_FileHandle.eof())
 	{
@@ -237,35 +298,76 @@ char CLexicalScanner::IncForwardPtr(void)
 //-------------------------------------------------------------
 bool CLexicalScanner::HasMoreTokens(void)
 {
-	if(m_FileHandle.eof())
+	//the whitespace after the furthest token scanned was skipped when the
+	//file was buffered, we just need to remember we're now past it
+	if(m_MappedInput)
 	{
-		if(*m_ForwardPtr == 0)
-			return false;
+		m_SkippedToNextToken = true;
+		return m_NumScannedTokens < m_TokenTypes.size();
 	}
 
+	if(InputExhausted())
+		return false;
+
 	//in some situations we might not be at the end of the file but
 	//have no more tokens left if there's a lot of trailing whitespace
 	//or a large comment block so skip over that here
 	EatWhitespaceAndComments();
 
-	if(m_FileHandle.eof() && *m_ForwardPtr == 0)
-		return false;
-	else
-		return true;
+	return !InputExhausted();
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
 Token_t CLexicalScanner::GetNextToken(void)
 {
+	if(m_MappedInput)
+	{
+		//the next token is either the first of the peeked ones or a fresh
+		//one, either way it's the next in the buffer
+		if(m_NumPeekedTokens)
+			--m_NumPeekedTokens;
+
+		NoteTokenScanned(m_NextTokenIdx);
+		return MakeBufferedToken(m_NextTokenIdx++);
+	}
+
 	//have we got any peeked tokens?
 	if(!m_PeekedTokens.empty())
 	{
-		Token_t Temp = *m_PeekedTokens.begin();
+		Token_t Temp = m_PeekedTokens.front();
 		m_PeekedTokens.pop_front();
+
+		if(m_NumPeekedTokens)
+			--m_NumPeekedTokens;
+
 		return Temp;
 	}
 
+	return ScanNextToken();
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+Token_t CLexicalScanner::ScanNextToken(void)
+{
+	ScanToken();
+
+	//the m_CurrToken buffer is already filled with zero's so the
+	//name of the token will always be NULL terminated.
+	Token_t RetToken;
+  RetToken.LineNumber = m_CurrLineNumber;
+	RetToken.TokenValue = m_CurrTokenStr;
+	RetToken.Type = GetTokenType(m_CurrTokenStr.c_str(), m_CurrTokenStr.length());
+	RetToken.SrcSpan = NULL;
+	RetToken.SrcSpanLength = (long)m_CurrTokenStr.length();
+	return RetToken;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CLexicalScanner::ScanToken(void)
+{
 	//take a look at the input token and see what we're pointing at,
 	//we can then base a decision about which token to scan based upon that.
 	//Each one the decisions below represents a starting state in the token
@@ -275,6 +377,13 @@ Token_t CLexicalScanner::GetNextToken(void)
 
 	//blank out the old token
 	m_CurrTokenStr = "";
+	m_TokenStart = m_ForwardPtr;
+
+	if(m_TableDriven)
+	{
+		ScanTokenWithTables();
+		return;
+	}
 
 	//find out what we have next
 	if(isalpha((int)*m_ForwardPtr) || *m_ForwardPtr == '_')
@@ -287,7 +396,7 @@ Token_t CLexicalScanner::GetNextToken(void)
 	{
 		//for each of the four tokens in the condition, the next character can be '=' so
 		//handle them all in one go
-		m_CurrTokenStr.append(1, IncForwardPtr());
+		ConsumeChar();
 
 		if(*m_ForwardPtr == '='
 		   || *m_ForwardPtr == '>'
@@ -295,34 +404,71 @@ Token_t CLexicalScanner::GetNextToken(void)
 		   || *m_ForwardPtr == '!')
 		{
 			if(*m_ForwardPtr == '=')
-				m_CurrTokenStr.append(1, IncForwardPtr());
+				ConsumeChar();
 		}
 	}
-
-	//the m_CurrToken buffer is already filled with zero's so the
-	//name of the token will always be NULL terminated.
-	Token_t RetToken;
-  RetToken.LineNumber = m_CurrLineNumber;
-	RetToken.TokenValue = m_CurrTokenStr;
-	RetToken.Type = GetTokenType();
-	return RetToken;
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
 Token_t CLexicalScanner::PeekNextToken(void)
 {
-	m_PeekingAtToken = true;
-	Token_t Temp = GetNextToken();
-	m_PeekedTokens.push_back(Temp);
-	m_PeekingAtToken = false;
-	return Temp;
+	//the peeked token stays at the front until it's consumed by
+	//GetNextToken or ClearPeekedTokens
+	if(!m_NumPeekedTokens)
+		m_NumPeekedTokens = 1;
+
+	if(m_MappedInput)
+	{
+		NoteTokenScanned(m_NextTokenIdx);
+		return MakeBufferedToken(m_NextTokenIdx);
+	}
+
+	//it might have already been scanned by PeekTokenType
+	if(m_PeekedTokens.empty())
+		m_PeekedTokens.push_back(ScanNextToken());
+
+	return m_PeekedTokens.front();
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+TokenType CLexicalScanner::PeekTokenType(size_t Ahead)
+{
+	if(m_MappedInput)
+	{
+		NoteTokenScanned(m_NextTokenIdx + Ahead);
+
+		if(m_NextTokenIdx + Ahead < m_TokenTypes.size())
+			return m_TokenTypes[m_NextTokenIdx + Ahead];
+		else
+			return TOKTYPE_ID;
+	}
+
+	//scan as far as we need to, these tokens are handed out by GetNextToken
+	//and PeekNextToken as normal when we get to them
+	while(m_PeekedTokens.size() <= Ahead)
+		m_PeekedTokens.push_back(ScanNextToken());
+
+	return m_PeekedTokens[Ahead].Type;
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
 void CLexicalScanner::PushbackToken(Token_t Tok)
 {
+	++m_NumPeekedTokens;
+
+	if(m_MappedInput)
+	{
+		//the parser only ever pushes back the token it's just read so all
+		//we need to do is step back over it
+		SanityCheck(m_NextTokenIdx > 0);
+		--m_NextTokenIdx;
+		SanityCheck(MakeBufferedToken(m_NextTokenIdx).SrcSpan == Tok.SrcSpan);
+		return;
+	}
+
 	m_PeekedTokens.push_front(Tok);
 }
 //-------------------------------------------------------------
@@ -330,44 +476,208 @@ void CLexicalScanner::PushbackToken(Token_t Tok)
 //-------------------------------------------------------------
 void CLexicalScanner::ClearPeekedTokens(void)
 {
-	m_PeekedTokens.clear();
+	if(m_MappedInput)
+		m_NextTokenIdx += m_NumPeekedTokens;
+	else
+		m_PeekedTokens.erase(m_PeekedTokens.begin(), m_PeekedTokens.begin() + m_NumPeekedTokens);
+
+	m_NumPeekedTokens = 0;
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
-TokenType CLexicalScanner::GetTokenType(void)
+TokenType CLexicalScanner::GetTokenType(const char *Str, size_t Length)
 {
-	if(IsKeyword(m_CurrTokenStr))
-		return m_Keywords[m_CurrTokenStr];
+	//the first character tells us which class of token we have so we
+	//only ever need to compare against the handful of tokens in that class
+	if(isalpha((int)Str[0]) || Str[0] == '_')
+		return ClassifyWord(Str, Length);
+	else if(isdigit((int)Str[0]))
+	{
+		//if a decimal point is present, it an FP number
+		if(memchr(Str, '.', Length))
+			return TOKTYPE_FLOATLITERAL;
+		else
+			return TOKTYPE_INTLITERAL;
+	}
+	else if(Str[0] == '\"')
+		return TOKTYPE_STRINGLITERAL;
 	else
+		return ClassifyOperator(Str, Length);
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+TokenType CLexicalScanner::ClassifyWord(const char *Str, size_t Length)
+{
+	//switch on the length first then the leading character, after that
+	//there's at most two reserved words left to compare against
+	switch(Length)
 	{
-		//see if it's one of the misc tokens
-		TokenMap::iterator itr = m_MiscTokens.find(m_CurrTokenStr);
+	case 2:
+		if(!memcmp(Str, "if", 2))
+			return TOKTYPE_IF;
+		else if(!memcmp(Str, "or", 2))
+			return TOKTYPE_OR;
+		break;
+
+	case 3:
+		if(!memcmp(Str, "and", 3))
+			return TOKTYPE_AND;
+		break;
 
-		if(itr == m_MiscTokens.end())
+	case 4:
+		if(Str[0] == 'e' && !memcmp(Str, "else", 4))
+			return TOKTYPE_ELSE;
+		else if(Str[0] == 't' && !memcmp(Str, "true", 4))
+			return TOKTYPE_TRUE;
+		else if(Str[0] == 'v' && !memcmp(Str, "void", 4))
+			return TOKTYPE_VOID;
+		break;
+
+	case 5:
+		if(Str[0] == 'f')
 		{
-			//not one of the misc tokens, must be an either a digit
-			if(isdigit((int)m_CurrTokenStr[0]))
-			{
-				//if a decimal point is present, it an FP number
-				string Temp(m_CurrTokenStr);
-				if(Temp.find(".") != string::npos)
-					return TOKTYPE_FLOATLITERAL;
-				else
-					return TOKTYPE_INTLITERAL;
-			}
-			else
-			{
-				//if the first character is a double quote we have a string,
-				//otherwise a name
-				if(m_CurrTokenStr[0] == '\"')
-					return TOKTYPE_STRINGLITERAL;
-				else
-					return TOKTYPE_ID;
-			}
+			if(!memcmp(Str, "float", 5))
+				return TOKTYPE_FLOATTYPE;
+			else if(!memcmp(Str, "false", 5))
+				return TOKTYPE_FALSE;
 		}
-		else
-			return itr->second;
+		else if(Str[0] == 'c' && !memcmp(Str, "const", 5))
+			return TOKTYPE_CONST;
+		else if(Str[0] == 'w' && !memcmp(Str, "while", 5))
+			return TOKTYPE_WHILE;
+		break;
+
+	case 6:
+		if(Str[0] == 's' && !memcmp(Str, "string", 6))
+			return TOKTYPE_STRINGTYPE;
+		else if(Str[0] == 'e' && !memcmp(Str, "end_if", 6))
+			return TOKTYPE_ENDIF;
+		else if(Str[0] == 'r' && !memcmp(Str, "return", 6))
+			return TOKTYPE_RETURN;
+		break;
+
+	case 7:
+		if(Str[0] == 'i' && !memcmp(Str, "integer", 7))
+			return TOKTYPE_INTEGERTYPE;
+		else if(Str[0] == 'b' && !memcmp(Str, "boolean", 7))
+			return TOKTYPE_BOOLEANTYPE;
+		else if(Str[0] == 'r' && !memcmp(Str, "returns", 7))
+			return TOKTYPE_RETURNS;
+		break;
+
+	case 8:
+		if(!memcmp(Str, "function", 8))
+			return TOKTYPE_FUNCTION;
+		break;
+
+	case 9:
+		if(!memcmp(Str, "end_while", 9))
+			return TOKTYPE_END_WHILE;
+		break;
+
+	case 12:
+		if(!memcmp(Str, "end_function", 12))
+			return TOKTYPE_END_FUNCTION;
+		break;
+	}
+
+	return TOKTYPE_ID;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+TokenType CLexicalScanner::ClassifyOperator(const char *Str, size_t Length)
+{
+	if(Length == 1)
+	{
+		switch(Str[0])
+		{
+		case '=':
+			return TOKTYPE_ASSIGNMENT;
+
+		case '(':
+			return TOKTYPE_OPENPAREN;
+
+		case ')':
+			return TOKTYPE_CLOSEPAREN;
+
+		case '[':
+			return TOKTYPE_OPENSQRPAREN;
+
+		case ']':
+			return TOKTYPE_CLOSESQRPAREN;
+
+		case ';':
+			return TOKTYPE_SEMICOLON;
+
+		case ',':
+			return TOKTYPE_COMMA;
+
+		case '<':
+			return TOKTYPE_LESSTHAN;
+
+		case '>':
+			return TOKTYPE_GREATTHAN;
+
+		case '!':
+			return TOKTYPE_NOT;
+
+		case '-':
+			return TOKTYPE_MINUS;
+
+		case '+':
+			return TOKTYPE_PLUS;
+
+		case '/':
+			return TOKTYPE_DIVIDE;
+
+		case '*':
+			return TOKTYPE_MULTIPLY;
+		}
+	}
+
+	//the only two character operators are the relational ones ending in '='
+	else if(Length == 2 && Str[1] == '=')
+	{
+		switch(Str[0])
+		{
+		case '<':
+			return TOKTYPE_LESSTHANEQ;
+
+		case '>':
+			return TOKTYPE_GREATTHANEQ;
+
+		case '!':
+			return TOKTYPE_NOTEQ;
+
+		case '=':
+			return TOKTYPE_EQUALITY;
+		}
+	}
+
+	//anything else we don't recognise gets treated as a name, the
+	//parser will report it as an error
+	return TOKTYPE_ID;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CLexicalScanner::ScanTokenWithTables(void)
+{
+	//every token has at least one character so the start state always
+	//moves on, the token ends when there's no transition for the next one
+	unsigned char State = SCANSTATE_START;
+
+	while(true)
+	{
+		State = ms_Transitions[State][ms_CharClasses[(unsigned char)*m_ForwardPtr]];
+
+		if(State == SCANSTATE_DONE)
+			break;
+
+		ConsumeChar();
 	}
 }
 //-------------------------------------------------------------
@@ -380,7 +690,7 @@ void CLexicalScanner::ScanIdentifierToken(void)
 	      || *m_ForwardPtr == '_')
 	{
 		//copy the character across to the token buffer
-		m_CurrTokenStr.append(1, IncForwardPtr());
+		ConsumeChar();
 	}
 }
 //-------------------------------------------------------------
@@ -393,7 +703,7 @@ void CLexicalScanner::ScanDigitToken(void)
 	while(isdigit((int)*m_ForwardPtr) || *m_ForwardPtr == '.')
 	{
 		//copy the character across to the token buffer
-		m_CurrTokenStr.append(1, IncForwardPtr());
+		ConsumeChar();
 
 		if(*m_ForwardPtr == '.' && FoundDecimalPoint)
 			break;
@@ -407,20 +717,716 @@ void CLexicalScanner::ScanDigitToken(void)
 void CLexicalScanner::ScanStringToken(void)
 {
 	//copy the opening quote
-	m_CurrTokenStr.append(1, IncForwardPtr());
+	ConsumeChar();
 
-	//copy the body of the string
-	while(*m_ForwardPtr != '\"')
-		m_CurrTokenStr.append(1, IncForwardPtr());
+	//copy the body of the string, stopping at the end of the file if 
+	//it's not terminated
+	while(*m_ForwardPtr != '\"' && !InputExhausted())
+		ConsumeChar();
 
 	//get the closing quote
-	m_CurrTokenStr.append(1, IncForwardPtr());
+	if(!InputExhausted())
+		ConsumeChar();
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
 long CLexicalScanner::CurrentLineNumber(void)
 {
+	//we need to give the same answer as we would if we were scanning the
+	//tokens as we went, which is the line of the furthest token scanned or
+	//the one after that once the whitespace in between has been skipped
+	if(m_MappedInput)
+	{
+		size_t Idx = m_NumScannedTokens;
+
+		if(!m_SkippedToNextToken && Idx > 0)
+			--Idx;
+
+		if(Idx < m_TokenLines.size())
+			return m_TokenLines[Idx];
+		else
+			return m_EndLineNumber;
+	}
+
 	return m_CurrLineNumber;
 }
 //-------------------------------------------------------------
+
+//-------------------------------------------------------------
+bool CLexicalScanner::MapInputFile(const string &File)
+{
+	m_MappedFile = CreateFile(File.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+	if(m_MappedFile == INVALID_HANDLE_VALUE)
+	{
+		m_MappedFile = NULL;
+		return false;
+	}
+
+	//the rest of the scanner relies on there being a NULL character after
+	//the last one in the file to tell it when to stop. We get that for free
+	//as the tail of the last page in a view is zero filled, unless the file
+	//size is an exact multiple of the page size, or the file is empty which
+	//can't be mapped at all. Load the whole file into memory for those.
+	DWORD FileSize = GetFileSize(m_MappedFile, NULL);
+	SYSTEM_INFO SysInfo;
+	GetSystemInfo(&SysInfo);
+
+	if(FileSize == 0 || FileSize % SysInfo.dwPageSize == 0)
+	{
+		UnmapInputFile();
+		return LoadInputFile(File);
+	}
+
+	//map the whole file as a read only view
+	m_FileMapping = CreateFileMapping(m_MappedFile, NULL, PAGE_READONLY, 0, 0, NULL);
+
+	if(m_FileMapping)
+		m_MappedView = (char*)MapViewOfFile(m_FileMapping, FILE_MAP_READ, 0, 0, 0);
+
+	if(!m_MappedView)
+	{
+		UnmapInputFile();
+		return LoadInputFile(File);
+	}
+
+	m_ForwardPtr = m_MappedView;
+	m_InputLength = FileSize;
+	return true;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+bool CLexicalScanner::LoadInputFile(const string &File)
+{
+	//open in binary mode so we read exactly what's on disk, the same
+	//as we see through a mapped view
+	ifstream InFile(File.c_str(), ios::in | ios::binary);
+
+	if(!InFile.is_open())
+		return false;
+
+	InFile.seekg(0, ios::end);
+	int FileSize = (int)InFile.tellg();
+	InFile.seekg(0, ios::beg);
+
+	//read it all in, NULL terminating it so we know where the end is. The
+	//terminator is padded out to a whole word as EatWhitespaceAndCommentsInPlace
+	//reads the buffer a word at a time, the same as the tail of a mapped view
+	m_InputBuffer = new char[FileSize + sizeof(unsigned int)];
+	InFile.read(m_InputBuffer, FileSize);
+	memset(&m_InputBuffer[FileSize], 0, sizeof(unsigned int));
+
+	m_ForwardPtr = m_InputBuffer;
+	m_InputLength = FileSize;
+	return true;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CLexicalScanner::UnmapInputFile(void)
+{
+	if(m_MappedView)
+		UnmapViewOfFile(m_MappedView);
+
+	if(m_FileMapping)
+		CloseHandle(m_FileMapping);
+
+	if(m_MappedFile)
+		CloseHandle(m_MappedFile);
+
+	m_MappedView = NULL;
+	m_FileMapping = NULL;
+	m_MappedFile = NULL;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+bool CLexicalScanner::InputExhausted(void)
+{
+	//when scanning in place the NULL character after the end of the file is
+	//the only one we'll see, otherwise we need to have read the last block in
+	return (m_MappedInput || m_FileHandle.eof()) && *m_ForwardPtr == 0;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CLexicalScanner::ConsumeChar(void)
+{
+	if(m_MappedInput)
+		++m_ForwardPtr;
+	else
+		m_CurrTokenStr.append(1, IncForwardPtr());
+}
+//-------------------------------------------------------------
+//-------------------------------------------------------------
+void CLexicalScanner::EatWhitespaceAndCommentsInPlace(void)
+{
+	const char *Ptr = m_ForwardPtr;
+
+	while(true)
+	{
+		Ptr = SkipWhitespaceInPlace(Ptr);
+
+		//anything other than the start of a comment ends the run, a lone
+		//'/' is left for GetNextToken to pick up as the division op
+		if(Ptr[0] != '/' || Ptr[1] != '*')
+			break;
+
+		Ptr = SkipCommentInPlace(Ptr + 2);
+	}
+
+	m_ForwardPtr = (char*)Ptr;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+const char* CLexicalScanner::SkipWhitespaceInPlace(const char *Ptr)
+{
+	while(true)
+	{
+		//characters are checked one at a time until we reach a word boundary,
+		//then as many whole words of whitespace as possible are skipped at once
+		do
+		{
+			if(*Ptr == '\n')
+				++m_CurrLineNumber;
+			else if(*Ptr != ' ' && *Ptr != '\t' && *Ptr != '\r')
+				return Ptr;
+
+			++Ptr;
+		}
+		while((size_t)Ptr % sizeof(unsigned int));
+
+		//a word is only skipped if every character in it is whitespace, the 
+		//NULL terminator isn't so we never read past the word containing it
+		const unsigned int *Word = (const unsigned int*)Ptr;
+
+		while(true)
+		{
+			unsigned int NewLines = MatchBytes(*Word, '\n');
+			unsigned int Ws = NewLines | MatchBytes(*Word, ' ') 
+			                  | MatchBytes(*Word, '\t') | MatchBytes(*Word, '\r');
+
+			if(Ws != 0x80808080)
+				break;
+
+			m_CurrLineNumber += CountMatchedBytes(NewLines);
+			++Word;
+		}
+
+		Ptr = (const char*)Word;
+	}
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+const char* CLexicalScanner::SkipCommentInPlace(const char *Ptr)
+{
+	while(true)
+	{
+		do
+		{
+			//unterminated comment at the end of the file
+			if(*Ptr == 0)
+				return Ptr;
+
+			if(*Ptr == '\n')
+				++m_CurrLineNumber;
+			else if(Ptr[0] == '*' && Ptr[1] == '/')
+				return Ptr + 2;
+
+			++Ptr;
+		}
+		while((size_t)Ptr % sizeof(unsigned int));
+
+		//only a '*' can end the comment and only a NULL can end the file, any
+		//word without either can be skipped once it's newlines are counted
+		const unsigned int *Word = (const unsigned int*)Ptr;
+
+		while(!(MatchBytes(*Word, '*') | MatchBytes(*Word, 0)))
+		{
+			m_CurrLineNumber += CountMatchedBytes(MatchBytes(*Word, '\n'));
+			++Word;
+		}
+
+		Ptr = (const char*)Word;
+	}
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+unsigned int CLexicalScanner::MatchBytes(unsigned int Word, char Ch)
+{
+	//XOR makes the matching bytes zero, then adding 0x7F to the low 7 bits of
+	//each byte sets the top bit of every byte which wasn't zero. This can't
+	//carry into the next byte, unlike the usual (x - 0x01010101) trick, so
+	//every matching byte is flagged and not just the first.
+	unsigned int Diff = Word ^ ((unsigned char)Ch * 0x01010101u);
+	return ~(((Diff & 0x7F7F7F7F) + 0x7F7F7F7F) | Diff | 0x7F7F7F7F);
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+unsigned int CLexicalScanner::CountMatchedBytes(unsigned int Mask)
+{
+	//each flag ends up in the bottom bit of it's byte, multiplying then
+	//sums all four bytes into the top one
+	return ((Mask >> 7) * 0x01010101u) >> 24;
+}
+//-------------------------------------------------------------
+//-------------------------------------------------------------
+void CLexicalScanner::BufferAllTokens(void)
+{
+	//only split the file up if there's enough of it to make starting
+	//the threads worthwhile
+	size_t NumChunks = 1;
+
+	if(m_ParallelScan)
+	{
+		SYSTEM_INFO SysInfo;
+		GetSystemInfo(&SysInfo);
+
+		NumChunks = min((size_t)SysInfo.dwNumberOfProcessors,
+		                m_InputLength / m_MinScanChunkSize);
+	}
+
+	if(NumChunks > 1)
+		BufferTokensInParallel(NumChunks);
+	else
+	{
+		//a rough guess at how many tokens there are to save reallocating
+		//the buffers too often
+		size_t Estimate = m_InputLength / 4;
+		m_TokenTypes.reserve(Estimate);
+		m_TokenOffsets.reserve(Estimate);
+		m_TokenLengths.reserve(Estimate);
+		m_TokenLines.reserve(Estimate);
+
+		BufferTokens(m_InputStart + m_InputLength);
+	}
+
+	m_EndLineNumber = m_CurrLineNumber;
+	m_SkippedToNextToken = true;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CLexicalScanner::BufferTokens(const char *End)
+{
+	while(!InputExhausted() && m_ForwardPtr < End)
+	{
+		ScanToken();
+
+		long Length = (long)(m_ForwardPtr - m_TokenStart);
+		m_TokenTypes.push_back(GetTokenType(m_TokenStart, Length));
+		m_TokenOffsets.push_back((long)(m_TokenStart - m_InputStart));
+		m_TokenLengths.push_back(Length);
+		m_TokenLines.push_back(m_CurrLineNumber);
+
+		EatWhitespaceAndComments();
+	}
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CLexicalScanner::BufferTokensInParallel(size_t NumChunks)
+{
+	const char *InputEnd = m_InputStart + m_InputLength;
+
+	//split the file into roughly equal sized chunks, moving each split
+	//point forward to the start of the next line
+	vector<const char*> Splits;
+	Splits.push_back(m_ForwardPtr);
+
+	for(size_t i = 1; i < NumChunks; ++i)
+	{
+		const char *Split = m_InputStart + (m_InputLength / NumChunks) * i;
+
+		if(Split <= Splits.back())
+			continue;
+
+		Split = (const char*)memchr(Split, '\n', InputEnd - Split);
+
+		if(!Split)
+			break;
+
+		Splits.push_back(Split + 1);
+	}
+
+	Splits.push_back(InputEnd);
+
+	//each chunk gets it's own scanner working on the same view
+	vector<CLexicalScanner*> Chunks;
+	vector<HANDLE> Threads;
+
+	for(size_t i = 0; i < Splits.size() - 1; ++i)
+	{
+		CLexicalScanner *Chunk = new CLexicalScanner();
+		Chunk->m_MappedInput = true;
+		Chunk->m_TableDriven = m_TableDriven;
+		Chunk->m_InputStart = m_InputStart;
+		Chunk->m_InputLength = m_InputLength;
+		Chunk->m_ForwardPtr = (char*)Splits[i];
+		Chunk->m_ChunkEnd = Splits[i + 1];
+		Chunks.push_back(Chunk);
+
+		//if we can't start a thread for it, scan it ourselves
+		HANDLE Thread = CreateThread(NULL, 0, ScanChunkThread, Chunk, 0, NULL);
+
+		if(Thread)
+			Threads.push_back(Thread);
+		else
+			Chunk->ScanChunk();
+	}
+
+	for(size_t i = 0; i < Threads.size(); ++i)
+	{
+		WaitForSingleObject(Threads[i], INFINITE);
+		CloseHandle(Threads[i]);
+	}
+
+	//stitch the chunks together. ScannedTo is where the tokens so far 
+	//really finished, if that isn't where the next chunk thinks it's first 
+	//token is then the chunk started inside a comment or string or the 
+	//previous chunk's last token ran over into it, so rescan it from there
+	const char *ScannedTo = m_ForwardPtr;
+	long ScannedToLine = m_CurrLineNumber;
+
+	for(size_t i = 0; i < Chunks.size(); ++i)
+	{
+		CLexicalScanner *Chunk = Chunks[i];
+
+		//nothing more to do if we've reached the end of the file
+		if(*ScannedTo != 0)
+		{
+			if(Chunk->m_ChunkStart != ScannedTo)
+			{
+				Chunk->m_TokenTypes.clear();
+				Chunk->m_TokenOffsets.clear();
+				Chunk->m_TokenLengths.clear();
+				Chunk->m_TokenLines.clear();
+
+				Chunk->m_ForwardPtr = (char*)ScannedTo;
+				Chunk->m_CurrLineNumber = ScannedToLine;
+				Chunk->m_ChunkFirstLine = ScannedToLine;
+				Chunk->BufferTokens(Chunk->m_ChunkEnd);
+			}
+
+			//line numbers in the chunk are relative to it's start
+			long LineBase = ScannedToLine - Chunk->m_ChunkFirstLine;
+
+			m_TokenTypes.insert(m_TokenTypes.end(), Chunk->m_TokenTypes.begin(), 
+			                    Chunk->m_TokenTypes.end());
+			m_TokenOffsets.insert(m_TokenOffsets.end(), Chunk->m_TokenOffsets.begin(), 
+			                      Chunk->m_TokenOffsets.end());
+			m_TokenLengths.insert(m_TokenLengths.end(), Chunk->m_TokenLengths.begin(), 
+			                      Chunk->m_TokenLengths.end());
+
+			for(size_t j = 0; j < Chunk->m_TokenLines.size(); ++j)
+				m_TokenLines.push_back(Chunk->m_TokenLines[j] + LineBase);
+
+			ScannedTo = Chunk->m_ForwardPtr;
+			ScannedToLine = Chunk->m_CurrLineNumber + LineBase;
+		}
+
+		delete Chunk;
+	}
+
+	m_ForwardPtr = (char*)ScannedTo;
+	m_CurrLineNumber = ScannedToLine;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CLexicalScanner::ScanChunk(void)
+{
+	size_t Estimate = (m_ChunkEnd - m_ForwardPtr) / 4;
+	m_TokenTypes.reserve(Estimate);
+	m_TokenOffsets.reserve(Estimate);
+	m_TokenLengths.reserve(Estimate);
+	m_TokenLines.reserve(Estimate);
+
+	//the whitespace at the start of the chunk could run past the end of it
+	m_CurrLineNumber = 0;
+	EatWhitespaceAndComments();
+
+	m_ChunkStart = m_ForwardPtr;
+	m_ChunkFirstLine = m_CurrLineNumber;
+
+	BufferTokens(m_ChunkEnd);
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+unsigned long __stdcall CLexicalScanner::ScanChunkThread(void *Scanner)
+{
+	((CLexicalScanner*)Scanner)->ScanChunk();
+	return 0;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+Token_t CLexicalScanner::MakeBufferedToken(size_t Idx)
+{
+	Token_t Tok;
+
+	if(Idx < m_TokenTypes.size())
+	{
+		Tok.Type = m_TokenTypes[Idx];
+		Tok.LineNumber = m_TokenLines[Idx];
+		Tok.SrcSpan = m_InputStart + m_TokenOffsets[Idx];
+		Tok.SrcSpanLength = m_TokenLengths[Idx];
+		Tok.TokenValue.assign(Tok.SrcSpan, Tok.SrcSpanLength);
+	}
+	else
+	{
+		//asking for tokens past the end of the file gets an empty one
+		Tok.Type = TOKTYPE_ID;
+		Tok.LineNumber = m_EndLineNumber;
+		Tok.SrcSpan = NULL;
+		Tok.SrcSpanLength = 0;
+	}
+
+	return Tok;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CLexicalScanner::NoteTokenScanned(size_t Idx)
+{
+	if(Idx >= m_NumScannedTokens)
+	{
+		m_NumScannedTokens = Idx + 1;
+		m_SkippedToNextToken = false;
+	}
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+bool CLexicalScanner::RescanInputFile(const string &File, bool TableDriven, 
+                                      size_t &DamageStart, size_t &OldDamageEnd, 
+                                      size_t &NewDamageEnd)
+{
+	//hang on to the previous contents of the file to compare against
+	bool HavePrevInput = m_MappedInput && m_InputBuffer && !m_MappedView;
+	char *PrevInput = m_InputBuffer;
+	size_t PrevLength = m_InputLength;
+
+	UnmapInputFile();
+	m_InputBuffer = NULL;
+
+	if(!LoadInputFile(File))
+	{
+		cout << "error: unable to open file " + File << endl;
+		m_InputBuffer = PrevInput;
+		return false;
+	}
+
+	m_MappedInput = true;
+	m_ParallelScan = false;
+	m_TableDriven = TableDriven;
+	m_InputStart = m_ForwardPtr;
+
+	m_PeekedTokens.clear();
+	m_NumPeekedTokens = 0;
+	m_NextTokenIdx = 0;
+	m_NumScannedTokens = 0;
+
+	if(!HavePrevInput)
+	{
+		delete [] PrevInput;
+
+		m_TokenTypes.clear();
+		m_TokenOffsets.clear();
+		m_TokenLengths.clear();
+		m_TokenLines.clear();
+
+		m_CurrLineNumber = 1;
+		EatWhitespaceAndComments();
+		BufferAllTokens();
+
+		DamageStart = 0;
+		OldDamageEnd = 0;
+		NewDamageEnd = m_TokenTypes.size();
+		return true;
+	}
+
+	//find how much of the start and end of the file hasn't changed
+	size_t MaxCommon = min(PrevLength, m_InputLength);
+	size_t Prefix = 0;
+	size_t Suffix = 0;
+
+	while(Prefix < MaxCommon && PrevInput[Prefix] == m_InputBuffer[Prefix])
+		++Prefix;
+
+	while(Suffix < MaxCommon - Prefix 
+	      && PrevInput[PrevLength - Suffix - 1] == m_InputBuffer[m_InputLength - Suffix - 1])
+		++Suffix;
+
+	delete [] PrevInput;
+
+	size_t NumOldTokens = m_TokenTypes.size();
+	m_SkippedToNextToken = true;
+
+	//nothing to do if the file hasn't actually changed
+	if(Prefix == PrevLength && Prefix == m_InputLength)
+	{
+		DamageStart = OldDamageEnd = NewDamageEnd = NumOldTokens;
+		return true;
+	}
+
+	//the edit could have joined on to the end of the last token before it, 
+	//so start from the token before the first one which reaches the edit
+	size_t First = 0;
+	size_t Last = NumOldTokens;
+
+	while(First < Last)
+	{
+		size_t Mid = (First + Last) / 2;
+
+		if((size_t)(m_TokenOffsets[Mid] + m_TokenLengths[Mid]) < Prefix)
+			First = Mid + 1;
+		else
+			Last = Mid;
+	}
+
+	if(First > 0)
+		--First;
+
+	if(First == 0)
+	{
+		m_CurrLineNumber = 1;
+		EatWhitespaceAndComments();
+	}
+	else
+	{
+		m_ForwardPtr = m_InputBuffer + m_TokenOffsets[First];
+		m_CurrLineNumber = m_TokenLines[First];
+	}
+
+	//scan until we start a token in the same place in the unchanged tail 
+	//of the file as one of the old tokens, everything from there is the same
+	long Delta = (long)m_InputLength - (long)PrevLength;
+	size_t OldTail = PrevLength - Suffix;
+	size_t Resync = First;
+	long LineDelta = 0;
+	bool Synced = false;
+
+	vector<TokenType> NewTypes;
+	vector<long> NewOffsets;
+	vector<long> NewLengths;
+	vector<long> NewLines;
+
+	while(!InputExhausted())
+	{
+		long Offset = (long)(m_ForwardPtr - m_InputStart);
+
+		while(Resync < NumOldTokens 
+		      && ((size_t)m_TokenOffsets[Resync] < OldTail 
+		          || m_TokenOffsets[Resync] + Delta < Offset))
+			++Resync;
+
+		if(Resync < NumOldTokens && m_TokenOffsets[Resync] + Delta == Offset)
+		{
+			LineDelta = m_CurrLineNumber - m_TokenLines[Resync];
+			Synced = true;
+			break;
+		}
+
+		ScanToken();
+
+		long Length = (long)(m_ForwardPtr - m_TokenStart);
+		NewTypes.push_back(GetTokenType(m_TokenStart, Length));
+		NewOffsets.push_back((long)(m_TokenStart - m_InputStart));
+		NewLengths.push_back(Length);
+		NewLines.push_back(m_CurrLineNumber);
+
+		EatWhitespaceAndComments();
+	}
+
+	if(!Synced)
+		Resync = NumOldTokens;
+
+	//move the tokens we're keeping along and swap in the rescanned ones
+	for(size_t i = Resync; i < NumOldTokens; ++i)
+	{
+		m_TokenOffsets[i] += Delta;
+		m_TokenLines[i] += LineDelta;
+	}
+
+	m_TokenTypes.erase(m_TokenTypes.begin() + First, m_TokenTypes.begin() + Resync);
+	m_TokenOffsets.erase(m_TokenOffsets.begin() + First, m_TokenOffsets.begin() + Resync);
+	m_TokenLengths.erase(m_TokenLengths.begin() + First, m_TokenLengths.begin() + Resync);
+	m_TokenLines.erase(m_TokenLines.begin() + First, m_TokenLines.begin() + Resync);
+
+	m_TokenTypes.insert(m_TokenTypes.begin() + First, NewTypes.begin(), NewTypes.end());
+	m_TokenOffsets.insert(m_TokenOffsets.begin() + First, NewOffsets.begin(), NewOffsets.end());
+	m_TokenLengths.insert(m_TokenLengths.begin() + First, NewLengths.begin(), NewLengths.end());
+	m_TokenLines.insert(m_TokenLines.begin() + First, NewLines.begin(), NewLines.end());
+
+	if(Synced)
+		m_EndLineNumber += LineDelta;
+	else
+		m_EndLineNumber = m_CurrLineNumber;
+
+	DamageStart = First;
+	OldDamageEnd = Resync;
+	NewDamageEnd = First + NewTypes.size();
+	return true;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+size_t CLexicalScanner::CurrentTokenIndex(void)
+{
+	return m_NextTokenIdx;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CLexicalScanner::SeekToToken(size_t Idx)
+{
+	m_NextTokenIdx = Idx;
+	m_NumPeekedTokens = 0;
+
+	//we've effectively scanned every token up to this one
+	if(Idx > 0)
+		NoteTokenScanned(Idx - 1);
+
+	m_SkippedToNextToken = true;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+long CLexicalScanner::TokenLineNumber(size_t Idx)
+{
+	if(Idx < m_TokenLines.size())
+		return m_TokenLines[Idx];
+	else
+		return m_EndLineNumber;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+unsigned int CLexicalScanner::HashTokens(size_t First, size_t End)
+{
+	//FNV-1a over the characters of each token, with the length of each
+	//token mixed in so the boundaries between them count
+	unsigned int Hash = 2166136261u;
+
+	for(size_t i = First; i < End && i < m_TokenTypes.size(); ++i)
+	{
+		const char *Str = m_InputStart + m_TokenOffsets[i];
+
+		for(long j = 0; j < m_TokenLengths[i]; ++j)
+			Hash = (Hash ^ (unsigned char)Str[j]) * 16777619u;
+
+		Hash = (Hash ^ (unsigned int)m_TokenLengths[i]) * 16777619u;
+	}
+
+	return Hash;
+}
+//-------------------------------------------------------------
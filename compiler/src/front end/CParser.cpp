@@ -19,74 +19,270 @@
 #include "CArithExprTreeNode.h"
 #include "CArrayRefTreeNode.h"
 #include "CCallExprTreeNode.h"
+#include "CUnaryExprTreeNode.h"
 #include "CGlobalDataStore.h"
 #include "CBuiltinFuncMngr.h"
 
 //-------------------------------------------------------------
-CParser::CParser(void)
+const unsigned char CParser::ms_BindingPowers[NUM_TOKTYPES] =
 {
-	//initialise the precedence table
-	m_OpPrecs.insert(make_pair(TOKTYPE_NOT, 7));
-	m_OpPrecs.insert(make_pair(TOKTYPE_DIVIDE, 6));
-	m_OpPrecs.insert(make_pair(TOKTYPE_MULTIPLY, 6));
-	m_OpPrecs.insert(make_pair(TOKTYPE_PLUS, 5));
-	m_OpPrecs.insert(make_pair(TOKTYPE_MINUS, 5));
-	m_OpPrecs.insert(make_pair(TOKTYPE_LESSTHAN, 4));
-	m_OpPrecs.insert(make_pair(TOKTYPE_LESSTHANEQ, 4));
-	m_OpPrecs.insert(make_pair(TOKTYPE_GREATTHAN, 4));
-	m_OpPrecs.insert(make_pair(TOKTYPE_GREATTHANEQ, 4));
-	m_OpPrecs.insert(make_pair(TOKTYPE_EQUALITY, 3));
-	m_OpPrecs.insert(make_pair(TOKTYPE_NOTEQ, 3));
-	m_OpPrecs.insert(make_pair(TOKTYPE_AND, 2));
-	m_OpPrecs.insert(make_pair(TOKTYPE_OR, 1));
+	0, 0, 0, 0, 0, 0,	//type keywords, const and void
+	0, 0, 0, 0, 0,		//if, else, end_if, while and end_while
+	0, 0, 0, 0,			//function, returns, end_function and return
+	0, 0,				//true and false
+	0, 0, 0, 0, 0,		//identifiers, literals and assignment
+	0, 0, 0, 0,			//'(', ')', '[' and ']'
+	0, 0,				//';' and ','
+	5, 5, 6, 6,			//'+', '-', '/' and '*'
+	4, 4, 4, 4,			//'<', '<=', '>' and '>='
+	7, 3, 3, 1, 2		//'!', '!=', '==', 'or' and 'and'
+};
+//-------------------------------------------------------------
 
+//-------------------------------------------------------------
+CParser::CParser(void)
+{
 	m_ParsingFuncDecl = false;
 	m_FuncDeclAllowed = true;
 	m_ErrorCount = 0;
+	m_ParsedRoot = NULL;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+CParser::~CParser(void)
+{
+	DiscardParsedDecls();
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
-CTreeNode* CParser::ParseSourceFile(const string &InputFile)
+CTreeNode* CParser::ParseSourceFile(const string &InputFile, bool MapFile,
+                                    bool ParallelScan, bool TableDriven)
+{
+	if(!BeginSourceFile(InputFile, MapFile, ParallelScan, TableDriven))
+		return NULL;
+
+	//create our root parse tree node
+	CRootTreeNode *Root;
+	Root = (CRootTreeNode*)m_ParseTreeBuilder->BuildRootNode();
+
+	CTreeNode *Decl;
+
+	while(ParseGlobalDecl(Decl))
+	{
+		if(Decl)
+			Root->AddChild(Decl);
+	}
+
+	//don't return the parse tree if something went wrong
+	if(m_ErrorCount > 0)
+	{
+		Root->DestroyNode();
+		return NULL;
+	}
+
+	return Root;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+bool CParser::BeginSourceFile(const string &InputFile, bool MapFile,
+                              bool ParallelScan, bool TableDriven)
 {
 	//the scanner will report any errors about not being able to open the file
-	if(!m_LexScanner.SetInputFile(InputFile))
+	if(!m_LexScanner.SetInputFile(InputFile, MapFile, ParallelScan, TableDriven))
+		return false;
+
+	m_ParseTreeBuilder = CTreeNodeFactory::GetSingletonPtr();
+	m_SymTable = CSymbolTable::GetSingletonPtr();
+	return true;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+bool CParser::ParseGlobalDecl(CTreeNode *&Decl)
+{
+	Decl = NULL;
+
+	if(!m_LexScanner.HasMoreTokens())
+		return false;
+
+	//function decls can only appear at global scope
+	m_FuncDeclAllowed = true;
+
+	CTreeNode *Stmt = ParseStatement();
+
+	//we're only allowed function and var decls at global scope
+	if(Stmt)
+	{
+		if(Stmt->Code == TC_FUNCTIONDECL
+			 || Stmt->Code == TC_VARDECL
+			 || Stmt->Code == TC_ARRAYDECL)
+			Decl = Stmt;
+		else
+		{
+			Error("only variable and function declarations are allowed at global scope");
+			Stmt->DestroyNode();
+		}
+	}
+
+	return true;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+CTreeNode* CParser::ReparseSourceFile(const string &InputFile, bool TableDriven)
+{
+	size_t DamageStart;
+	size_t OldDamageEnd;
+	size_t NewDamageEnd;
+
+	if(!m_LexScanner.RescanInputFile(InputFile, TableDriven, DamageStart, 
+	                                 OldDamageEnd, NewDamageEnd))
 		return NULL;
 
 	m_ParseTreeBuilder = CTreeNodeFactory::GetSingletonPtr();
 	m_SymTable = CSymbolTable::GetSingletonPtr();
+	m_ErrorCount = 0;
+	m_ParsingFuncDecl = false;
+
+	//the root node is rebuilt each time, the declarations in it are 
+	//either reused or destroyed below
+	if(m_ParsedRoot)
+	{
+		for(unsigned int i = 0; i < m_ParsedRoot->GetNumChildren(); i++)
+			*m_ParsedRoot->GetChildPtr(i) = NULL;
+
+		m_ParsedRoot->DestroyNode();
+		m_ParsedRoot = NULL;
+	}
+
+	//find where each of the old declarations which weren't changed starts
+	//now, those after the changes will have moved along
+	vector<ParsedDecl_t> OldDecls;
+	OldDecls.swap(m_ParsedDecls);
+
+	vector<bool> DeclReused(OldDecls.size(), false);
+	map<size_t, size_t> ReusableDecls;
+
+	for(size_t i = 0; i < OldDecls.size(); ++i)
+	{
+		if(OldDecls[i].EndToken <= DamageStart)
+			ReusableDecls.insert(make_pair(OldDecls[i].FirstToken, i));
+		else if(OldDecls[i].FirstToken >= OldDamageEnd)
+		{
+			OldDecls[i].FirstToken += NewDamageEnd - OldDamageEnd;
+			OldDecls[i].EndToken += NewDamageEnd - OldDamageEnd;
+			ReusableDecls.insert(make_pair(OldDecls[i].FirstToken, i));
+		}
+	}
 
-	//create our root parse tree node
 	CRootTreeNode *Root;
 	Root = (CRootTreeNode*)m_ParseTreeBuilder->BuildRootNode();
 
-	while(m_LexScanner.HasMoreTokens())
+	//an internal error part way through leaves us without a usable tree, 
+	//start again from scratch next time rather than leak what we had
+	try
 	{
-		//function decls can only appear at global scope
-		m_FuncDeclAllowed = true;
-
-		CTreeNode *Stmt = ParseStatement();
+		unsigned int DeclsHash = 2166136261u;
 
-		//we're only allowed function and var decls at global scope
-		if(Stmt)
+		while(m_LexScanner.HasMoreTokens())
 		{
-			if(Stmt->Code == TC_FUNCTIONDECL
-				 || Stmt->Code == TC_VARDECL
-				 || Stmt->Code == TC_ARRAYDECL)
-			 Root->AddChild(Stmt);
-			else
+			size_t FirstToken = m_LexScanner.CurrentTokenIndex();
+			map<size_t, size_t>::iterator Reusable = ReusableDecls.find(FirstToken);
+
+			//reuse the old declaration if nothing before it has changed
+			if(Reusable != ReusableDecls.end() 
+			   && OldDecls[Reusable->second].PrecedingDeclsHash == DeclsHash)
+			{
+				ParsedDecl_t &Decl = OldDecls[Reusable->second];
+				DeclReused[Reusable->second] = true;
+
+				ReplayParsedDecl(Decl, FirstToken);
+				m_LexScanner.SeekToToken(Decl.EndToken);
+
+				Root->AddChild(Decl.Decl);
+				m_ParsedDecls.push_back(Decl);
+
+				DeclsHash = (DeclsHash ^ HashDeclInterface(Decl.Decl, Decl.FirstToken, 
+				                                           Decl.EndToken)) * 16777619u;
+				continue;
+			}
+
+			//otherwise parse it the same as ParseSourceFile
+			m_FuncDeclAllowed = true;
+			m_BuiltinsUsed.clear();
+
+			CTreeNode *Stmt = ParseStatement();
+
+			if(!Stmt)
+				continue;
+
+			if(Stmt->Code != TC_FUNCTIONDECL
+				 && Stmt->Code != TC_VARDECL
+				 && Stmt->Code != TC_ARRAYDECL)
 			{
 				Error("only variable and function declarations are allowed at global scope");
 				Stmt->DestroyNode();
 				continue;
 			}
+
+			Root->AddChild(Stmt);
+
+			//nothing's kept if there's been an error so don't bother with the rest
+			if(m_ErrorCount > 0)
+				continue;
+
+			//keep hold of it for next time
+			ParsedDecl_t NewDecl;
+			NewDecl.Decl = Stmt;
+			NewDecl.FirstToken = FirstToken;
+			NewDecl.EndToken = m_LexScanner.CurrentTokenIndex();
+			NewDecl.FirstLine = m_LexScanner.TokenLineNumber(FirstToken);
+			NewDecl.PrecedingDeclsHash = DeclsHash;
+			NewDecl.BuiltinsUsed = m_BuiltinsUsed;
+
+			Symbol_t *Sym = m_SymTable->LookupIdentifier(GetDeclName(Stmt), true);
+			SanityCheck(Sym);
+
+			NewDecl.SymName = Sym->Name;
+			NewDecl.SymLine = Sym->LineNo;
+			NewDecl.SymType = Sym->SymType;
+			m_ParsedDecls.push_back(NewDecl);
+
+			DeclsHash = (DeclsHash ^ HashDeclInterface(Stmt, NewDecl.FirstToken, 
+			                                           NewDecl.EndToken)) * 16777619u;
 		}
 	}
+	catch(...)
+	{
+		for(size_t i = 0; i < OldDecls.size(); ++i)
+		{
+			if(!DeclReused[i])
+				OldDecls[i].Decl->DestroyNode();
+		}
 
-	//don't return the parse tree if something went wrong
+		Root->DestroyNode();
+		m_ParsedDecls.clear();
+		m_ParsingFuncDecl = false;
+		throw;
+	}
+
+	//the old declarations which couldn't be reused aren't needed now
+	for(size_t i = 0; i < OldDecls.size(); ++i)
+	{
+		if(!DeclReused[i])
+			OldDecls[i].Decl->DestroyNode();
+	}
+
+	m_ParsedRoot = Root;
+
+	//don't return the parse tree if something went wrong, we'll have
+	//to parse everything again next time
 	if(m_ErrorCount > 0)
 	{
-		Root->DestroyNode();
+		DiscardParsedDecls();
 		return NULL;
 	}
 
@@ -94,6 +290,90 @@ CTreeNode* CParser::ParseSourceFile(const string &InputFile)
 }
 //-------------------------------------------------------------
 
+//-------------------------------------------------------------
+void CParser::ReplayParsedDecl(ParsedDecl_t &Decl, size_t FirstToken)
+{
+	//the declaration might have moved down or up the file
+	long NewFirstLine = m_LexScanner.TokenLineNumber(FirstToken);
+	Decl.SymLine += NewFirstLine - Decl.FirstLine;
+	Decl.FirstLine = NewFirstLine;
+
+	//there's only ever one global symbol for each name so this gives back 
+	//the same one the declaration and any uses of it were bound to last time
+	m_SymTable->AddSymbol(Decl.SymName, Decl.Decl, Decl.SymLine, Decl.SymType);
+
+	if(Decl.Decl->Code != TC_FUNCTIONDECL)
+		CGlobalDataStore::GetSingletonPtr()->AddGlobalVar(Decl.Decl);
+
+	for(size_t i = 0; i < Decl.BuiltinsUsed.size(); ++i)
+		CGlobalDataStore::GetSingletonPtr()->MarkBuiltinFunctionUsed(Decl.BuiltinsUsed[i]);
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+unsigned int CParser::HashDeclInterface(CTreeNode *Decl, size_t FirstToken, 
+                                        size_t EndToken)
+{
+	//for a variable or array anything in it could matter, such as it's 
+	//type or bounds, so take all of it's tokens into account
+	if(Decl->Code != TC_FUNCTIONDECL)
+		return m_LexScanner.HashTokens(FirstToken, EndToken);
+
+	//the body of a function can't affect anything after it, just it's
+	//name, return type and parameters
+	CFunctionDeclTreeNode *FnDecl = (CFunctionDeclTreeNode*)Decl;
+	CTreeNode *ParmList = FnDecl->GetChild(FUNC_DECL_PARM_LIST);
+
+	unsigned int Hash = 2166136261u;
+	Hash = (Hash ^ (unsigned int)CAtomTable::GetSingletonPtr()->Intern(FnDecl->Name)) * 16777619u;
+	Hash = (Hash ^ (unsigned int)FnDecl->RetType) * 16777619u;
+	Hash = (Hash ^ (unsigned int)FnDecl->NumParameters) * 16777619u;
+
+	for(unsigned int i = 0; i < ParmList->GetNumChildren(); i++)
+	{
+		CParameterDeclTreeNode *Parm = (CParameterDeclTreeNode*)ParmList->GetChild(i);
+		Hash = (Hash ^ (unsigned int)Parm->Type) * 16777619u;
+		Hash = (Hash ^ (unsigned int)Parm->IsConst) * 16777619u;
+	}
+
+	return Hash;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+const string& CParser::GetDeclName(CTreeNode *Decl)
+{
+	switch(Decl->Code)
+	{
+	case TC_FUNCTIONDECL:
+		return ((CFunctionDeclTreeNode*)Decl)->Name;
+
+	case TC_VARDECL:
+		return ((CVarDeclTreeNode*)Decl)->VarId->IdName;
+
+	case TC_ARRAYDECL:
+		{
+			CTreeNode *Var = ((CArrayDeclTreeNode*)Decl)->GetChild(ARR_DECL_VAR);
+			return ((CVarDeclTreeNode*)Var)->VarId->IdName;
+		}
+	}
+
+	InternalError("unexpected global declaration");
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CParser::DiscardParsedDecls(void)
+{
+	//the root holds every declaration so destroying it takes care of them
+	if(m_ParsedRoot)
+		m_ParsedRoot->DestroyNode();
+
+	m_ParsedRoot = NULL;
+	m_ParsedDecls.clear();
+}
+//-------------------------------------------------------------
+
 //-------------------------------------------------------------
 void CParser::Error(const string &Msg)
 {
@@ -268,8 +548,8 @@ CTreeNode* CParser::ParseVariableDeclaration(void)
 	if(!IsConstQualified && m_LexScanner.PeekNextToken().Type == TOKTYPE_SEMICOLON)
 	{
 		m_LexScanner.ClearPeekedTokens();
-		m_SymTable->AddSymbol(VarName, NewVarDecl, VarToken.LineNumber,
-			NewVarDecl->VarType);
+		NewVarDecl->VarId->Binding = m_SymTable->AddSymbol(VarName, NewVarDecl, 
+			VarToken.LineNumber, NewVarDecl->VarType);
 
 		if(m_SymTable->AtGlobalScope())
 			CGlobalDataStore::GetSingletonPtr()->AddGlobalVar(NewVarDecl);
@@ -335,8 +615,8 @@ CTreeNode* CParser::ParseVariableDeclaration(void)
 			return NULL;
 		}
 
-		m_SymTable->AddSymbol(VarName, NewVarDecl, VarToken.LineNumber,
-			NewVarDecl->VarType);
+		NewVarDecl->VarId->Binding = m_SymTable->AddSymbol(VarName, NewVarDecl, 
+			VarToken.LineNumber, NewVarDecl->VarType);
 
 		if(m_SymTable->AtGlobalScope())
 			CGlobalDataStore::GetSingletonPtr()->AddGlobalVar(NewVarDecl);
@@ -394,7 +674,7 @@ CTreeNode* CParser::ParseArrayDeclaration(CVarDeclTreeNode *Var)
 		return NULL;
 	}
 
-	m_SymTable->AddSymbol(Var->VarId->IdName, NewArrDecl,
+	Var->VarId->Binding = m_SymTable->AddSymbol(Var->VarId->IdName, NewArrDecl,
 		m_LexScanner.CurrentLineNumber(), Var->VarType);
 
 	if(m_SymTable->AtGlobalScope())
@@ -407,208 +687,87 @@ CTreeNode* CParser::ParseArrayDeclaration(CVarDeclTreeNode *Var)
 //-------------------------------------------------------------
 CTreeNode* CParser::ParseExpression(ExprContext Context)
 {
-	stack<TokenType> ExpOpStack;
-	stack<CTreeNode*> ExpValStack;
-	int ParenNestingLevel = 0;
-	CTreeNode *ExprTerm = NULL;
+	//determine which token to terminate based upon the context we're in
+	TokenType EndTokenType = CUtilFuncs::ConvertExprContextToTokenType(Context);
 
-	ExprTerm = ParseExpressionTerm(ExpOpStack, ParenNestingLevel);
-	if(!ExprTerm)
-	{
-		DestroyExpressionStack(ExpValStack);
-		return NULL;
-	}
-	else
-		ExpValStack.push(ExprTerm);
+	//parenthesised expressions are parsed as terms so all that's left 
+	//at this level is to combine the terms by operator binding power
+	return ParseBinaryExpression(1, EndTokenType);
+}
+//-------------------------------------------------------------
 
-	//get an operator
-	Token_t Token = m_LexScanner.PeekNextToken();
+//-------------------------------------------------------------
+CTreeNode* CParser::ParseBinaryExpression(int MinBindingPower, TokenType EndTokenType)
+{
+	CTreeNode *Lhs = ParseExpressionTerm();
 
-	//determine which token to terminate based upon the context we're in
-	TokenType EndTokenType = CUtilFuncs::ConvertExprContextToTokenType(Context);
+	if(!Lhs)
+		return NULL;
 
 	while(true)
 	{
-		//if the terminating token if a ')' we dont want to break out
-		//early on expressions such as ((6 + 4) * 2 + 1)
-		if(Token.Type == TOKTYPE_CLOSEPAREN
-		   && EndTokenType == TOKTYPE_CLOSEPAREN)
-		{
-			if(ParenNestingLevel == 0)
-				break;
-		}
-		else if(Token.Type == EndTokenType)
+		//get an operator
+		Token_t Token = m_LexScanner.PeekNextToken();
+
+		if(Token.Type == EndTokenType)
 			break;
 
-		if(!IsArithmeticOperator(Token.Type)
-		   && !IsBooleanOperator(Token.Type))
+		//handle cases like a = 5 * 3);
+		if(Token.Type == TOKTYPE_CLOSEPAREN)
 		{
-			Error("unexpected '" + Token.TokenValue + "'");
-			DestroyExpressionStack(ExpValStack);
+			Error("mismatched ')'");
+			Lhs->DestroyNode();
 			return NULL;
 		}
 
-		//if we've hit a closing parenthesis, evaluate the expression
-		//contained within it
-		if(Token.Type == TOKTYPE_CLOSEPAREN)
-		{
-			bool Mismatched = false;
-
-			//handle cases like a = 5 * 3);
-			if(!ParenNestingLevel)
-				Mismatched = true;
-			else
-			{
-				while(ExpOpStack.top() != TOKTYPE_OPENPAREN)
-				{
-					if(!ReduceExpression(ExpOpStack, ExpValStack))
-						return NULL;
-
-					if(ExpOpStack.empty())
-						Mismatched = true;
-				}
-			}
+		int BindingPower = ms_BindingPowers[Token.Type];
 
-			if(Mismatched)
-			{
-				Error("mismatched ')'");
-				DestroyExpressionStack(ExpValStack);
-				return NULL;
-			}
-
-			//pop the opening parenthesis
-			ExpOpStack.pop();
-			--ParenNestingLevel;
-			Token = m_LexScanner.GetNextToken();
-			continue;
-		}
-
-		//if the operator stack is empty, shift it, if it's not empty
-		//check the precedence level of the parsed operator and the one on top
-		//of the stack
-		if(ExpOpStack.empty()
-			 || Token.Type == TOKTYPE_OPENPAREN
-			 || (OperatorPrecedence(ExpOpStack.top()) < OperatorPrecedence(Token.Type)))
+		if(!BindingPower)
 		{
-			if(Token.Type == TOKTYPE_OPENPAREN)
-				++ParenNestingLevel;
-
-			ExpOpStack.push(Token.Type);
+			Error("unexpected '" + Token.TokenValue + "'");
+			Lhs->DestroyNode();
+			return NULL;
 		}
-		else
-		{
-			//keep reducing the expression until we find an operator of
-			//lesser precedence that the current operator or we've
-			//exhausted the stack
-			while(OperatorPrecedence(ExpOpStack.top()) >= OperatorPrecedence(Token.Type))
-			{
-				if(!ReduceExpression(ExpOpStack, ExpValStack))
-					return NULL;
-
-				if(ExpOpStack.empty())
-					break;
-			}
 
-			//shift the operator now
-			ExpOpStack.push(Token.Type);
-		}
+		//an operator which binds less tightly belongs to one of our callers, 
+		//they'll take what we've got so far as their right hand side
+		if(BindingPower < MinBindingPower)
+			break;
 
 		m_LexScanner.ClearPeekedTokens();
 
-		//parse the RHS of the expression
-		ExprTerm = ParseExpressionTerm(ExpOpStack, ParenNestingLevel);
-		if(!ExprTerm)
+		//anything binding more tightly than this operator is part of it's right
+		//hand side, operators of the same power are left associative so we get 
+		//them on the next time round
+		CTreeNode *Rhs = ParseBinaryExpression(BindingPower + 1, EndTokenType);
+
+		if(!Rhs)
 		{
-			DestroyExpressionStack(ExpValStack);
+			Lhs->DestroyNode();
 			return NULL;
 		}
-		else
-			ExpValStack.push(ExprTerm);
-
-		Token = m_LexScanner.PeekNextToken();
-	}
-
-	//keep reducing the parsed expression until we reach the end
-	while(ExpValStack.size() != 1)
-	{
-		if(!ReduceExpression(ExpOpStack, ExpValStack))
-			return NULL;
-	}
-
-	//detect cases like "(5 * 3"
-	if(ParenNestingLevel)
-	{
-		Error("mismatched '('");
-		DestroyExpressionStack(ExpValStack);
-		return NULL;
-	}
-
-	return ExpValStack.top();
-}
-//-------------------------------------------------------------
-
-//-------------------------------------------------------------
-bool CParser::ReduceExpression(stack<TokenType> &OpStack,
-															 stack<CTreeNode*> &ValStack)
-{
-	//sanity check: make sure we have 2 operands and an operator at least
-	SanityCheck(ValStack.size() >= 2);
-	SanityCheck(OpStack.size() >= 1);
-
-	//pop the RHS and LHS of the expression
-	CTreeNode *Rhs = ValStack.top();
-	ValStack.pop();
-
-	CTreeNode *Lhs = ValStack.top();
-	ValStack.pop();
-
-	//pop the operator
-	TokenType Op = OpStack.top();
-	OpStack.pop();
 
-	//we should never be seeing an opening parenthesis
-	if(Op == TOKTYPE_OPENPAREN)
-	{
-		Error("mismatched opening parenthesis");
-		DestroyExpressionStack(ValStack);
-		return false;
+		if(IsArithmeticOperator(Token.Type))
+		{
+			CArithExprTreeNode *ArithExpr;
+			ArithExpr = (CArithExprTreeNode*)m_ParseTreeBuilder->BuildArithExpression(
+				Lhs, Rhs, Token.Type);
+
+			//since arithmetic operators are left associative, the result of the
+			//expression must be of a type compatible with the LHS of the operator
+			ArithExpr->ExprType = ExtractTypeFromGenericExpr(Lhs);
+			Lhs = ArithExpr;
+		}
+		else
+			Lhs = m_ParseTreeBuilder->BuildBooleanExpression(Lhs, Rhs, Token.Type);
 	}
 
-	//push the new node represting this expression back onto the stack
-	if(IsArithmeticOperator(Op))
-		ValStack.push(m_ParseTreeBuilder->BuildArithExpression(Lhs, Rhs, Op));
-	else
-		ValStack.push(m_ParseTreeBuilder->BuildBooleanExpression(Lhs, Rhs, Op));
-	return true;
+	return Lhs;
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
-int CParser::OperatorPrecedence(TokenType Op)
-{
-	map<TokenType, int>::iterator itr = m_OpPrecs.find(Op);
-
-	if(itr == m_OpPrecs.end())
-		InternalError("unknown operator precedence");
-
-	return itr->second;
-}
-//-------------------------------------------------------------
-
-//-------------------------------------------------------------
-void CParser::DestroyExpressionStack(stack<CTreeNode*> &ValStack)
-{
-	//clean up values
-	while(!ValStack.empty())
-	{
-	  ValStack.top()->DestroyNode();
-	  ValStack.pop();
-	}
-}
-//-------------------------------------------------------------
-
-//-------------------------------------------------------------
-CTreeNode* CParser::ParseExpressionTerm(stack<TokenType> &OpStack, int &ParenLevel)
+CTreeNode* CParser::ParseExpressionTerm(void)
 {
 	Token_t Token = m_LexScanner.GetNextToken();
 
@@ -628,7 +787,14 @@ CTreeNode* CParser::ParseExpressionTerm(stack<TokenType> &OpStack, int &ParenLev
 		{
 		case TC_PARMDECL:
 		case TC_VARDECL:
-				return m_ParseTreeBuilder->BuildIdentifier(Token.TokenValue);
+			{
+				CIdentifierTreeNode *Id;
+				Id = (CIdentifierTreeNode*)m_ParseTreeBuilder->BuildIdentifier(Token.TokenValue);
+				Id->ExprType = ExtractTypeFromGenericExpr(IdSym->IdPtr);
+				Id->Binding = IdSym;
+
+				return Id;
+			}
 
 		case TC_ARRAYDECL:
 			{
@@ -647,7 +813,11 @@ CTreeNode* CParser::ParseExpressionTerm(stack<TokenType> &OpStack, int &ParenLev
 					return NULL;
 				}
 
-				return m_ParseTreeBuilder->BuildArrayRef(ArrRef, Token.TokenValue, IdSym->SymType);
+				CIdentifierTreeNode *ArrName;
+				ArrName = (CIdentifierTreeNode*)m_ParseTreeBuilder->BuildIdentifier(Token.TokenValue);
+				ArrName->Binding = IdSym;
+
+				return m_ParseTreeBuilder->BuildArrayRef(ArrRef, ArrName, IdSym->SymType);
 			}
 
 		case TC_FUNCTIONDECL:
@@ -700,13 +870,17 @@ CTreeNode* CParser::ParseExpressionTerm(stack<TokenType> &OpStack, int &ParenLev
 		{
 			//we've actually got a unary expression of the form "op expr" so
 			//parse the expression term  here
-			Expr = ParseExpressionTerm(OpStack, ParenLevel);
+			Expr = ParseExpressionTerm();
 		}
 
 		if(!Expr)
 			return NULL;
 
-		return m_ParseTreeBuilder->BuildUnaryExpression(Expr, Token.Type);
+		CUnaryExprTreeNode *UnExpr;
+		UnExpr = (CUnaryExprTreeNode*)m_ParseTreeBuilder->BuildUnaryExpression(Expr, Token.Type);
+		UnExpr->ExprType = ExtractTypeFromGenericExpr(Expr);
+
+		return UnExpr;
 	}
 	else
 		Error("syntax error '" + Token.TokenValue + "'");
@@ -822,12 +996,9 @@ CTreeNode* CParser::ParseIfStatement(void)
 	}
 
 	//handle cases where there's no body to the if statement
-	Token_t EndIfTok = m_LexScanner.GetNextToken();
-
-	if(EndIfTok.Type != TOKTYPE_ENDIF)
+	if(m_LexScanner.PeekTokenType() != TOKTYPE_ENDIF)
 	{
 		m_SymTable->PushNewSymbolScope();
-		m_LexScanner.PushbackToken(EndIfTok);
 
 		//parse the body, to begin with we're adding statements to
 		//the 'if' part until we see an 'else' clause, at which point we
@@ -847,14 +1018,18 @@ CTreeNode* CParser::ParseIfStatement(void)
 			}
 
 			//see if we've reached the end of the statement
-			Token_t EndTok = m_LexScanner.GetNextToken();
-			if(EndTok.Type == TOKTYPE_ENDIF)
+			TokenType EndTokType = m_LexScanner.PeekTokenType();
+			if(EndTokType == TOKTYPE_ENDIF)
+			{
+				m_LexScanner.GetNextToken();
 				break;
+			}
 
 			//check for an else clause, if we find one then start
 			//adding statements to the else portion of the body
-			if(EndTok.Type == TOKTYPE_ELSE)
+			if(EndTokType == TOKTYPE_ELSE)
 			{
+				m_LexScanner.GetNextToken();
 				AddingToElse = true;
 
 				//stop adding symbols to the 'then' part and start adding them to a new
@@ -877,8 +1052,7 @@ CTreeNode* CParser::ParseIfStatement(void)
 			}
 
 			//the token we've just peeked at is the beginning of another
-			//statement so push it back to enable parsing to continue
-			m_LexScanner.PushbackToken(EndTok);
+			//statement so leave it where it is to enable parsing to continue
 		}
 
 		m_SymTable->PopSymbolScope();
@@ -890,6 +1064,7 @@ CTreeNode* CParser::ParseIfStatement(void)
 		// end_if
 		//
 		// no point in keeping this around since we can safely delete it
+		m_LexScanner.GetNextToken();
 		Warning("empty 'if' statement found");
 
 		//destroy the if stmt node so it doesn't get added to the IR
@@ -942,7 +1117,11 @@ CTreeNode* CParser::ParseAssignmentStatement(const string &IdentifierName)
 				return NULL;
 			}
 
-			AssignExprLhs = m_ParseTreeBuilder->BuildArrayRef(ArrIdx, IdSym->Name, 
+			CIdentifierTreeNode *ArrName;
+			ArrName = (CIdentifierTreeNode*)m_ParseTreeBuilder->BuildIdentifier(IdSym->NameAtom);
+			ArrName->Binding = IdSym;
+
+			AssignExprLhs = m_ParseTreeBuilder->BuildArrayRef(ArrIdx, ArrName, 
 				IdSym->SymType);
 		}
 	}
@@ -961,7 +1140,11 @@ CTreeNode* CParser::ParseAssignmentStatement(const string &IdentifierName)
 			ErrOccurred = true;
 		}
 
-		AssignExprLhs = m_ParseTreeBuilder->BuildIdentifier(IdSym->Name);
+		CIdentifierTreeNode *Id;
+		Id = (CIdentifierTreeNode*)m_ParseTreeBuilder->BuildIdentifier(IdSym->Name);
+		Id->ExprType = ((CVarDeclTreeNode*)IdSym->IdPtr)->VarType;
+		Id->Binding = IdSym;
+		AssignExprLhs = Id;
 	}
 	else if(IdSym->IdPtr->Code == TC_PARMDECL)
 	{
@@ -1078,12 +1261,9 @@ CTreeNode* CParser::ParseWhileStatement(void)
 	}
 
 	//handle cases where there's no body to the statement
-	Token_t EndWhileTok = m_LexScanner.GetNextToken();
-
-	if(EndWhileTok.Type != TOKTYPE_END_WHILE)
+	if(m_LexScanner.PeekTokenType() != TOKTYPE_END_WHILE)
 	{
 		m_SymTable->PushNewSymbolScope();
-		m_LexScanner.PushbackToken(EndWhileTok);
 
 		//parse the body
 		while(true)
@@ -1093,10 +1273,9 @@ CTreeNode* CParser::ParseWhileStatement(void)
 			if(Stmt)
 				WhileStmt->AddChild(Stmt);
 
-			Token_t EndTok = m_LexScanner.GetNextToken();
-			if(EndTok.Type == TOKTYPE_END_WHILE)
+			if(m_LexScanner.PeekTokenType() == TOKTYPE_END_WHILE)
 			{
-
+				m_LexScanner.GetNextToken();
 				m_LexScanner.ClearPeekedTokens();
 				break;
 			}
@@ -1109,8 +1288,6 @@ CTreeNode* CParser::ParseWhileStatement(void)
 				m_SymTable->PopSymbolScope();
 				return NULL;
 			}
-
-			m_LexScanner.PushbackToken(EndTok);
 		}
 
 		m_SymTable->PopSymbolScope();
@@ -1122,6 +1299,7 @@ CTreeNode* CParser::ParseWhileStatement(void)
 		// end_while
 		//
 		// no point in keeping this around since we can safely delete it
+		m_LexScanner.GetNextToken();
 		Warning("empty 'while' statement found");
 
 		//destroy the while stmt node so it doesn't get added to the IR
@@ -1205,12 +1383,13 @@ CTreeNode* CParser::ParseFunctionDecl(void)
 	}
 
 	//build the function decl
-	CTreeNode *FnDeclNode = m_ParseTreeBuilder->BuildFunctionDecl(FunctionName,
-																	NumParms, ParmList, RetType);
+	CFunctionDeclTreeNode *FnDeclNode;
+	FnDeclNode = (CFunctionDeclTreeNode*)m_ParseTreeBuilder->BuildFunctionDecl(
+		FunctionName, NumParms, ParmList, RetType);
 	m_CurrFuncDecl = FnDeclNode;
 
 	//add the function name to the global namespace and push a new scope
-	m_SymTable->AddSymbol(FunctionName, FnDeclNode,
+	FnDeclNode->Binding = m_SymTable->AddSymbol(FunctionName, FnDeclNode,
 		m_LexScanner.CurrentLineNumber(), RetType);
 	m_SymTable->PushNewSymbolScope();
 
@@ -1223,21 +1402,18 @@ CTreeNode* CParser::ParseFunctionDecl(void)
 	}
 
 	//handle cases where the function is empty
-	Token_t EndTok = m_LexScanner.GetNextToken();
 	bool FoundGlobalRetStmt = false;
 	m_FoundNestedRetStmt = false;
 
-	if(EndTok.Type != TOKTYPE_END_FUNCTION)
+	if(m_LexScanner.PeekTokenType() != TOKTYPE_END_FUNCTION)
 	{
-		m_LexScanner.PushbackToken(EndTok);
-
 		//parse the function body
 		while(true)
 		{
 			CTreeNode *Stmt = ParseStatement();
 
 			if(Stmt)
-				FnDeclNode->AddChild(Stmt);
+				FnDeclNode->AddStmt(Stmt);
 
 			if(Stmt && Stmt->Code == TC_RETURNSTMT)
 			{
@@ -1259,9 +1435,9 @@ CTreeNode* CParser::ParseFunctionDecl(void)
 				FoundGlobalRetStmt = true;
 			}
 
-			Token_t EndTok = m_LexScanner.GetNextToken();
-			if(EndTok.Type == TOKTYPE_END_FUNCTION)
+			if(m_LexScanner.PeekTokenType() == TOKTYPE_END_FUNCTION)
 			{
+				m_LexScanner.GetNextToken();
 				m_LexScanner.ClearPeekedTokens();
 				break;
 			}
@@ -1278,8 +1454,6 @@ CTreeNode* CParser::ParseFunctionDecl(void)
 				m_CurrFuncDecl = NULL;
 				return NULL;
 			}
-
-			m_LexScanner.PushbackToken(EndTok);
 		}
 
 		//see if we're supposed to have a return statement but dont
@@ -1288,7 +1462,10 @@ CTreeNode* CParser::ParseFunctionDecl(void)
 			Error("function '" + FunctionName + "' missing 'return' statement");
 	}
 	else
+	{
+		m_LexScanner.GetNextToken();
 		Error("function '" + FunctionName + "' with no body");
+	}
 
 	m_SymTable->PopSymbolScope();
 	m_ParsingFuncDecl = false;
@@ -1458,7 +1635,10 @@ CTreeNode *CParser::ParseFunctionCall(const string &FuncName,
 
 	//build our call_expr node
 	CFunctionDeclTreeNode *FnDecl = (CFunctionDeclTreeNode*)IdSym->IdPtr;
-	CTreeNode *CallExprNode = m_ParseTreeBuilder->BuildCallExpr(FuncName);
+	CCallExprTreeNode *CallExprNode;
+	CallExprNode = (CCallExprTreeNode*)m_ParseTreeBuilder->BuildCallExpr(FuncName);
+	CallExprNode->ExprType = FnDecl->RetType;
+	CallExprNode->Binding = IdSym;
 
 	//if we've got a closing parenthesis next, check to see if the function
 	//we're calling was declared with parameters or not
@@ -1583,7 +1763,10 @@ CTreeNode *CParser::ParseFunctionCall(const string &FuncName,
 
 	//if it's a call to a builtin function, mark it used
 	if(CBuiltinFuncMngr::GetSingletonPtr()->IsBuiltinFunction(FuncName))
+	{
 		CGlobalDataStore::GetSingletonPtr()->MarkBuiltinFunctionUsed(FuncName);
+		m_BuiltinsUsed.push_back(FuncName);
+	}
 
 	return CallExprNode;
 }
@@ -1627,21 +1810,15 @@ bool CParser::TypeCheckExpression(CTreeNode *Expr, TokenType RequiredType)
 	}
 	else if(Expr->Code == TC_ARRAY_REF)
 	{
-		//get the type of the array
+		//the array's type was recorded when the reference was built
 		CArrayRefTreeNode *Ref = (CArrayRefTreeNode*)Expr;
-		Symbol_t *Sym = CSymbolTable::GetSingletonPtr()->LookupIdentifier(
-			Ref->ArrName->IdName, false);
-
-		SanityCheck(Sym);
-		CArrayDeclTreeNode *ArrDecl = (CArrayDeclTreeNode*)Sym->IdPtr;
-		CVarDeclTreeNode *Var = (CVarDeclTreeNode*)ArrDecl->GetChild(ARR_DECL_VAR);
 
 		//check to see if it matches
-		if(TypesCompatible(RequiredType, Var->VarType)
-			 || TypeConvertsTo(RequiredType, Var->VarType))
+		if(TypesCompatible(RequiredType, Ref->ArrType)
+			 || TypeConvertsTo(RequiredType, Ref->ArrType))
 		 return true;
 		else
-			FromType = Var->VarType;
+			FromType = Ref->ArrType;
 	}
 	else if(Expr->Code == TC_ARITH_EXPR)
 	{
@@ -1815,27 +1992,28 @@ TokenType CParser::ExtractTypeFromGenericExpr(CTreeNode *Expr)
 {
 	SanityCheck(Expr);
 
-	//we've got an unknown type of tree forming an expression,
-	//find out what type it is and return the underlying type for it
+	//we've got an unknown type of tree forming an expression, find out what
+	//type it is and return the underlying type for it. Expressions have their
+	//types filled in as they're built so there's no need to look any further
 	switch(Expr->Code)
 	{
 	case TC_IDENTIFIER:
-		return ExtractTypeFromIdentifier((CIdentifierTreeNode*)Expr);
+		return ((CIdentifierTreeNode*)Expr)->ExprType;
 
 	case TC_ARRAY_REF:
-		return ExtractTypeFromArrayRef((CArrayRefTreeNode*)Expr);
+		return ((CArrayRefTreeNode*)Expr)->ArrType;
 
 	case TC_CALLEXPR:
-		return ExtractTypeFromCallExpr((CCallExprTreeNode*)Expr);
+		return ((CCallExprTreeNode*)Expr)->ExprType;
 
 	case TC_LITERAL:
 		return ((CLiteralTreeNode*)Expr)->LitType;
 
 	case TC_ARITH_EXPR:
-		return ExtractTypeFromArithExpr((CArithExprTreeNode*)Expr);
+		return ((CArithExprTreeNode*)Expr)->ExprType;
 
 	case TC_UNARY_EXPR:
-		return ExtractTypeFromGenericExpr(Expr->GetChild(UNARY_EXPR_EXPR));
+		return ((CUnaryExprTreeNode*)Expr)->ExprType;
 
 	case TC_FUNCTIONDECL:
 		return ((CFunctionDeclTreeNode*)Expr)->RetType;
@@ -1855,68 +2033,6 @@ TokenType CParser::ExtractTypeFromGenericExpr(CTreeNode *Expr)
 }
 //-------------------------------------------------------------
 
-//-------------------------------------------------------------
-TokenType CParser::ExtractTypeFromArrayRef(CArrayRefTreeNode *ArrRef)
-{
-	//get the array decl
-	Symbol_t *ArrSym = m_SymTable->LookupIdentifier(ArrRef->ArrName->IdName, false);
-	SanityCheck(ArrSym);
-
-	//return the type
-	CVarDeclTreeNode *ArrDecl = (CVarDeclTreeNode*)ArrSym->IdPtr->GetChild(
-		ARR_DECL_VAR);
-	return ArrDecl->VarType;
-}
-//-------------------------------------------------------------
-
-//-------------------------------------------------------------
-TokenType CParser::ExtractTypeFromIdentifier(CIdentifierTreeNode *Ident)
-{
-	Symbol_t *IdSym = m_SymTable->LookupIdentifier(Ident->IdName, false);
-	SanityCheck(IdSym);
-
-	//get the underlying type of the decl
-	if(IdSym->IdPtr->Code == TC_VARDECL)
-		return ((CVarDeclTreeNode*)IdSym->IdPtr)->VarType;
-
-	//we must have a parm decl
-	SanityCheck(IdSym->IdPtr->Code == TC_PARMDECL);
-	return ((CParameterDeclTreeNode*)IdSym->IdPtr)->Type;
-}
-//-------------------------------------------------------------
-
-//-------------------------------------------------------------
-TokenType CParser::ExtractTypeFromCallExpr(CCallExprTreeNode *CallExpr)
-{
-	//the type of a call_expr node is actually the return type
-	//of the function being called so lookup the function name to
-	//get a pointer to the fn decl
-	Symbol_t *CallSym = m_SymTable->LookupIdentifier(CallExpr->FuncName, false);
-	SanityCheck(CallSym);
-
-	//extract the function's return type
-	CFunctionDeclTreeNode *FnDecl = (CFunctionDeclTreeNode*)CallSym->IdPtr;
-	return FnDecl->RetType;
-}
-//-------------------------------------------------------------
-
-//-------------------------------------------------------------
-TokenType CParser::ExtractTypeFromArithExpr(CArithExprTreeNode *Expr)
-{
-	//if we've got a binary operator for this expr, the type of the
-	//whole (sub)expression is Boolean
-	if(IsBooleanOperator(Expr->Operator))
-		return TOKTYPE_BOOLEANTYPE;
-
-	//must have an arithmetic expression
-	SanityCheck(IsArithmeticOperator(Expr->Operator));
-
-	//since arithmetic operators are left associative, the result of the
-	//expression must be of a type compatible with the LHS of the operator
-	return ExtractTypeFromGenericExpr(Expr->GetChild(ARITH_EXPR_LHS));
-}
-//-------------------------------------------------------------
-
 //-------------------------------------------------------------
 bool CParser::TypeCheckParameter(CTreeNode *Parm, CTreeNode *FnDecl,
 																 CTreeNode *CallExpr, unsigned int ParmId)
@@ -2011,7 +2127,7 @@ bool CParser::ValidateLogicalBlnExprOperands(CTreeNode *Expr)
 				CIdentifierTreeNode *IdNode;
 				IdNode = (CIdentifierTreeNode*)Expr;
 
-				Symbol_t *IdSym = m_SymTable->LookupIdentifier(IdNode->IdName, false);
+				Symbol_t *IdSym = m_SymTable->LookupIdentifier(IdNode->IdAtom, false);
 				SanityCheck(IdSym);
 
 				//get the type and check it's ok
@@ -2059,7 +2175,7 @@ bool CParser::ValidateRelationalBlnExprOperands(CTreeNode *Expr)
 				CIdentifierTreeNode *IdNode;
 				IdNode = (CIdentifierTreeNode*)Expr;
 
-				Symbol_t *IdSym = m_SymTable->LookupIdentifier(IdNode->IdName, false);
+				Symbol_t *IdSym = m_SymTable->LookupIdentifier(IdNode->IdAtom, false);
 				SanityCheck(IdSym);
 
 				//get the type and check it's ok
@@ -2087,7 +2203,7 @@ bool CParser::ValidateRelationalBlnExprOperands(CTreeNode *Expr)
 			{
 				//look up the array
 				Symbol_t *ArrSym = CSymbolTable::GetSingletonPtr()->LookupIdentifier(
-					((CArrayRefTreeNode*)Expr)->ArrName->IdName, false);
+					((CArrayRefTreeNode*)Expr)->ArrName->IdAtom, false);
 				SanityCheck(ArrSym);
 
 				//get the underlying var decl
@@ -2118,7 +2234,7 @@ bool CParser::AddFunctionParmsToSymbolTable(CTreeNode *ParmList)
 		ParmId = (CIdentifierTreeNode*)ParmDecl->GetChild(PARM_DECL_ID);
 
 		//see if this parameter is ambiguous
-		Symbol_t *ParmSym = m_SymTable->LookupIdentifier(ParmId->IdName, true);
+		Symbol_t *ParmSym = m_SymTable->LookupIdentifier(ParmId->IdAtom, true);
 
 		if(ParmSym)
 		{
@@ -2129,7 +2245,7 @@ bool CParser::AddFunctionParmsToSymbolTable(CTreeNode *ParmList)
 			return false;
 		}
 		else
-			m_SymTable->AddSymbol(ParmId->IdName, ParmDecl,
+			ParmId->Binding = m_SymTable->AddSymbol(ParmId->IdName, ParmDecl,
 				m_LexScanner.CurrentLineNumber(), ParmDecl->Type);
 	}
 
@@ -10,55 +10,100 @@
 //-------------------------------------------------------------
 CSymbolTable::CSymbolTable(void)
 {
-	m_CurrentScope = new Scope_t();
-	m_CurrentScope->ParentScope = NULL;
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
 CSymbolTable::~CSymbolTable(void)
 {
-	delete m_CurrentScope;
-	m_CurrentScope = NULL;
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
 void CSymbolTable::PushNewSymbolScope(void)
 {
-	Scope_t *NewScope = new Scope_t();
-	NewScope->ParentScope = m_CurrentScope;
-	m_CurrentScope = NewScope;
+	//remember where this scope's symbols will start so they
+	//can be undone when it's popped
+	m_ScopeStarts.push_back(m_InScope.size());
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
 void CSymbolTable::PopSymbolScope(void)
 {
-	//create a copy of the current scope pointer so we
-	//can delete it then move back up one level
-	Scope_t *Temp = m_CurrentScope;
-	m_CurrentScope = m_CurrentScope->ParentScope;
-
 	//we should never be trying to pop the global scope
-	SanityCheck(m_CurrentScope);
+	SanityCheck(!m_ScopeStarts.empty());
+
+	size_t ScopeStart = m_ScopeStarts.back();
+	m_ScopeStarts.pop_back();
 
-	delete Temp;
+	//undo each symbol added in this scope, newest first, bringing
+	//back whatever it was shadowing in an enclosing scope
+	while(m_InScope.size() > ScopeStart)
+	{
+		m_Visible[m_InScope.back()->NameAtom] = m_Shadowed.back();
+		m_InScope.pop_back();
+		m_Shadowed.pop_back();
+	}
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
-void CSymbolTable::AddSymbol(const string &Name, CTreeNode *Ptr,
-														 int LineNo, TokenType Type)
+Symbol_t* CSymbolTable::AddSymbol(const string &Name, CTreeNode *Ptr,
+																	int LineNo, TokenType Type)
 {
-	Symbol_t NewSym;
-	NewSym.IdPtr = Ptr;
-	NewSym.LineNo = LineNo;
-	NewSym.SymType = Type;
-	NewSym.Name = Name;
+	Atom NameAtom = CAtomTable::GetSingletonPtr()->Intern(Name);
+
+	if(NameAtom >= (Atom)m_Visible.size())
+	{
+		m_Visible.resize(NameAtom + 1, NULL);
+		m_Globals.resize(NameAtom + 1, NULL);
+	}
+
+	//a second symbol with the same name in the same scope doesn't
+	//replace the first
+	Symbol_t *Shadowed = m_Visible[NameAtom];
+	int ScopeDepth = (int)m_ScopeStarts.size();
+
+	if(Shadowed && Shadowed->ScopeDepth == ScopeDepth)
+		return Shadowed;
+
+	//reuse the global symbol for this name if there's been one before, trees
+	//from an earlier compile that were bound to it then see the new declaration
+	Symbol_t *NewSym;
+
+	if(ScopeDepth == 0 && m_Globals[NameAtom])
+		NewSym = m_Globals[NameAtom];
+	else
+	{
+		m_Symbols.push_back(Symbol_t());
+		NewSym = &m_Symbols.back();
+
+		if(ScopeDepth == 0)
+			m_Globals[NameAtom] = NewSym;
+	}
+
+	NewSym->IdPtr = Ptr;
+	NewSym->LineNo = LineNo;
+	NewSym->SymType = Type;
+	NewSym->Name = Name;
+	NewSym->NameAtom = NameAtom;
+	NewSym->ScopeDepth = ScopeDepth;
 
 	//insert the symbol into the current scope
-	m_CurrentScope->Symbols.insert(make_pair(Name, NewSym));
+	m_InScope.push_back(NewSym);
+	m_Shadowed.push_back(Shadowed);
+	m_Visible[NameAtom] = NewSym;
+
+	return NewSym;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+Symbol_t* CSymbolTable::RestoreSymbol(const Symbol_t &Sym)
+{
+	m_Symbols.push_back(Sym);
+	return &m_Symbols.back();
 }
 //-------------------------------------------------------------
 
@@ -66,55 +111,50 @@ void CSymbolTable::AddSymbol(const string &Name, CTreeNode *Ptr,
 Symbol_t* CSymbolTable::LookupIdentifier(const string &Identifier, 
 																				 bool LocalScopeOnly)
 {
-	//lookup the symbol in the current scope, if it's not there search
-  //the parent scopes for it back up the global scope
-	SymbolTableMap::iterator itr = m_CurrentScope->Symbols.find(Identifier);
+	//a name that's never been interned can't have been declared
+	Atom IdAtom = CAtomTable::GetSingletonPtr()->FindAtom(Identifier);
 
-	if(itr == m_CurrentScope->Symbols.end())
-	{
-		//see if we're allowed to search the parent scopes for the symbol
-		if(LocalScopeOnly)
-			return NULL;
+	if(IdAtom == NULL_ATOM)
+		return NULL;
 
-		//create a copy of the current scope so we don't affect
-		//where we are in the scope list
-		Scope_t *TempScope = m_CurrentScope->ParentScope;
+	return LookupIdentifier(IdAtom, LocalScopeOnly);
+}
+//-------------------------------------------------------------
 
-		while(TempScope)
-		{
-			//look for the symbol in this scope
-			itr = TempScope->Symbols.find(Identifier);
+//-------------------------------------------------------------
+Symbol_t* CSymbolTable::LookupIdentifier(Atom Identifier, bool LocalScopeOnly)
+{
+	//names interned since the last symbol was added can't have been declared
+	if(Identifier < 0 || Identifier >= (Atom)m_Visible.size())
+		return NULL;
 
-			if(itr != TempScope->Symbols.end())
-				return &itr->second;
+	//the innermost declaration is always the visible one, it only
+	//counts for a local lookup if it was made in the current scope
+	Symbol_t *Sym = m_Visible[Identifier];
 
-			TempScope = TempScope->ParentScope;
-		}
-	}
-	else
-		return &itr->second;
+	if(Sym && LocalScopeOnly && Sym->ScopeDepth != (int)m_ScopeStarts.size())
+		return NULL;
 
-	//not found in any scope
-	return NULL;
+	return Sym;
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
 void CSymbolTable::Reset(void)
 {
-	//destroy any nested scopes until we reach the global scope
-	while(m_CurrentScope->ParentScope)
-		PopSymbolScope();
-
-	//clear out any global symbols
-	m_CurrentScope->Symbols.clear();
+	//close every scope, including the global one. The symbols stay
+	//where they are for anything that's still bound to them
+	m_Visible.assign(m_Visible.size(), NULL);
+	m_InScope.clear();
+	m_Shadowed.clear();
+	m_ScopeStarts.clear();
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
 bool CSymbolTable::AtGlobalScope(void)
 {
-	return m_CurrentScope->ParentScope == NULL;
+	return m_ScopeStarts.empty();
 }
 //-------------------------------------------------------------
 
@@ -26,14 +26,110 @@
 #include "CGotoExprTreeNode.h"
 #include "CLiteralRefTreeNode.h"
 
+//-------------------------------------------------------------
+template<typename T>
+T* CTreeNodeFactory::NewNode(void)
+{
+	CMemoryArena *Arena = GetCurrentArena();
+	T *NewTreeNode;
+
+	//the node constructors are only accessible to us so we have
+	//to construct it in the arena's memory ourselves
+	if(Arena)
+		NewTreeNode = new(Arena->Allocate(sizeof(T), &DestroyArenaNode<T>)) T();
+	else
+		NewTreeNode = new T();
+
+	NewTreeNode->Arena = m_CurrArena;
+	return NewTreeNode;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+template<typename T>
+void CTreeNodeFactory::DestroyArenaNode(void *Node)
+{
+	//the derived destructors are private, go through the virtual one
+	CTreeNode *TreeNode = (T*)Node;
+	TreeNode->~CTreeNode();
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CTreeNodeFactory::UseNodeArena(NodeArena Arena)
+{
+	SanityCheck(Arena == NA_HEAP || Arena == NA_PARSE_TREE || Arena == NA_MIR);
+	m_CurrArena = Arena;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+NodeArena CTreeNodeFactory::GetNodeArena(void)
+{
+	return m_CurrArena;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CTreeNodeFactory::ReleaseNodeArena(NodeArena Arena)
+{
+	switch(Arena)
+	{
+	case NA_PARSE_TREE:
+		m_ParseTreeArena.Release();
+		break;
+
+	case NA_MIR:
+		m_MirArena.Release();
+		break;
+
+	default:
+		InternalError("only an arena can be released");
+	}
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+CMemoryArena* CTreeNodeFactory::GetCurrentArena(void)
+{
+	switch(m_CurrArena)
+	{
+	case NA_PARSE_TREE:
+		return &m_ParseTreeArena;
+
+	case NA_MIR:
+		return &m_MirArena;
+
+	default:
+		return NULL;
+	}
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+bool CTreeNodeFactory::CanShareNode(CTreeNode *Node)
+{
+	return Node->Arena != NA_HEAP && Node->Arena == m_CurrArena;
+}
+//-------------------------------------------------------------
 
 //-------------------------------------------------------------
 CTreeNode* CTreeNodeFactory::BuildIdentifier(const string &Name)
 {
-	CIdentifierTreeNode *NewIdNode = new CIdentifierTreeNode();
+	return BuildIdentifier(CAtomTable::GetSingletonPtr()->Intern(Name));
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+CTreeNode* CTreeNodeFactory::BuildIdentifier(Atom Name)
+{
+	CIdentifierTreeNode *NewIdNode = NewNode<CIdentifierTreeNode>();
 
 	NewIdNode->Code = TC_IDENTIFIER;
-	NewIdNode->IdName = Name;
+	NewIdNode->IdName = CAtomTable::GetSingletonPtr()->GetName(Name);
+	NewIdNode->IdAtom = Name;
+	NewIdNode->ExprType = TOKTYPE_VOID;
+	NewIdNode->Binding = NULL;
 
 	return NewIdNode;
 }
@@ -43,7 +139,7 @@ CTreeNode* CTreeNodeFactory::BuildIdentifier(const string &Name)
 CTreeNode* CTreeNodeFactory::BuildVarDecl(const string &Name,
 																					bool IsConst, TokenType VarType)
 {
-	CVarDeclTreeNode *VarDeclNode = new CVarDeclTreeNode();
+	CVarDeclTreeNode *VarDeclNode = NewNode<CVarDeclTreeNode>();
 
 	VarDeclNode->Code = TC_VARDECL;
 	VarDeclNode->VarId = (CIdentifierTreeNode*)BuildIdentifier(Name);
@@ -59,7 +155,7 @@ CTreeNode* CTreeNodeFactory::BuildArrayDeclaration(CTreeNode *VarDecl,
 																									 CTreeNode *Bounds)
 {
 	SanityCheck(VarDecl && Bounds);
-	CArrayDeclTreeNode *NewArrayDecl = new CArrayDeclTreeNode();
+	CArrayDeclTreeNode *NewArrayDecl = NewNode<CArrayDeclTreeNode>();
 
 	NewArrayDecl->Code = TC_ARRAYDECL;
 	NewArrayDecl->AddChild(VarDecl);
@@ -72,7 +168,7 @@ CTreeNode* CTreeNodeFactory::BuildArrayDeclaration(CTreeNode *VarDecl,
 //-------------------------------------------------------------
 CTreeNode* CTreeNodeFactory::BuildLiteral(const string &Value, TokenType LitType)
 {
-	CLiteralTreeNode *NewLiteralNode = new CLiteralTreeNode();
+	CLiteralTreeNode *NewLiteralNode = NewNode<CLiteralTreeNode>();
 
 	NewLiteralNode->Code = TC_LITERAL;
 	NewLiteralNode->LitValue = Value;
@@ -87,10 +183,11 @@ CTreeNode* CTreeNodeFactory::BuildArithExpression(CTreeNode *Lhs, CTreeNode *Rhs
 																									TokenType Op)
 {
 	SanityCheck(Lhs && Rhs);
-	CArithExprTreeNode *NewArithExp = new CArithExprTreeNode();
+	CArithExprTreeNode *NewArithExp = NewNode<CArithExprTreeNode>();
 
 	NewArithExp->Code = TC_ARITH_EXPR;
 	NewArithExp->Operator = Op;
+	NewArithExp->ExprType = TOKTYPE_VOID;
 	NewArithExp->AddChild(Lhs);
 	NewArithExp->AddChild(Rhs);
 
@@ -103,7 +200,7 @@ CTreeNode* CTreeNodeFactory::BuildBooleanExpression(CTreeNode *Lhs,
 																										CTreeNode *Rhs, TokenType Op)
 {
 	SanityCheck(Lhs && Rhs);
-	CBooleanExprTreeNode *NewBlnExp = new CBooleanExprTreeNode();
+	CBooleanExprTreeNode *NewBlnExp = NewNode<CBooleanExprTreeNode>();
 
 	NewBlnExp->Code = TC_BOOLEAN_EXPR;
 	NewBlnExp->Operator = Op;
@@ -116,13 +213,13 @@ CTreeNode* CTreeNodeFactory::BuildBooleanExpression(CTreeNode *Lhs,
 
 //-------------------------------------------------------------
 CTreeNode* CTreeNodeFactory::BuildArrayRef(CTreeNode *Index,
-																					const string &ArrName, TokenType Type)
+																					CTreeNode *ArrName, TokenType Type)
 {
-	SanityCheck(Index);
-	CArrayRefTreeNode *NewArrRef = new CArrayRefTreeNode();
+	SanityCheck(Index && ArrName);
+	CArrayRefTreeNode *NewArrRef = NewNode<CArrayRefTreeNode>();
 
 	NewArrRef->Code = TC_ARRAY_REF;
-	NewArrRef->ArrName = (CIdentifierTreeNode*)BuildIdentifier(ArrName);
+	NewArrRef->ArrName = (CIdentifierTreeNode*)ArrName;
 	NewArrRef->ArrType = Type;
 	NewArrRef->AddChild(Index);
 
@@ -134,7 +231,7 @@ CTreeNode* CTreeNodeFactory::BuildArrayRef(CTreeNode *Index,
 CTreeNode* CTreeNodeFactory::BuildIfStatement(CTreeNode *CondExpr)
 {
 	SanityCheck(CondExpr);
-	CIfStmtTreeNode *NewIfStmt = new CIfStmtTreeNode();
+	CIfStmtTreeNode *NewIfStmt = NewNode<CIfStmtTreeNode>();
 
 	NewIfStmt->Code = TC_IFSTMT;
 	NewIfStmt->AddChild(CondExpr);
@@ -151,7 +248,7 @@ CTreeNode* CTreeNodeFactory::BuildIfStatement(CTreeNode *CondExpr)
 CTreeNode* CTreeNodeFactory::BuildWhileStatement(CTreeNode *CondExpr)
 {
 	SanityCheck(CondExpr);
-	CWhileStmtTreeNode *NewWhileStmt = new CWhileStmtTreeNode();
+	CWhileStmtTreeNode *NewWhileStmt = NewNode<CWhileStmtTreeNode>();
 
 	NewWhileStmt->Code = TC_WHILESTMT;
 	NewWhileStmt->AddChild(CondExpr);
@@ -165,7 +262,7 @@ CTreeNode* CTreeNodeFactory::BuildAssignmentExpr(CTreeNode *Lhs,
 																								CTreeNode *Rhs)
 {
 	SanityCheck(Lhs && Rhs);
-	CAssignExprTreeNode *NewAssignExpr = new CAssignExprTreeNode();
+	CAssignExprTreeNode *NewAssignExpr = NewNode<CAssignExprTreeNode>();
 
 	NewAssignExpr->Code = TC_ASSIGN_EXPR;
 	NewAssignExpr->AddChild(Lhs);
@@ -178,7 +275,7 @@ CTreeNode* CTreeNodeFactory::BuildAssignmentExpr(CTreeNode *Lhs,
 //-------------------------------------------------------------
 CTreeNode* CTreeNodeFactory::BuildParameterList(void)
 {
-	CParameterListTreeNode *NewParmList = new CParameterListTreeNode();
+	CParameterListTreeNode *NewParmList = NewNode<CParameterListTreeNode>();
 
 	NewParmList->Code = TC_PARAMETER_LIST;
 	return NewParmList;
@@ -191,7 +288,7 @@ CTreeNode* CTreeNodeFactory::BuildFunctionDecl(const string &Name, int NumParms,
 																							 TokenType RetType)
 {
 	SanityCheck(ParmList);
-	CFunctionDeclTreeNode *NewFnDecl = new CFunctionDeclTreeNode();
+	CFunctionDeclTreeNode *NewFnDecl = NewNode<CFunctionDeclTreeNode>();
 
 	NewFnDecl->Code = TC_FUNCTIONDECL;
 	NewFnDecl->Name = Name;
@@ -207,7 +304,7 @@ CTreeNode* CTreeNodeFactory::BuildFunctionDecl(const string &Name, int NumParms,
 CTreeNode* CTreeNodeFactory::BuildParameterDecl(const string &Name, TokenType Type,
                                                 bool IsConst, int Position)
 {
-	CParameterDeclTreeNode *NewParmDecl = new CParameterDeclTreeNode();
+	CParameterDeclTreeNode *NewParmDecl = NewNode<CParameterDeclTreeNode>();
 
 	NewParmDecl->Code = TC_PARMDECL;
 	NewParmDecl->AddChild(BuildIdentifier(Name));
@@ -223,7 +320,7 @@ CTreeNode* CTreeNodeFactory::BuildParameterDecl(const string &Name, TokenType Ty
 CTreeNode* CTreeNodeFactory::BuildReturnStmt(CTreeNode *Expr)
 {
 	SanityCheck(Expr);
-	CReturnStmtTreeNode *NewRetStmt = new CReturnStmtTreeNode();
+	CReturnStmtTreeNode *NewRetStmt = NewNode<CReturnStmtTreeNode>();
 
 	NewRetStmt->Code = TC_RETURNSTMT;
 	NewRetStmt->AddChild(Expr);
@@ -235,10 +332,12 @@ CTreeNode* CTreeNodeFactory::BuildReturnStmt(CTreeNode *Expr)
 //-------------------------------------------------------------
 CTreeNode* CTreeNodeFactory::BuildCallExpr(const string &FuncName)
 {
-	CCallExprTreeNode *NewCallExpr = new CCallExprTreeNode();
+	CCallExprTreeNode *NewCallExpr = NewNode<CCallExprTreeNode>();
 
 	NewCallExpr->Code = TC_CALLEXPR;
 	NewCallExpr->FuncName = FuncName;
+	NewCallExpr->ExprType = TOKTYPE_VOID;
+	NewCallExpr->Binding = NULL;
 
 	return NewCallExpr;
 }
@@ -248,10 +347,11 @@ CTreeNode* CTreeNodeFactory::BuildCallExpr(const string &FuncName)
 CTreeNode* CTreeNodeFactory::BuildUnaryExpression(CTreeNode *Expr, TokenType Op)
 {
 	SanityCheck(Expr);
-	CUnaryExprTreeNode *UnExpr = new CUnaryExprTreeNode();
+	CUnaryExprTreeNode *UnExpr = NewNode<CUnaryExprTreeNode>();
 
 	UnExpr->Code = TC_UNARY_EXPR;
 	UnExpr->Operator = Op;
+	UnExpr->ExprType = TOKTYPE_VOID;
 	UnExpr->AddChild(Expr);
 
 	return UnExpr;
@@ -261,7 +361,7 @@ CTreeNode* CTreeNodeFactory::BuildUnaryExpression(CTreeNode *Expr, TokenType Op)
 //-------------------------------------------------------------
 CTreeNode* CTreeNodeFactory::BuildRootNode(void)
 {
-	CRootTreeNode *NewRoot = new CRootTreeNode();
+	CRootTreeNode *NewRoot = NewNode<CRootTreeNode>();
 
 	NewRoot->Code = TC_ROOT;
 	return NewRoot;
@@ -271,9 +371,10 @@ CTreeNode* CTreeNodeFactory::BuildRootNode(void)
 //-------------------------------------------------------------
 CTreeNode* CTreeNodeFactory::BuildLabel(const string &Name)
 {
-	CLabelTreeNode *NewLabel = new CLabelTreeNode();
+	CLabelTreeNode *NewLabel = NewNode<CLabelTreeNode>();
 
 	NewLabel->Name = Name;
+	NewLabel->NameAtom = CAtomTable::GetSingletonPtr()->Intern(Name);
 	NewLabel->Code = TC_LABEL;
 
 	return NewLabel;
@@ -283,10 +384,11 @@ CTreeNode* CTreeNodeFactory::BuildLabel(const string &Name)
 //-------------------------------------------------------------
 CTreeNode* CTreeNodeFactory::BuildGotoExpr(const string &Target)
 {
-	CGotoExprTreeNode *GotoExpr = new CGotoExprTreeNode();
+	CGotoExprTreeNode *GotoExpr = NewNode<CGotoExprTreeNode>();
 
 	GotoExpr->Code = TC_GOTOEXPR;
 	GotoExpr->Target = Target;
+	GotoExpr->TargetAtom = CAtomTable::GetSingletonPtr()->Intern(Target);
 
 	return GotoExpr;
 }
@@ -297,7 +399,7 @@ CTreeNode* CTreeNodeFactory::BuildLiteralRef(CTreeNode *Lit,
 																						 const string &RefId)
 {
 	SanityCheck(Lit && Lit->Code == TC_LITERAL);
-	CLiteralRefTreeNode *NewLitRef = new CLiteralRefTreeNode();
+	CLiteralRefTreeNode *NewLitRef = NewNode<CLiteralRefTreeNode>();
 
 	NewLitRef->Code = TC_LITERALREF;
 	NewLitRef->RefID = RefId;
@@ -306,5 +408,41 @@ CTreeNode* CTreeNodeFactory::BuildLiteralRef(CTreeNode *Lit,
 }
 //-------------------------------------------------------------
 
+//-------------------------------------------------------------
+CTreeNode* CTreeNodeFactory::BuildEmptyNode(TreeCode Code)
+{
+	CTreeNode *NewTreeNode = NULL;
+
+	switch(Code)
+	{
+	case TC_IDENTIFIER:     NewTreeNode = NewNode<CIdentifierTreeNode>(); break;
+	case TC_VARDECL:        NewTreeNode = NewNode<CVarDeclTreeNode>(); break;
+	case TC_ARRAYDECL:      NewTreeNode = NewNode<CArrayDeclTreeNode>(); break;
+	case TC_LITERAL:        NewTreeNode = NewNode<CLiteralTreeNode>(); break;
+	case TC_ARITH_EXPR:     NewTreeNode = NewNode<CArithExprTreeNode>(); break;
+	case TC_BOOLEAN_EXPR:   NewTreeNode = NewNode<CBooleanExprTreeNode>(); break;
+	case TC_UNARY_EXPR:     NewTreeNode = NewNode<CUnaryExprTreeNode>(); break;
+	case TC_ARRAY_REF:      NewTreeNode = NewNode<CArrayRefTreeNode>(); break;
+	case TC_IFSTMT:         NewTreeNode = NewNode<CIfStmtTreeNode>(); break;
+	case TC_WHILESTMT:      NewTreeNode = NewNode<CWhileStmtTreeNode>(); break;
+	case TC_ASSIGN_EXPR:    NewTreeNode = NewNode<CAssignExprTreeNode>(); break;
+	case TC_PARAMETER_LIST: NewTreeNode = NewNode<CParameterListTreeNode>(); break;
+	case TC_FUNCTIONDECL:   NewTreeNode = NewNode<CFunctionDeclTreeNode>(); break;
+	case TC_PARMDECL:       NewTreeNode = NewNode<CParameterDeclTreeNode>(); break;
+	case TC_RETURNSTMT:     NewTreeNode = NewNode<CReturnStmtTreeNode>(); break;
+	case TC_CALLEXPR:       NewTreeNode = NewNode<CCallExprTreeNode>(); break;
+	case TC_ROOT:           NewTreeNode = NewNode<CRootTreeNode>(); break;
+	case TC_LABEL:          NewTreeNode = NewNode<CLabelTreeNode>(); break;
+	case TC_GOTOEXPR:       NewTreeNode = NewNode<CGotoExprTreeNode>(); break;
+	case TC_LITERALREF:     NewTreeNode = NewNode<CLiteralRefTreeNode>(); break;
+	default:
+		InternalError("unknown tree code");
+	}
+
+	NewTreeNode->Code = Code;
+	return NewTreeNode;
+}
+//-------------------------------------------------------------
+
 //singleton static member definition
 template<> CTreeNodeFactory* ISingleton<CTreeNodeFactory>::ms_Singleton = 0;
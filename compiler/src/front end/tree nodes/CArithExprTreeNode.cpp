@@ -7,6 +7,7 @@
 
 #include "StdHeader.h"
 #include "CArithExprTreeNode.h"
+#include "CXmlWriter.h"
 #include "CLiteralTreeNode.h"
 #include "CSymbolTable.h"
 #include "CIdentifierTreeNode.h"
@@ -17,29 +18,27 @@
 #include "CFunctionDeclTreeNode.h"
 #include "CLiteralRefTreeNode.h"
 #include "CArrayDeclTreeNode.h"
+#include "CConstantFolder.h"
 
 //-------------------------------------------------------------
-void CArithExprTreeNode::DumpAsParseTreeNode(TiXmlElement *XmlNode)
+void CArithExprTreeNode::DumpAsParseTreeNode(CXmlWriter &XmlOut)
 {
-	SanityCheck(XmlNode);
-
-	TiXmlElement *ExpNode;
-	ExpNode = XmlNode->InsertEndChild(TiXmlElement("arith_expr"))->ToElement();
+	XmlOut.OpenElement("arith_expr");
 
 	//add the operator
-	TiXmlElement *OpNode;
-	OpNode = ExpNode->InsertEndChild(TiXmlElement("operator"))->ToElement();
-	OpNode->InsertEndChild(TiXmlText(CUtilFuncs::TokenTypeToStr(Operator).c_str()));
+	XmlOut.WriteElement("operator", CUtilFuncs::TokenTypeToStr(Operator));
 
 	//add the lhs
-	TiXmlElement *LhsNode;
-	LhsNode = ExpNode->InsertEndChild(TiXmlElement("lhs"))->ToElement();
-	GetChild(ARITH_EXPR_LHS)->DumpAsParseTreeNode(LhsNode);
+	XmlOut.OpenElement("lhs");
+	GetChild(ARITH_EXPR_LHS)->DumpAsParseTreeNode(XmlOut);
+	XmlOut.CloseElement();
 
 	//finally the rhs
-	TiXmlElement *RhsNode;
-	RhsNode = ExpNode->InsertEndChild(TiXmlElement("rhs"))->ToElement();
-	GetChild(ARITH_EXPR_RHS)->DumpAsParseTreeNode(RhsNode);
+	XmlOut.OpenElement("rhs");
+	GetChild(ARITH_EXPR_RHS)->DumpAsParseTreeNode(XmlOut);
+	XmlOut.CloseElement();
+
+	XmlOut.CloseElement();
 }
 //-------------------------------------------------------------
 
@@ -65,19 +64,35 @@ CTreeNode* CArithExprTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 	//   mov eax, 65
 	//   imul eax, 43
 
-	//simplify each side of the expression
-	CTreeNode *LhsNode = GetChild(ARITH_EXPR_LHS)->RewriteIntoMIRForm(Stmts);
-	LhsNode = ReplaceArrayRefs(ReplaceCallExpr(LhsNode, Stmts), Stmts);
+	//simplify each side of the expression. Literals are left as they are
+	//until we know the expression can't be folded so a floating point 
+	//literal which gets folded away doesn't end up in the data section
+	CTreeNode *LhsNode = GetChild(ARITH_EXPR_LHS);
+	CTreeNode *RhsNode = GetChild(ARITH_EXPR_RHS);
 
-	CTreeNode *RhsNode = GetChild(ARITH_EXPR_RHS)->RewriteIntoMIRForm(Stmts);
-	RhsNode = ReplaceArrayRefs(ReplaceCallExpr(RhsNode, Stmts), Stmts);
+	if(LhsNode->Code != TC_LITERAL)
+		LhsNode = ReplaceArrayRefs(ReplaceCallExpr(LhsNode->RewriteIntoMIRForm(Stmts), Stmts), Stmts);
 
-	CTreeNodeFactory *TreeFactory = CTreeNodeFactory::GetSingletonPtr();
-	CSymbolTable *SymTable = CSymbolTable::GetSingletonPtr();
+	if(RhsNode->Code != TC_LITERAL)
+		RhsNode = ReplaceArrayRefs(ReplaceCallExpr(RhsNode->RewriteIntoMIRForm(Stmts), Stmts), Stmts);
+
+	//if both sides are constant we don't need any code at all, and
+	//identities such as x + 0 are just the identifier
+	CTreeNode *Folded = CConstantFolder::FoldArithExpr(LhsNode, RhsNode, Operator, Stmts);
+
+	if(!Folded)
+		Folded = CConstantFolder::SimplifyArithExpr(LhsNode, RhsNode, Operator);
+
+	if(Folded)
+		return Folded;
 
-	//generate a variable name for this temp var that will hold the
-	//result of this expression
-	string TempVarName = CUtilFuncs::GenCompilerTempName();
+	if(LhsNode->Code == TC_LITERAL)
+		LhsNode = LhsNode->RewriteIntoMIRForm(Stmts);
+
+	if(RhsNode->Code == TC_LITERAL)
+		RhsNode = RhsNode->RewriteIntoMIRForm(Stmts);
+
+	CTreeNodeFactory *TreeFactory = CTreeNodeFactory::GetSingletonPtr();
 
 	//the simplification of the LHS either produces an identifier node,
 	//or a literal value. In either case we need to extract the type so
@@ -99,18 +114,16 @@ CTreeNode* CArithExprTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 	else
 	{
 		//create the var_decl, using the same type as the variable
-		CVarDeclTreeNode *TempVar = (CVarDeclTreeNode*)TreeFactory->BuildVarDecl(
-			TempVarName, false, TempVarType);
+		CVarDeclTreeNode *TempVar = BuildTempVar(TempVarType);
 
 		//assign the value computed from the simplification of LHS of this expression
 		//to this temporary variable, adding it to the MIR tree
 		CTreeNode *AssignExpr = TreeFactory->BuildAssignmentExpr(
 			TempVar->VarId->CreateCopy(), LhsNode);
 
-		Stmts->AddChild(TempVar);
-		Stmts->AddChild(AssignExpr);
+		Stmts->AddStmt(TempVar);
+		Stmts->AddStmt(AssignExpr);
 
-		SymTable->AddSymbol(TempVar->VarId->IdName, TempVar, 0, TempVar->VarType);
 		TempLhsId = (CIdentifierTreeNode*)TempVar->VarId->CreateCopy();
 	}
 
@@ -124,7 +137,7 @@ CTreeNode* CArithExprTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 		TempLhsId->CreateCopy(), AssignInitExpr);
 
 	//add the assignment statement to the MIR tree
-	Stmts->AddChild(AssignExpr);
+	Stmts->AddStmt(AssignExpr);
 
 	//there's little use in simply returning an assignment expression so instead
 	//return the LHS which is the identifier holding the value
@@ -135,19 +148,20 @@ CTreeNode* CArithExprTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 //-------------------------------------------------------------
 CTreeNode* CArithExprTreeNode::CreateCopy(void)
 {
-	return CTreeNodeFactory::GetSingletonPtr()->BuildArithExpression(
+	CArithExprTreeNode *Copy;
+	Copy = (CArithExprTreeNode*)CTreeNodeFactory::GetSingletonPtr()->BuildArithExpression(
 						GetChild(ARITH_EXPR_LHS)->CreateCopy(),
 						GetChild(ARITH_EXPR_RHS)->CreateCopy(),
 						Operator);
+	Copy->ExprType = ExprType;
+
+	return Copy;
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
 TokenType CArithExprTreeNode::DetermineTempVarType(CTreeNode *Lhs)
 {
-	CSymbolTable *SymTable = CSymbolTable::GetSingletonPtr();
-	Symbol_t *LhsSym = NULL;
-
 	switch(Lhs->Code)
 	{
 	case TC_LITERAL:
@@ -171,19 +185,17 @@ TokenType CArithExprTreeNode::DetermineTempVarType(CTreeNode *Lhs)
 	case TC_IDENTIFIER:
 	{
 		CIdentifierTreeNode *Id = (CIdentifierTreeNode*)Lhs;
-		LhsSym = SymTable->LookupIdentifier(Id->IdName, false);
-		SanityCheck(LhsSym);
+		SanityCheck(Id->Binding);
 
-		return  LhsSym->SymType;
+		return Id->Binding->SymType;
 	}
 	
 	case TC_ARRAY_REF:
 		{
 			CArrayRefTreeNode *ArrRef = (CArrayRefTreeNode*)Lhs;
-			LhsSym = SymTable->LookupIdentifier(ArrRef->ArrName->IdName, false);
-			SanityCheck(LhsSym);
+			SanityCheck(ArrRef->ArrName->Binding);
 
-			return LhsSym->SymType;
+			return ArrRef->ArrName->Binding->SymType;
 		}
 
 	case TC_UNARY_EXPR:
@@ -204,11 +216,8 @@ TokenType CArithExprTreeNode::DetermineTempVarType(CTreeNode *Lhs)
 			CIdentifierTreeNode *UnExprId;
 			UnExprId = (CIdentifierTreeNode*)UnExpr->GetChild(UNARY_EXPR_EXPR);
 
-			//look it up
-			Symbol_t *ExprSym = SymTable->LookupIdentifier(UnExprId->IdName, false);
-			SanityCheck(ExprSym);
-
-			return ExprSym->SymType;
+			SanityCheck(UnExprId->Binding);
+			return UnExprId->Binding->SymType;
 		}
 	}
 
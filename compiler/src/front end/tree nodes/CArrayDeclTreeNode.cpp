@@ -6,24 +6,24 @@
 
 #include "StdHeader.h"
 #include "CArrayDeclTreeNode.h"
+#include "CXmlWriter.h"
 #include "CVarDeclTreeNode.h"
 #include "CIdentifierTreeNode.h"
 #include "CSymbolTable.h"
 
 //-------------------------------------------------------------
-void CArrayDeclTreeNode::DumpAsParseTreeNode(TiXmlElement *XmlNode)
+void CArrayDeclTreeNode::DumpAsParseTreeNode(CXmlWriter &XmlOut)
 {
-	SanityCheck(XmlNode);
-
 	//dump variable decl
-	TiXmlElement *ArrDeclNode;
-	ArrDeclNode = XmlNode->InsertEndChild(TiXmlElement("arr_decl"))->ToElement();
-	GetChild(ARR_DECL_VAR)->DumpAsParseTreeNode(ArrDeclNode);
+	XmlOut.OpenElement("arr_decl");
+	GetChild(ARR_DECL_VAR)->DumpAsParseTreeNode(XmlOut);
 
 	//dump bounds
-	TiXmlElement *BoundsNode;
-	BoundsNode = ArrDeclNode->InsertEndChild(TiXmlElement("bounds"))->ToElement();
-	GetChild(ARR_DECL_BOUNDS)->DumpAsParseTreeNode(BoundsNode);
+	XmlOut.OpenElement("bounds");
+	GetChild(ARR_DECL_BOUNDS)->DumpAsParseTreeNode(XmlOut);
+	XmlOut.CloseElement();
+
+	XmlOut.CloseElement();
 }
 //-------------------------------------------------------------
 
@@ -46,10 +46,13 @@ void CArrayDeclTreeNode::DumpAsMIRTreeNode(ofstream &OutFile)
 //-------------------------------------------------------------
 CTreeNode* CArrayDeclTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 {
-	//add ourselves to the symbol table
+	//the copy's name is bound to the same symbol as ours, point it at the copy
 	CArrayDeclTreeNode *Copy = (CArrayDeclTreeNode*)CreateCopy();
 	CVarDeclTreeNode *ArrVar = (CVarDeclTreeNode*)Copy->GetChild(ARR_DECL_VAR);
-	CSymbolTable::GetSingletonPtr()->AddSymbol(ArrVar->VarId->IdName, Copy, 0, ArrVar->VarType);
+
+	SanityCheck(ArrVar->VarId->Binding);
+	ArrVar->VarId->Binding->IdPtr = Copy;
+	ArrVar->VarId->Binding->SymType = ArrVar->VarType;
 
 	return Copy;
 }
@@ -6,6 +6,7 @@
 
 #include "StdHeader.h"
 #include "CArrayRefTreeNode.h"
+#include "CXmlWriter.h"
 #include "CSymbolTable.h"
 #include "CIdentifierTreeNode.h"
 #include "CAssignExprTreeNode.h"
@@ -13,16 +14,16 @@
 #include "CSymbolTable.h"
 
 //-------------------------------------------------------------
-void CArrayRefTreeNode::DumpAsParseTreeNode(TiXmlElement *XmlNode)
+void CArrayRefTreeNode::DumpAsParseTreeNode(CXmlWriter &XmlOut)
 {
-	TiXmlElement *ArrRefNode;
-	ArrRefNode = XmlNode->InsertEndChild(TiXmlElement("array_ref"))->ToElement();
-
-	TiXmlElement *IndexNode;
-	IndexNode = ArrRefNode->InsertEndChild(TiXmlElement("index"))->ToElement();
+	XmlOut.OpenElement("array_ref");
+	XmlOut.OpenElement("index");
 
 	//dump the expression used for the index
-	GetChild(ARR_REF_INDEX)->DumpAsParseTreeNode(IndexNode);
+	GetChild(ARR_REF_INDEX)->DumpAsParseTreeNode(XmlOut);
+
+	XmlOut.CloseElement();
+	XmlOut.CloseElement();
 }
 //-------------------------------------------------------------
 
@@ -44,11 +45,7 @@ CTreeNode* CArrayRefTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 
 	if(IndexExpr->Code == TC_LITERAL
 			|| IndexExpr->Code == TC_IDENTIFIER)
-	{
-		CTreeNode *Copy = CreateCopy();
-		CSymbolTable::GetSingletonPtr()->AddSymbol(ArrName->IdName, Copy, 0, ArrType);
-		return Copy;
-	}
+		return CreateCopy();
 
 	//saves on typing
 	CTreeNodeFactory *TreeNodeFactory = CTreeNodeFactory::GetSingletonPtr();
@@ -60,51 +57,44 @@ CTreeNode* CArrayRefTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 		CTreeNode *NewIndex = IndexExpr->RewriteIntoMIRForm(Stmts);
 
 		//create a new temp variable to hold the result of the inner array access
-		string TempVarName = CUtilFuncs::GenCompilerTempName();
-		CVarDeclTreeNode *TempVar = (CVarDeclTreeNode*)TreeNodeFactory->BuildVarDecl(
-			TempVarName, false, TOKTYPE_INTEGERTYPE);
+		CVarDeclTreeNode *TempVar = BuildTempVar(TOKTYPE_INTEGERTYPE);
 
 		//initialise the temp var with the inner array access
 		CAssignExprTreeNode *TempVarAssign;
 		TempVarAssign = (CAssignExprTreeNode*)TreeNodeFactory->BuildAssignmentExpr(
 			TempVar->VarId->CreateCopy(), NewIndex);
 
-		//add the new var decl to the symbol table
-		CSymbolTable::GetSingletonPtr()->AddSymbol(TempVarName, TempVar, 0, 
-			TOKTYPE_INTEGERTYPE);
-
 		//add the intermediate stmts
-		Stmts->AddChild(TempVar);
-		Stmts->AddChild(TempVarAssign);
+		Stmts->AddStmt(TempVar);
+		Stmts->AddStmt(TempVarAssign);
 		return TreeNodeFactory->BuildArrayRef(TempVar->VarId->CreateCopy(), 
-			ArrName->IdName, ArrType);
+			ArrName->CreateCopy(), ArrType);
 	}
 
 	if(IndexExpr->Code == TC_ARITH_EXPR)
 	{
-		//create a temp var initialised to the result of the arith expr
-		string TempVarName = CUtilFuncs::GenCompilerTempName();
-		CVarDeclTreeNode *TempVar = (CVarDeclTreeNode*)TreeNodeFactory->BuildVarDecl(
-			TempVarName, false, TOKTYPE_INTEGERTYPE);
-
 		//simplify the index expression
 		CTreeNode *NewIndex = IndexExpr->RewriteIntoMIRForm(Stmts);
 
+		//if it's been folded into a literal use it as is, the code generator
+		//can address the element directly
+		if(NewIndex->Code == TC_LITERAL)
+			return TreeNodeFactory->BuildArrayRef(NewIndex, ArrName->CreateCopy(), ArrType);
+
+		//create a temp var initialised to the result of the arith expr
+		CVarDeclTreeNode *TempVar = BuildTempVar(TOKTYPE_INTEGERTYPE);
+
 		//initialise the temp var with the expr result
 		CAssignExprTreeNode *TempVarAssign;
 		TempVarAssign = (CAssignExprTreeNode*)TreeNodeFactory->BuildAssignmentExpr(
 			TempVar->VarId->CreateCopy(), NewIndex);
 
-		//add the new var decl to the symbol table
-		CSymbolTable::GetSingletonPtr()->AddSymbol(TempVarName, TempVar, 0, 
-			TOKTYPE_INTEGERTYPE);
-
 		//add the intermediate stmts
-		Stmts->AddChild(TempVar);
-		Stmts->AddChild(TempVarAssign);
+		Stmts->AddStmt(TempVar);
+		Stmts->AddStmt(TempVarAssign);
 
 		return TreeNodeFactory->BuildArrayRef(TempVar->VarId->CreateCopy(), 
-			ArrName->IdName, ArrType);
+			ArrName->CreateCopy(), ArrType);
 	}
 
 	InternalError("unexpected array ref index expr type");
@@ -115,13 +105,16 @@ CTreeNode* CArrayRefTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 CTreeNode* CArrayRefTreeNode::CreateCopy(void)
 {
 	return CTreeNodeFactory::GetSingletonPtr()->BuildArrayRef(
-						GetChild(ARR_REF_INDEX)->CreateCopy(), ArrName->IdName, ArrType);
+						GetChild(ARR_REF_INDEX)->CreateCopy(), ArrName->CreateCopy(), ArrType);
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
 void CArrayRefTreeNode::DestroyNode(void)
 {
+	if(Arena != NA_HEAP)
+		return;
+
 	ArrName->DestroyNode();
 	GetChild(ARR_REF_INDEX)->DestroyNode();
 	ArrName = NULL;
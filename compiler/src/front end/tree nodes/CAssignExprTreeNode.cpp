@@ -6,26 +6,26 @@
 
 #include "StdHeader.h"
 #include "CAssignExprTreeNode.h"
+#include "CXmlWriter.h"
 #include "CArrayRefTreeNode.h"
 #include "CIdentifierTreeNode.h"
 
 //-------------------------------------------------------------
-void CAssignExprTreeNode::DumpAsParseTreeNode(TiXmlElement *XmlNode)
+void CAssignExprTreeNode::DumpAsParseTreeNode(CXmlWriter &XmlOut)
 {
-	SanityCheck(XmlNode);
-
-	TiXmlElement *ExpNode;
-	ExpNode = XmlNode->InsertEndChild(TiXmlElement("assign_expr"))->ToElement();
+	XmlOut.OpenElement("assign_expr");
 
 	//add the lhs
-	TiXmlElement *LhsNode;
-	LhsNode = ExpNode->InsertEndChild(TiXmlElement("lhs"))->ToElement();
-	GetChild(ASSIGN_EXPR_ID)->DumpAsParseTreeNode(LhsNode);
+	XmlOut.OpenElement("lhs");
+	GetChild(ASSIGN_EXPR_ID)->DumpAsParseTreeNode(XmlOut);
+	XmlOut.CloseElement();
 
 	//add the rhs
-	TiXmlElement *RhsNode;
-	RhsNode = ExpNode->InsertEndChild(TiXmlElement("rhs"))->ToElement();
-	GetChild(ASSIGN_EXPR_RHS)->DumpAsParseTreeNode(RhsNode);
+	XmlOut.OpenElement("rhs");
+	GetChild(ASSIGN_EXPR_RHS)->DumpAsParseTreeNode(XmlOut);
+	XmlOut.CloseElement();
+
+	XmlOut.CloseElement();
 }
 //-------------------------------------------------------------
 
@@ -55,7 +55,7 @@ CTreeNode* CAssignExprTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 
 		//build a new arr_ref
 		Lhs = CTreeNodeFactory::GetSingletonPtr()->BuildArrayRef(NewIndex, 
-			ArrRef->ArrName->IdName, ArrRef->ArrType);
+			ArrRef->ArrName->CreateCopy(), ArrRef->ArrType);
 	}
 	else
 		Lhs = GetChild(ASSIGN_EXPR_ID)->CreateCopy();
@@ -7,32 +7,31 @@
 
 #include "StdHeader.h"
 #include "CBooleanExprTreeNode.h"
+#include "CXmlWriter.h"
 #include "CVarDeclTreeNode.h"
 #include "CSymbolTable.h"
 #include "CIdentifierTreeNode.h"
+#include "CConstantFolder.h"
 
 //-------------------------------------------------------------
-void CBooleanExprTreeNode::DumpAsParseTreeNode(TiXmlElement *XmlNode)
+void CBooleanExprTreeNode::DumpAsParseTreeNode(CXmlWriter &XmlOut)
 {
-	SanityCheck(XmlNode);
-
-	TiXmlElement *ExpNode;
-	ExpNode = XmlNode->InsertEndChild(TiXmlElement("bln_expr"))->ToElement();
+	XmlOut.OpenElement("bln_expr");
 
 	//add the operator
-	TiXmlElement *OpNode;
-	OpNode = ExpNode->InsertEndChild(TiXmlElement("operator"))->ToElement();
-	OpNode->InsertEndChild(TiXmlText(CUtilFuncs::TokenTypeToStr(Operator).c_str()));
+	XmlOut.WriteElement("operator", CUtilFuncs::TokenTypeToStr(Operator));
 
 	//add the lhs
-	TiXmlElement *LhsNode;
-	LhsNode = ExpNode->InsertEndChild(TiXmlElement("lhs"))->ToElement();
-	GetChild(BLN_EXPR_LHS)->DumpAsParseTreeNode(LhsNode);
+	XmlOut.OpenElement("lhs");
+	GetChild(BLN_EXPR_LHS)->DumpAsParseTreeNode(XmlOut);
+	XmlOut.CloseElement();
 
 	//finally the rhs
-	TiXmlElement *RhsNode;
-	RhsNode = ExpNode->InsertEndChild(TiXmlElement("rhs"))->ToElement();
-	GetChild(BLN_EXPR_RHS)->DumpAsParseTreeNode(RhsNode);
+	XmlOut.OpenElement("rhs");
+	GetChild(BLN_EXPR_RHS)->DumpAsParseTreeNode(XmlOut);
+	XmlOut.CloseElement();
+
+	XmlOut.CloseElement();
 }
 //-------------------------------------------------------------
 
@@ -49,12 +48,28 @@ void CBooleanExprTreeNode::DumpAsMIRTreeNode(ofstream &OutFile)
 CTreeNode* CBooleanExprTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 {
 	//process the operands, getting rid of any call_exprs or array references 
-	//that may be lingering in the process
-	CTreeNode *LhsNode = GetChild(BLN_EXPR_LHS)->RewriteIntoMIRForm(Stmts);
-	LhsNode = ReplaceArrayRefs(ReplaceCallExpr(LhsNode, Stmts), Stmts);
+	//that may be lingering in the process. Literals are left alone until we
+	//know the expression can't be folded
+	CTreeNode *LhsNode = GetChild(BLN_EXPR_LHS);
+	CTreeNode *RhsNode = GetChild(BLN_EXPR_RHS);
+
+	if(LhsNode->Code != TC_LITERAL)
+		LhsNode = ReplaceArrayRefs(ReplaceCallExpr(LhsNode->RewriteIntoMIRForm(Stmts), Stmts), Stmts);
+
+	if(RhsNode->Code != TC_LITERAL)
+		RhsNode = ReplaceArrayRefs(ReplaceCallExpr(RhsNode->RewriteIntoMIRForm(Stmts), Stmts), Stmts);
+
+	//comparing two constants gives a constant
+	CTreeNode *Folded = CConstantFolder::FoldBooleanExpr(LhsNode, RhsNode, Operator);
 
-	CTreeNode *RhsNode = GetChild(BLN_EXPR_RHS)->RewriteIntoMIRForm(Stmts);
-	RhsNode = ReplaceArrayRefs(ReplaceCallExpr(RhsNode, Stmts), Stmts);
+	if(Folded)
+		return Folded;
+
+	if(LhsNode->Code == TC_LITERAL)
+		LhsNode = LhsNode->RewriteIntoMIRForm(Stmts);
+
+	if(RhsNode->Code == TC_LITERAL)
+		RhsNode = RhsNode->RewriteIntoMIRForm(Stmts);
 
 	//if either side was simplified, we will have a bln_expr in LhsNode or
 	//RhsNode when we only want the identifier being assigned to which will
@@ -92,23 +107,15 @@ CTreeNode* CBooleanExprTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 	else
 		TempVarType = TOKTYPE_INTEGERTYPE;
 
-	//generate a variable name for this temp var that will hold the
-	//result of this expression
-	string TempVarName = CUtilFuncs::GenCompilerTempName();
+	//create a temp var_decl that will hold the result of this expression
 	CTreeNodeFactory *TreeNodeFactory = CTreeNodeFactory::GetSingletonPtr();
-
-	//create a temp var_decl
-	CVarDeclTreeNode *TempVar = (CVarDeclTreeNode*)TreeNodeFactory->BuildVarDecl(
-		TempVarName, false, TempVarType);
-	Stmts->AddChild(TempVar);
+	CVarDeclTreeNode *TempVar = BuildTempVar(TempVarType);
+	Stmts->AddStmt(TempVar);
 
 	//generate an assignment from the init value to the temp var
-	Stmts->AddChild(TreeNodeFactory->BuildAssignmentExpr(TempVar->VarId->CreateCopy(),
+	Stmts->AddStmt(TreeNodeFactory->BuildAssignmentExpr(TempVar->VarId->CreateCopy(),
 		LhsNode));
 
-	CSymbolTable::GetSingletonPtr()->AddSymbol(TempVar->VarId->IdName,
-		TempVar, 0, TempVar->VarType);
-
 	return RewriteExprIntoArithmeticForm(RhsNode, TempVar, Stmts);
 }
 //-------------------------------------------------------------
@@ -198,7 +205,7 @@ CTreeNode* CBooleanExprTreeNode::RewriteExprIntoArithmeticForm(CTreeNode *RhsNod
 
 	CTreeNode *AssignExpr = CTreeNodeFactory::GetSingletonPtr()->BuildAssignmentExpr(
     TempVar->VarId->CreateCopy(), ArithExpr);
-	Stmts->AddChild(AssignExpr);
+	Stmts->AddStmt(AssignExpr);
 
 	return CTreeNodeFactory::GetSingletonPtr()->BuildBooleanExpression(
 		AssignExpr->GetChild(ASSIGN_EXPR_ID)->CreateCopy(),
@@ -6,6 +6,7 @@
 
 #include "StdHeader.h"
 #include "CCallExprTreeNode.h"
+#include "CXmlWriter.h"
 #include "CSymbolTable.h"
 #include "CFunctionDeclTreeNode.h"
 #include "CParameterListTreeNode.h"
@@ -13,21 +14,19 @@
 #include "CVarDeclTreeNode.h"
 
 //-------------------------------------------------------------
-void CCallExprTreeNode::DumpAsParseTreeNode(TiXmlElement *XmlNode)
+void CCallExprTreeNode::DumpAsParseTreeNode(CXmlWriter &XmlOut)
 {
-	SanityCheck(XmlNode);
-
-	TiXmlElement *CallExprNode;
-	CallExprNode = XmlNode->InsertEndChild(TiXmlElement("call_expr"))->ToElement();
+	XmlOut.OpenElement("call_expr");
 
 	//add the parameters
-	TiXmlElement *ParmNode = NULL;
-
 	for(unsigned int i = 0; i < GetNumChildren(); i++)
 	{
-		ParmNode = CallExprNode->InsertEndChild(TiXmlElement("call_expr_parm"))->ToElement();
-		GetChild(i)->DumpAsParseTreeNode(ParmNode);
+		XmlOut.OpenElement("call_expr_parm");
+		GetChild(i)->DumpAsParseTreeNode(XmlOut);
+		XmlOut.CloseElement();
 	}
+
+	XmlOut.CloseElement();
 }
 //-------------------------------------------------------------
 
@@ -52,7 +51,11 @@ void CCallExprTreeNode::DumpAsMIRTreeNode(ofstream &OutFile)
 CTreeNode* CCallExprTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 {
 	CTreeNodeFactory *TreeNodeFactory = CTreeNodeFactory::GetSingletonPtr();
-	CTreeNode *NewFuncCall = TreeNodeFactory->BuildCallExpr("_" + FuncName);
+	CCallExprTreeNode *NewFuncCall;
+	NewFuncCall = (CCallExprTreeNode*)TreeNodeFactory->BuildCallExpr("_" + FuncName);
+
+	//by now our symbol points at the lowered function
+	NewFuncCall->Binding = Binding;
 
 	//get the parameter list of the function being called	
 	CFunctionDeclTreeNode *FnDecl;
@@ -77,22 +80,15 @@ CTreeNode* CCallExprTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 			//create a new temporary integer type variable which is initialised 
 			//to the floating point expression, this will ensure the necessary
 			//truncation will take place before passing it as a parameter
-			string TempVarName = CUtilFuncs::GenCompilerTempName();
-			CVarDeclTreeNode *TempVar;
-			TempVar = (CVarDeclTreeNode*)TreeNodeFactory->BuildVarDecl(TempVarName, false, 
-				TOKTYPE_INTEGERTYPE);
+			CVarDeclTreeNode *TempVar = BuildTempVar(TOKTYPE_INTEGERTYPE);
 
 			CAssignExprTreeNode *TempVarAssign;
 			TempVarAssign = (CAssignExprTreeNode*)TreeNodeFactory->BuildAssignmentExpr(
 				TempVar->VarId->CreateCopy(), NewParm);
 
 			//add the new statements
-			Stmts->AddChild(TempVar);
-			Stmts->AddChild(TempVarAssign);
-
-			//add the new var to the symbol table
-			CSymbolTable::GetSingletonPtr()->AddSymbol(TempVarName, TempVar, 0, 
-				TOKTYPE_INTEGERTYPE);
+			Stmts->AddStmt(TempVar);
+			Stmts->AddStmt(TempVarAssign);
 
 			//replace the original parameter with a reference to the temp var
 			NewFuncCall->AddChild(TempVar->VarId->CreateCopy());
@@ -109,8 +105,10 @@ CTreeNode* CCallExprTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 CTreeNode* CCallExprTreeNode::CreateCopy(void)
 {
 	//create a new call_expr node to hold the arguments
-	CTreeNode *Copy;
-	Copy = CTreeNodeFactory::GetSingletonPtr()->BuildCallExpr(FuncName);
+	CCallExprTreeNode *Copy;
+	Copy = (CCallExprTreeNode*)CTreeNodeFactory::GetSingletonPtr()->BuildCallExpr(FuncName);
+	Copy->ExprType = ExprType;
+	Copy->Binding = Binding;
 
 	//add each parameter
 	for(unsigned int i = 0; i < GetNumChildren(); i++)
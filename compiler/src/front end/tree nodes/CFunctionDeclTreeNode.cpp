@@ -6,6 +6,7 @@
 
 #include "StdHeader.h"
 #include "CFunctionDeclTreeNode.h"
+#include "CXmlWriter.h"
 #include "CControlFlowGraph.h"
 #include "CSymbolTable.h"
 #include "CParameterDeclTreeNode.h"
@@ -20,36 +21,34 @@ CFunctionDeclTreeNode::CFunctionDeclTreeNode(void)
 	StackFrameSize = 0;
 
 	Name = "";
+	Binding = NULL;
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
-void CFunctionDeclTreeNode::DumpAsParseTreeNode(TiXmlElement *XmlNode)
+void CFunctionDeclTreeNode::DumpAsParseTreeNode(CXmlWriter &XmlOut)
 {
-	TiXmlElement *FnDeclNode;
-	FnDeclNode = XmlNode->InsertEndChild(TiXmlElement("function_decl"))->ToElement();
+	XmlOut.OpenElement("function_decl");
 
 	//name of the function
-	TiXmlElement *NameNode;
-	NameNode = FnDeclNode->InsertEndChild(TiXmlElement("name"))->ToElement();
-	NameNode->InsertEndChild(TiXmlText(Name.c_str()));
+	XmlOut.WriteElement("name", Name);
 
 	//return type
-	TiXmlElement *RetTypeNode;
-	RetTypeNode = FnDeclNode->InsertEndChild(TiXmlElement("return_type"))->ToElement();
-	RetTypeNode->InsertEndChild(TiXmlText(CUtilFuncs::TokenTypeToStr(RetType).c_str()));
+	XmlOut.WriteElement("return_type", CUtilFuncs::TokenTypeToStr(RetType));
 
 	//parameter list
-	TiXmlElement *ParmListNode;
-	ParmListNode = FnDeclNode->InsertEndChild(TiXmlElement("parameter_list"))->ToElement();
-	GetChild(FUNC_DECL_PARM_LIST)->DumpAsParseTreeNode(ParmListNode);
+	XmlOut.OpenElement("parameter_list");
+	GetChild(FUNC_DECL_PARM_LIST)->DumpAsParseTreeNode(XmlOut);
+	XmlOut.CloseElement();
 
 	//function body
-	TiXmlElement *StmtBody;
-	StmtBody = FnDeclNode->InsertEndChild(TiXmlElement("function_decl_body"))->ToElement();
+	XmlOut.OpenElement("function_decl_body");
 
-	for(unsigned int i = 1; i < GetNumChildren(); i++)
-		GetChild(i)->DumpAsParseTreeNode(StmtBody);
+	for(CTreeNode *Stmt = Body.Front(); Stmt; Stmt = Stmt->NextStmt)
+		Stmt->DumpAsParseTreeNode(XmlOut);
+
+	XmlOut.CloseElement();
+	XmlOut.CloseElement();
 }
 //-------------------------------------------------------------
 
@@ -63,10 +62,12 @@ CTreeNode* CFunctionDeclTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 	CTreeNode *NewMirFuncDecl = ParseTreeBuilder->BuildFunctionDecl("_" + Name, 
 		NumParameters, GetChild(FUNC_DECL_PARM_LIST)->CreateCopy(), RetType);
 
-	//add an entry for this function in the symbol table
-	CSymbolTable::GetSingletonPtr()->AddSymbol("_" + Name, NewMirFuncDecl, 0, RetType);
+	//point the symbol for this function at the new function decl so any 
+	//calls bound to it refer to the lowered function
+	SanityCheck(Binding);
+	Binding->IdPtr = NewMirFuncDecl;
 
-	//add each parameter to the symbol table
+	//and the same for each parameter
 	for(unsigned int i = 0; i < GetChild(FUNC_DECL_PARM_LIST)->GetNumChildren(); i++)
 	{
 		CParameterDeclTreeNode *Parm;
@@ -75,7 +76,8 @@ CTreeNode* CFunctionDeclTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 		Parm = (CParameterDeclTreeNode*)NewMirFuncDecl->GetChild(FUNC_DECL_PARM_LIST)->GetChild(i);
 		ParmName = (CIdentifierTreeNode*)Parm->GetChild(PARM_DECL_ID);
 
-		CSymbolTable::GetSingletonPtr()->AddSymbol(ParmName->IdName, Parm, 0, Parm->Type);
+		SanityCheck(ParmName->Binding);
+		ParmName->Binding->IdPtr = Parm;
 	}
 
 	//update the stack frame size according to the number of 
@@ -85,12 +87,12 @@ CTreeNode* CFunctionDeclTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 
 	//go through each statement in the function and convert it, using the newly
 	//created function decl as the parent for adding the statements to
-	for(unsigned int i = 1; i < GetNumChildren(); i++)
+	for(CTreeNode *Stmt = Body.Front(); Stmt; Stmt = Stmt->NextStmt)
 	{
-		CTreeNode *FuncBodyStmt = GetChild(i)->RewriteIntoMIRForm(NewMirFuncDecl);
+		CTreeNode *FuncBodyStmt = Stmt->RewriteIntoMIRForm(NewMirFuncDecl);
 
 		if(FuncBodyStmt)
-			NewMirFuncDecl->AddChild(FuncBodyStmt);
+			NewMirFuncDecl->AddStmt(FuncBodyStmt);
 	}
 
 	return NewMirFuncDecl;
@@ -106,13 +108,13 @@ void CFunctionDeclTreeNode::DumpAsMIRTreeNode(ofstream &OutFile)
 	OutFile << ") returns " << CUtilFuncs::TokenTypeToStr(RetType) << endl;
 
 	//dump the body
-	for(unsigned int i = 1; i < GetNumChildren(); i++)
+	for(CTreeNode *Stmt = Body.Front(); Stmt; Stmt = Stmt->NextStmt)
 	{
 		OutFile << "  ";
-		GetChild(i)->DumpAsMIRTreeNode(OutFile);
+		Stmt->DumpAsMIRTreeNode(OutFile);
 
 		//we dont need a semi-colon if we've just dumped a label
-		if(GetChild(i)->Code != TC_LABEL)
+		if(Stmt->Code != TC_LABEL)
 			OutFile << ";" << endl;
 	}
 
@@ -129,8 +131,8 @@ CTreeNode* CFunctionDeclTreeNode::CreateCopy(void)
 		Name, NumParameters, GetChild(FUNC_DECL_PARM_LIST)->CreateCopy(), RetType);
 
 	//copy the statements
-	for(unsigned int i = 1; i < GetNumChildren(); i++)
-		NewFnDecl->AddChild(GetChild(i)->CreateCopy());
+	for(CTreeNode *Stmt = Body.Front(); Stmt; Stmt = Stmt->NextStmt)
+		NewFnDecl->AddStmt(Stmt->CreateCopy());
 
 	return NewFnDecl;
 }
@@ -139,12 +141,24 @@ CTreeNode* CFunctionDeclTreeNode::CreateCopy(void)
 //-------------------------------------------------------------
 void CFunctionDeclTreeNode::DestroyNode()
 {
+	//the CFG is built in the same arena as we are
+	if(Arena != NA_HEAP)
+		return;
+
 	//clean up the CFG
 	list<BasicBlock_t*>::iterator itr = FuncCFG.begin();
 	for(; itr != FuncCFG.end(); itr++)
 		delete (*itr);
 
-	//clean up our children
+	//clean up the body and our children
+	Body.DestroyStmts();
 	CTreeNode::DestroyNode();
 }
 //-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CFunctionDeclTreeNode::AddStmt(CTreeNode *Stmt)
+{
+	Body.PushBack(Stmt);
+}
+//-------------------------------------------------------------
@@ -6,15 +6,12 @@
 
 #include "StdHeader.h"
 #include "CIdentifierTreeNode.h"
+#include "CXmlWriter.h"
 
 //-------------------------------------------------------------
-void CIdentifierTreeNode::DumpAsParseTreeNode(TiXmlElement *XmlNode)
+void CIdentifierTreeNode::DumpAsParseTreeNode(CXmlWriter &XmlOut)
 {
-	SanityCheck(XmlNode);
-
-	TiXmlElement *IdNode;
-	IdNode = XmlNode->InsertEndChild(TiXmlElement("identifier"))->ToElement();
-	IdNode->InsertEndChild(TiXmlText(IdName.c_str()));
+	XmlOut.WriteElement("identifier", IdName);
 }
 //-------------------------------------------------------------
 
@@ -35,6 +32,16 @@ CTreeNode* CIdentifierTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 //-------------------------------------------------------------
 CTreeNode* CIdentifierTreeNode::CreateCopy(void)
 {
-	return CTreeNodeFactory::GetSingletonPtr()->BuildIdentifier(IdName);
+	//identifiers aren't changed once they're built so the same
+	//one can appear any number of times within an arena
+	if(CTreeNodeFactory::GetSingletonPtr()->CanShareNode(this))
+		return this;
+
+	CIdentifierTreeNode *Copy;
+	Copy = (CIdentifierTreeNode*)CTreeNodeFactory::GetSingletonPtr()->BuildIdentifier(IdAtom);
+	Copy->ExprType = ExprType;
+	Copy->Binding = Binding;
+
+	return Copy;
 }
 //-------------------------------------------------------------
@@ -6,32 +6,36 @@
 
 #include "StdHeader.h"
 #include "CIfStmtTreeNode.h"
+#include "CXmlWriter.h"
 #include "CLabelTreeNode.h"
+#include "CConstantFolder.h"
 
 //-------------------------------------------------------------
-void CIfStmtTreeNode::DumpAsParseTreeNode(TiXmlElement *XmlNode)
+void CIfStmtTreeNode::DumpAsParseTreeNode(CXmlWriter &XmlOut)
 {
-	TiXmlElement *IfStmtNode;
-	IfStmtNode = XmlNode->InsertEndChild(TiXmlElement("if_stmt"))->ToElement();
+	XmlOut.OpenElement("if_stmt");
 
 	//add the conditional expr
-	TiXmlElement *CondExprNode;
-	CondExprNode = IfStmtNode->InsertEndChild(TiXmlElement("cond_expr"))->ToElement();
-	GetChild(IF_STMT_COND_EXPR)->DumpAsParseTreeNode(CondExprNode);
+	XmlOut.OpenElement("cond_expr");
+	GetChild(IF_STMT_COND_EXPR)->DumpAsParseTreeNode(XmlOut);
+	XmlOut.CloseElement();
 
 	//add the if stmt body
-	TiXmlElement *IfStmtBody;
-	IfStmtBody = IfStmtNode->InsertEndChild(TiXmlElement("if_stmt_body"))->ToElement();
+	XmlOut.OpenElement("if_stmt_body");
 
 	for(unsigned int i = 0; i < GetChild(IF_STMT_BODY)->GetNumChildren(); i++)
-		GetChild(IF_STMT_BODY)->GetChild(i)->DumpAsParseTreeNode(IfStmtBody);
+		GetChild(IF_STMT_BODY)->GetChild(i)->DumpAsParseTreeNode(XmlOut);
+
+	XmlOut.CloseElement();
 
 	//add the else stmt body
-	TiXmlElement *ElseStmtBody;
-	ElseStmtBody = IfStmtNode->InsertEndChild(TiXmlElement("else_stmt_body"))->ToElement();
+	XmlOut.OpenElement("else_stmt_body");
 
 	for(unsigned int i = 0; i < GetChild(IF_STMT_ELSE_BODY)->GetNumChildren(); i++)
-		GetChild(IF_STMT_ELSE_BODY)->GetChild(i)->DumpAsParseTreeNode(ElseStmtBody);
+		GetChild(IF_STMT_ELSE_BODY)->GetChild(i)->DumpAsParseTreeNode(XmlOut);
+
+	XmlOut.CloseElement();
+	XmlOut.CloseElement();
 }
 //-------------------------------------------------------------
 
@@ -65,109 +69,114 @@ CTreeNode* CIfStmtTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 	//here we turn a sequence of statements like
 	//  if(a > b)
 	//    <then_stmts>
-	//  else
-	//    <else_stmts>
 	//  end_if
-	//into:
-	//  if(a > b>
+	//into one which branches over the body on the opposite condition:
+	//  if(a <= b)
 	//    goto L1;
+	//  <then_stmts>
+	//  L1:
+	//
+	//and with an 'else' block, one which has the else block following the
+	//compare so either way only one jump is taken:
+	//  if(a > b)
+	//    goto L1;
+	//  <else_stmts>
 	//  goto L2;
 	//  L1: <then_stmts>
-	//  L2: <else_stmts>
-
-	//generate a new if stmt using the simplified condition expr, adding it
-	//to the IR
-	CTreeNode *NewCondExpr = NULL;
+	//  L2:
+	CTreeNodeFactory *TreeFactory = CTreeNodeFactory::GetSingletonPtr();
 
 	//simplify the conditional expr to build the new if stmt with
-	NewCondExpr = GetChild(IF_STMT_COND_EXPR)->RewriteIntoMIRForm(Stmts);
+	CTreeNode *NewCondExpr = GetChild(IF_STMT_COND_EXPR)->RewriteIntoMIRForm(Stmts);
 
 	//get rid of array references in code like "if(arr[0])"
 	if(NewCondExpr->Code == TC_ARRAY_REF)
 		NewCondExpr = ReplaceArrayRefs(NewCondExpr, Stmts);
 
-	//build a new if statement using the simplified conditional expr
-	CTreeNode *NewIfStmt = CTreeNodeFactory::GetSingletonPtr()->BuildIfStatement(NewCondExpr);
-	Stmts->AddChild(NewIfStmt);
+	bool HasElse = GetChild(IF_STMT_ELSE_BODY)->GetNumChildren() > 0;
 
-	//label names for the <then_stmts> and <else_stmts> jumps
-	string ThenLbl = CUtilFuncs::GenNewLabel();
-	string ElseLbl;
-	string EndOfElseLabel;
-
-	NewIfStmt->GetChild(IF_STMT_BODY)->AddChild(
-    CTreeNodeFactory::GetSingletonPtr()->BuildGotoExpr(ThenLbl));
+	//label marking the end of the entire 'if' statement
+	CTreeNode *EndLabel = TreeFactory->BuildLabel(CUtilFuncs::GenNewLabel());
+	const string &EndLbl = ((CLabelTreeNode*)EndLabel)->Name;
 
-	//label/goto expr tp the end of the if statement block or alternatively the
-	//else stmt block if one is present
-	CTreeNode *EndLabel = CTreeNodeFactory::GetSingletonPtr()->BuildLabel(
-                          CUtilFuncs::GenNewLabel());
-	CTreeNode *EndJump = CTreeNodeFactory::GetSingletonPtr()->BuildGotoExpr(
-                          ((CLabelTreeNode*)EndLabel)->Name);
+	//if the condition is known we don't need to compare anything, either
+	//fall into the 'then' block or jump straight past it
+	bool Taken;
 
-	//generate label for <else_stmts> if required
-	if(GetChild(IF_STMT_ELSE_BODY)->GetNumChildren() > 0)
+	if(CConstantFolder::FoldCondition(NewCondExpr, Taken))
 	{
-		//add a jump to the start of the 'else' block which will be executed if the
-		//cond_expr evaluated to false
-		ElseLbl = CUtilFuncs::GenNewLabel();
-		Stmts->AddChild(CTreeNodeFactory::GetSingletonPtr()->BuildGotoExpr(ElseLbl));
-	}
-	else
-	{
-		//add a jump before the beginning of the then stmts, this will be executed
-		//if the cond_expr evaluated to false, causing us not to execute the body
-		//of the if statement
-		Stmts->AddChild(EndJump);
-	}
+		string ElseLbl = HasElse ? CUtilFuncs::GenNewLabel() : EndLbl;
 
-	//process <then_stmts>
-	Stmts->AddChild(CTreeNodeFactory::GetSingletonPtr()->BuildLabel(ThenLbl));
-	for(unsigned int i = 0; i < GetChild(IF_STMT_BODY)->GetNumChildren(); i++)
-	{
-		CTreeNode *Temp = GetChild(IF_STMT_BODY)->GetChild(i)->RewriteIntoMIRForm(Stmts);
-		
-		//handle cases where we have a nested if which returns NULL from
-		//the MIR lowering
-		if(Temp)
-			Stmts->AddChild(Temp);
+		if(!Taken)
+			Stmts->AddStmt(TreeFactory->BuildGotoExpr(ElseLbl));
+
+		RewriteBodyIntoMIRForm(IF_STMT_BODY, Stmts);
+
+		if(HasElse)
+		{
+			Stmts->AddStmt(TreeFactory->BuildGotoExpr(EndLbl));
+			Stmts->AddStmt(TreeFactory->BuildLabel(ElseLbl));
+			RewriteBodyIntoMIRForm(IF_STMT_ELSE_BODY, Stmts);
+		}
+
+		Stmts->AddStmt(EndLabel);
+		return NULL;
 	}
 
-	//process <else_stmts>
-	if(ElseLbl.length() > 0)
+	//without an 'else' block, jump past the 'then' block when the condition
+	//is false so it falls thru from the compare
+	if(!HasElse)
 	{
-		//we'll reach the start of the 'else' block when we finish executing the 'then'
-		//block, causing us to execute statements in both the 'then' and 'else' blocks which
-		//is obviously not what we want so add a jump to the end of this block
-		Stmts->AddChild(EndJump);
-
-		//the following label marks the start of the 'else block of statements
-		Stmts->AddChild(CTreeNodeFactory::GetSingletonPtr()->BuildLabel(ElseLbl));
+		CTreeNode *InvCondExpr = CConstantFolder::InvertCondExpr(NewCondExpr);
 
-		//dump the 'else' statements
-		for(unsigned int i = 0; i < GetChild(IF_STMT_ELSE_BODY)->GetNumChildren(); i++)
+		if(InvCondExpr)
 		{
-			CTreeNode *Temp;
-			Temp = GetChild(IF_STMT_ELSE_BODY)->GetChild(i)->RewriteIntoMIRForm(Stmts);
-			
-			//if we've lowered a nested if stmt it will have returned NULL
-			//so make sure we dont ICE
-			if(Temp)
-				Stmts->AddChild(Temp);
+			CTreeNode *NewIfStmt = TreeFactory->BuildIfStatement(InvCondExpr);
+			NewIfStmt->GetChild(IF_STMT_BODY)->AddChild(TreeFactory->BuildGotoExpr(EndLbl));
+			Stmts->AddStmt(NewIfStmt);
+
+			RewriteBodyIntoMIRForm(IF_STMT_BODY, Stmts);
+			Stmts->AddStmt(EndLabel);
+			return NULL;
 		}
 	}
 
-	//label marking the end of the entire 'if' statement which is used
-	//a) as the target for the jump executed if the cond_expr evaluated to false
-	//   and we dont have an else block, or
-	//b) as the target for the jump at the end of the 'then' block to skip over
-	//   the 'else' block
-	Stmts->AddChild(EndLabel);
+	//otherwise jump to the 'then' block when the condition is true
+	string ThenLbl = CUtilFuncs::GenNewLabel();
+
+	CTreeNode *NewIfStmt = TreeFactory->BuildIfStatement(NewCondExpr);
+	NewIfStmt->GetChild(IF_STMT_BODY)->AddChild(TreeFactory->BuildGotoExpr(ThenLbl));
+	Stmts->AddStmt(NewIfStmt);
 
+	//the 'else' block follows the compare and jumps past the 'then' block
+	//when it's done. A condition which couldn't be inverted, such as testing
+	//a floating point var, has an empty 'else' block so just jumps past it
+	RewriteBodyIntoMIRForm(IF_STMT_ELSE_BODY, Stmts);
+	Stmts->AddStmt(TreeFactory->BuildGotoExpr(EndLbl));
+
+	Stmts->AddStmt(TreeFactory->BuildLabel(ThenLbl));
+	RewriteBodyIntoMIRForm(IF_STMT_BODY, Stmts);
+
+	Stmts->AddStmt(EndLabel);
 	return NULL;
 }
 //-------------------------------------------------------------
 
+//-------------------------------------------------------------
+void CIfStmtTreeNode::RewriteBodyIntoMIRForm(unsigned int Body, CTreeNode *Stmts)
+{
+	for(unsigned int i = 0; i < GetChild(Body)->GetNumChildren(); i++)
+	{
+		CTreeNode *Temp = GetChild(Body)->GetChild(i)->RewriteIntoMIRForm(Stmts);
+
+		//handle cases where we have a nested if which returns NULL from
+		//the MIR lowering
+		if(Temp)
+			Stmts->AddStmt(Temp);
+	}
+}
+//-------------------------------------------------------------
+
 //-------------------------------------------------------------
 CTreeNode* CIfStmtTreeNode::CreateCopy(void)
 {
@@ -6,25 +6,21 @@
 
 #include "StdHeader.h"
 #include "CLiteralTreeNode.h"
+#include "CXmlWriter.h"
 #include "CGlobalDataStore.h"
 
 //-------------------------------------------------------------
-void CLiteralTreeNode::DumpAsParseTreeNode(TiXmlElement *XmlNode)
+void CLiteralTreeNode::DumpAsParseTreeNode(CXmlWriter &XmlOut)
 {
-	SanityCheck(XmlNode);
-
-	TiXmlElement *LitNode;
-	LitNode = XmlNode->InsertEndChild(TiXmlElement("literal_node"))->ToElement();
+	XmlOut.OpenElement("literal_node");
 
 	//value
-	TiXmlElement *ValNode;
-	ValNode = LitNode->InsertEndChild(TiXmlElement("value"))->ToElement();
-	ValNode->InsertEndChild(TiXmlText(LitValue.c_str()));
+	XmlOut.WriteElement("value", LitValue);
 
 	//type
-	TiXmlElement *TypeNode;
-	TypeNode = LitNode->InsertEndChild(TiXmlElement("type"))->ToElement();
-	TypeNode->InsertEndChild(TiXmlText(CUtilFuncs::TokenTypeToStr(LitType).c_str()));
+	XmlOut.WriteElement("type", CUtilFuncs::TokenTypeToStr(LitType));
+
+	XmlOut.CloseElement();
 }
 //-------------------------------------------------------------
 
@@ -73,6 +69,10 @@ CTreeNode* CLiteralTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 //-------------------------------------------------------------
 CTreeNode* CLiteralTreeNode::CreateCopy(void)
 {
+	//literals are never changed so share them where we can
+	if(CTreeNodeFactory::GetSingletonPtr()->CanShareNode(this))
+		return this;
+
 	return CTreeNodeFactory::GetSingletonPtr()->BuildLiteral(LitValue, LitType);
 }
 //-------------------------------------------------------------
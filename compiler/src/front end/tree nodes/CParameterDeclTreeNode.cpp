@@ -6,30 +6,26 @@
 
 #include "StdHeader.h"
 #include "CParameterDeclTreeNode.h"
+#include "CXmlWriter.h"
 #include "CIdentifierTreeNode.h"
 
 //-------------------------------------------------------------
-void CParameterDeclTreeNode::DumpAsParseTreeNode(TiXmlElement *XmlNode)
+void CParameterDeclTreeNode::DumpAsParseTreeNode(CXmlWriter &XmlOut)
 {
-	TiXmlElement *ParmNode;
-	ParmNode = XmlNode->InsertEndChild(TiXmlElement("parm_decl"))->ToElement();
+	XmlOut.OpenElement("parm_decl");
 
 	//name
-	TiXmlElement *NameNode;
 	CIdentifierTreeNode *ParmName;
 	ParmName = (CIdentifierTreeNode*)GetChild(PARM_DECL_ID);
-	NameNode = ParmNode->InsertEndChild(TiXmlElement("name"))->ToElement();
-	NameNode->InsertEndChild(TiXmlText(ParmName->IdName.c_str()));
+	XmlOut.WriteElement("name", ParmName->IdName);
 
 	//type
-	TiXmlElement *TypeNode;
-	TypeNode = ParmNode->InsertEndChild(TiXmlElement("type"))->ToElement();
-	TypeNode->InsertEndChild(TiXmlText(CUtilFuncs::TokenTypeToStr(Type).c_str()));
+	XmlOut.WriteElement("type", CUtilFuncs::TokenTypeToStr(Type));
 
 	//is const or not
-	TiXmlElement *ConstNode;
-	ConstNode = ParmNode->InsertEndChild(TiXmlElement("is_const"))->ToElement();
-	ConstNode->InsertEndChild(TiXmlText(IsConst ? "true" : "false"));
+	XmlOut.WriteElement("is_const", IsConst ? "true" : "false");
+
+	XmlOut.CloseElement();
 }
 //-------------------------------------------------------------
 
@@ -54,7 +50,11 @@ CTreeNode* CParameterDeclTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 CTreeNode* CParameterDeclTreeNode::CreateCopy(void)
 {
 	CIdentifierTreeNode *Name = (CIdentifierTreeNode*)GetChild(PARM_DECL_ID);
-	return CTreeNodeFactory::GetSingletonPtr()->BuildParameterDecl(
+	CTreeNode *Copy = CTreeNodeFactory::GetSingletonPtr()->BuildParameterDecl(
 		Name->IdName, Type, IsConst, Position);
+
+	//the copy's name is bound to the same symbol
+	((CIdentifierTreeNode*)Copy->GetChild(PARM_DECL_ID))->Binding = Name->Binding;
+	return Copy;
 }
 //-------------------------------------------------------------
\ No newline at end of file
@@ -6,14 +6,13 @@
 
 #include "StdHeader.h"
 #include "CParameterListTreeNode.h"
+#include "CXmlWriter.h"
 
 //-------------------------------------------------------------
-void CParameterListTreeNode::DumpAsParseTreeNode(TiXmlElement *XmlNode)
+void CParameterListTreeNode::DumpAsParseTreeNode(CXmlWriter &XmlOut)
 {
-	SanityCheck(XmlNode);
-
 	for(unsigned int i = 0; i < GetNumChildren(); i++)
-		GetChild(i)->DumpAsParseTreeNode(XmlNode);
+		GetChild(i)->DumpAsParseTreeNode(XmlOut);
 }
 //-------------------------------------------------------------
 
@@ -6,14 +6,14 @@
 
 #include "StdHeader.h"
 #include "CReturnStmtTreeNode.h"
+#include "CXmlWriter.h"
 
 //-------------------------------------------------------------
-void CReturnStmtTreeNode::DumpAsParseTreeNode(TiXmlElement *XmlNode)
+void CReturnStmtTreeNode::DumpAsParseTreeNode(CXmlWriter &XmlOut)
 {
-	SanityCheck(XmlNode);
-	TiXmlElement *RetStmtNode;
-	RetStmtNode = XmlNode->InsertEndChild(TiXmlElement("return_stmt"))->ToElement();
-	GetChild(RET_STMT_RET_EXPR)->DumpAsParseTreeNode(RetStmtNode);
+	XmlOut.OpenElement("return_stmt");
+	GetChild(RET_STMT_RET_EXPR)->DumpAsParseTreeNode(XmlOut);
+	XmlOut.CloseElement();
 }
 //-------------------------------------------------------------
 
@@ -36,7 +36,7 @@ CTreeNode* CReturnStmtTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 	NewRetExpr = CTreeNodeFactory::GetSingletonPtr()->BuildReturnStmt(SimpRetExpr);
 
 	//add the new stmt and return it
-	//Stmts->AddChild(NewRetExpr);
+	//Stmts->AddStmt(NewRetExpr);
 	return NewRetExpr;
 }
 //-------------------------------------------------------------
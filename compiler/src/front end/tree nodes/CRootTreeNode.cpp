@@ -6,13 +6,14 @@
 
 #include "StdHeader.h"
 #include "CRootTreeNode.h"
+#include "CXmlWriter.h"
 
 //-------------------------------------------------------------
-void CRootTreeNode::DumpAsParseTreeNode(TiXmlElement *XmlNode)
+void CRootTreeNode::DumpAsParseTreeNode(CXmlWriter &XmlOut)
 {
 	//dump the tree
 	for(unsigned int i = 0; i < GetNumChildren(); i++)
-		GetChild(i)->DumpAsParseTreeNode(XmlNode);
+		GetChild(i)->DumpAsParseTreeNode(XmlOut);
 }
 //-------------------------------------------------------------
 
@@ -36,7 +37,7 @@ CTreeNode* CRootTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 	for(unsigned int i = 0; i < GetNumChildren(); i++)
 	{
 		CTreeNode *NewStmt = GetChild(i)->RewriteIntoMIRForm(Stmts);
-		Stmts->AddChild(NewStmt);
+		Stmts->AddStmt(NewStmt);
 	}
 
 	return Stmts;
@@ -0,0 +1,94 @@
+//------------------------------------------------------------------------------------------
+// File: CStmtList.cpp
+// Desc: Doubly linked list of statements threaded through the tree nodes themselves
+// Auth: Lee Millward
+//------------------------------------------------------------------------------------------
+
+#include "StdHeader.h"
+#include "CStmtList.h"
+#include "CTreeNode.h"
+
+//-------------------------------------------------------------
+void CStmtList::PushBack(CTreeNode *Stmt)
+{
+	InsertAfter(m_Tail, Stmt);
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CStmtList::InsertBefore(CTreeNode *Pos, CTreeNode *Stmt)
+{
+	//inserting before nothing adds to the end
+	if(!Pos)
+		InsertAfter(m_Tail, Stmt);
+	else
+		InsertAfter(Pos->PrevStmt, Stmt);
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CStmtList::InsertAfter(CTreeNode *Pos, CTreeNode *Stmt)
+{
+	SanityCheck(Stmt);
+
+	//the links belong to whichever list the statement is in
+	SanityCheck(!Stmt->PrevStmt && !Stmt->NextStmt && Stmt != m_Head);
+
+	CTreeNode *Next = Pos ? Pos->NextStmt : m_Head;
+
+	Stmt->PrevStmt = Pos;
+	Stmt->NextStmt = Next;
+
+	if(Pos)
+		Pos->NextStmt = Stmt;
+	else
+		m_Head = Stmt;
+
+	if(Next)
+		Next->PrevStmt = Stmt;
+	else
+		m_Tail = Stmt;
+
+	m_Size++;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CStmtList::Remove(CTreeNode *Stmt)
+{
+	SanityCheck(Stmt && m_Size > 0);
+
+	if(Stmt->PrevStmt)
+		Stmt->PrevStmt->NextStmt = Stmt->NextStmt;
+	else
+	{
+		SanityCheck(m_Head == Stmt);
+		m_Head = Stmt->NextStmt;
+	}
+
+	if(Stmt->NextStmt)
+		Stmt->NextStmt->PrevStmt = Stmt->PrevStmt;
+	else
+	{
+		SanityCheck(m_Tail == Stmt);
+		m_Tail = Stmt->PrevStmt;
+	}
+
+	Stmt->PrevStmt = NULL;
+	Stmt->NextStmt = NULL;
+	m_Size--;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CStmtList::DestroyStmts(void)
+{
+	while(m_Head)
+	{
+		CTreeNode *Stmt = m_Head;
+
+		Remove(Stmt);
+		Stmt->DestroyNode();
+	}
+}
+//-------------------------------------------------------------
@@ -12,18 +12,45 @@
 #include "CVarDeclTreeNode.h"
 #include "CArrayDeclTreeNode.h"
 #include "CArrayRefTreeNode.h"
+#include "CIdentifierTreeNode.h"
+
+//-------------------------------------------------------------
+CTreeNode::CTreeNode(void) : PrevStmt(NULL), NextStmt(NULL), Children(NULL), 
+	NumChildren(0), MaxChildren(0), FixedArity(false)
+{
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+CTreeNode::CTreeNode(CTreeNode **FixedChildren, unsigned int NumFixedChildren) 
+	: PrevStmt(NULL), NextStmt(NULL), Children(FixedChildren), NumChildren(0), 
+	MaxChildren(NumFixedChildren), FixedArity(true)
+{
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+CTreeNode::~CTreeNode(void)
+{
+	//the children themselves are destroyed by DestroyNode
+	if(!FixedArity)
+		delete [] Children;
+}
+//-------------------------------------------------------------
 
 //-------------------------------------------------------------
 void CTreeNode::DestroyNode(void)
 {
-	vector<CTreeNode*>::iterator itr = Children.begin();
+	//the arena frees this node and it's children in one go
+	if(Arena != NA_HEAP)
+		return;
 
-	for(; itr != Children.end(); itr++)
+	for(unsigned int i = 0; i < NumChildren; i++)
 	{
-		if(*itr)
+		if(Children[i])
 		{
-			(*itr)->DestroyNode();
-			(*itr) = NULL;
+			Children[i]->DestroyNode();
+			Children[i] = NULL;
 		}
 	}
 
@@ -37,23 +64,54 @@ void CTreeNode::AddChild(CTreeNode *NewChild, unsigned int Pos)
 	SanityCheck(NewChild);
 
 	if(Pos == -1)
-		Children.push_back(NewChild);
-	else
-		Children.insert(Children.begin() + Pos, NewChild);
+		Pos = NumChildren;
+
+	SanityCheck(Pos <= NumChildren);
+
+	//make room for the new child, nodes with a fixed number
+	//of children can't grow
+	if(NumChildren == MaxChildren)
+	{
+		SanityCheck(!FixedArity);
+
+		unsigned int NewMaxChildren = MaxChildren ? MaxChildren * 2 : 4;
+		CTreeNode **NewChildren = new CTreeNode*[NewMaxChildren];
+
+		for(unsigned int i = 0; i < NumChildren; i++)
+			NewChildren[i] = Children[i];
+
+		delete [] Children;
+		Children = NewChildren;
+		MaxChildren = NewMaxChildren;
+	}
+
+	//shuffle up anything after the insertion point
+	for(unsigned int i = NumChildren; i > Pos; i--)
+		Children[i] = Children[i - 1];
+
+	Children[Pos] = NewChild;
+	NumChildren++;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CTreeNode::AddStmt(CTreeNode *Stmt)
+{
+	AddChild(Stmt);
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
 unsigned int CTreeNode::GetNumChildren(void)
 {
-	return (unsigned int)Children.size();
+	return NumChildren;
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
 CTreeNode* CTreeNode::GetChild(unsigned int Id)
 {
-	SanityCheck(Id < Children.size());
+	SanityCheck(Id < NumChildren);
 	return Children[Id];
 }
 //-------------------------------------------------------------
@@ -61,7 +119,7 @@ CTreeNode* CTreeNode::GetChild(unsigned int Id)
 //-------------------------------------------------------------
 CTreeNode** CTreeNode::GetChildPtr(unsigned int Id)
 {
-	SanityCheck(Id < Children.size());
+	SanityCheck(Id < NumChildren);
 	return &Children[Id];
 }
 //-------------------------------------------------------------
@@ -72,28 +130,20 @@ CTreeNode* CTreeNode::ReplaceCallExpr(CTreeNode *Node, CTreeNode *Stmts)
 	if(Node->Code == TC_CALLEXPR)
 	{
 		CTreeNodeFactory *TreeFactory = CTreeNodeFactory::GetSingletonPtr();
-		CSymbolTable *SymTable = CSymbolTable::GetSingletonPtr();
 
 		//get the return type of the function so we create a temp var with
 		//the correct type
-		CCallExprTreeNode *CallExpr = (CCallExprTreeNode*)Node;
-		Symbol_t *FuncSym = SymTable->LookupIdentifier(CallExpr->FuncName, false);
-		SanityCheck(FuncSym);
-
-		CFunctionDeclTreeNode *FnDecl = (CFunctionDeclTreeNode*)FuncSym->IdPtr;
-		CVarDeclTreeNode *TempVar = (CVarDeclTreeNode*)TreeFactory->BuildVarDecl(
-			CUtilFuncs::GenCompilerTempName(), false, FnDecl->RetType);
+		CFunctionDeclTreeNode *FnDecl;
+		FnDecl = (CFunctionDeclTreeNode*)CUtilFuncs::GetDeclFromNode(Node);
+		CVarDeclTreeNode *TempVar = BuildTempVar(FnDecl->RetType);
 
 		//assign the value computed from the simplification of LHS of this expression
 		//to this temporary variable, adding it to the MIR tree
 		CTreeNode *AssignExpr = TreeFactory->BuildAssignmentExpr(
 			TempVar->VarId->CreateCopy(), Node);
 
-		Stmts->AddChild(TempVar);
-		Stmts->AddChild(AssignExpr);
-
-		CSymbolTable::GetSingletonPtr()->AddSymbol(TempVar->VarId->IdName,
-			TempVar, 0, TempVar->VarType);
+		Stmts->AddStmt(TempVar);
+		Stmts->AddStmt(AssignExpr);
 		
 		return TempVar->VarId->CreateCopy();
 	}
@@ -109,30 +159,23 @@ CTreeNode* CTreeNode::ReplaceArrayRefs(CTreeNode *Node, CTreeNode *Stmts)
 	if(Node->Code == TC_ARRAY_REF)
 	{
 		CTreeNodeFactory *TreeFactory = CTreeNodeFactory::GetSingletonPtr();
-		CSymbolTable *SymTable = CSymbolTable::GetSingletonPtr();
 
-		//get the return type of the function so we create a temp var with
+		//get the type of the array so we create a temp var with
 		//the correct type
 		CArrayRefTreeNode *ArrRef = (CArrayRefTreeNode*)Node;
-		Symbol_t *Sym = SymTable->LookupIdentifier(ArrRef->ArrName->IdName, false);
-		SanityCheck(Sym);
+		CArrayDeclTreeNode *ArrDecl;
+		ArrDecl = (CArrayDeclTreeNode*)CUtilFuncs::GetDeclFromNode(ArrRef->ArrName);
 
-		CArrayDeclTreeNode *ArrDecl = (CArrayDeclTreeNode*)Sym->IdPtr;
 		CVarDeclTreeNode *ArrVarDecl = (CVarDeclTreeNode*)ArrDecl->GetChild(ARR_DECL_VAR);
-
-		CVarDeclTreeNode *TempVar = (CVarDeclTreeNode*)TreeFactory->BuildVarDecl(
-			CUtilFuncs::GenCompilerTempName(), false, ArrVarDecl->VarType);
+		CVarDeclTreeNode *TempVar = BuildTempVar(ArrVarDecl->VarType);
 
 		//assign the value computed from the simplification of LHS of this expression
 		//to this temporary variable, adding it to the MIR tree
 		CTreeNode *AssignExpr = TreeFactory->BuildAssignmentExpr(
 			TempVar->VarId->CreateCopy(), Node);
 
-		Stmts->AddChild(TempVar);
-		Stmts->AddChild(AssignExpr);
-
-		CSymbolTable::GetSingletonPtr()->AddSymbol(TempVar->VarId->IdName,
-			TempVar, 0, TempVar->VarType);
+		Stmts->AddStmt(TempVar);
+		Stmts->AddStmt(AssignExpr);
 		
 		return TempVar->VarId->CreateCopy();
 	}
@@ -141,3 +184,18 @@ CTreeNode* CTreeNode::ReplaceArrayRefs(CTreeNode *Node, CTreeNode *Stmts)
 	return Node;
 }
 //-------------------------------------------------------------
+
+//-------------------------------------------------------------
+CVarDeclTreeNode* CTreeNode::BuildTempVar(TokenType Type)
+{
+	CVarDeclTreeNode *TempVar;
+	TempVar = (CVarDeclTreeNode*)CTreeNodeFactory::GetSingletonPtr()->BuildVarDecl(
+		CUtilFuncs::GenCompilerTempName(), false, Type);
+
+	//bind the name before anything gets the chance to copy it
+	TempVar->VarId->Binding = CSymbolTable::GetSingletonPtr()->AddSymbol(
+		TempVar->VarId->IdName, TempVar, 0, Type);
+
+	return TempVar;
+}
+//-------------------------------------------------------------
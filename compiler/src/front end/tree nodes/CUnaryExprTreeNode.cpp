@@ -6,24 +6,22 @@
 
 #include "StdHeader.h"
 #include "CunaryExprTreeNode.h"
+#include "CXmlWriter.h"
 
 //-------------------------------------------------------------
-void CUnaryExprTreeNode::DumpAsParseTreeNode(TiXmlElement *XmlNode)
+void CUnaryExprTreeNode::DumpAsParseTreeNode(CXmlWriter &XmlOut)
 {
-	SanityCheck(XmlNode);
-
-	TiXmlElement *ExpNode;
-	ExpNode = XmlNode->InsertEndChild(TiXmlElement("unary_expr"))->ToElement();
+	XmlOut.OpenElement("unary_expr");
 
 	//add the operator
-	TiXmlElement *OpNode;
-	OpNode = ExpNode->InsertEndChild(TiXmlElement("operator"))->ToElement();
-	OpNode->InsertEndChild(TiXmlText(CUtilFuncs::TokenTypeToStr(Operator).c_str()));
+	XmlOut.WriteElement("operator", CUtilFuncs::TokenTypeToStr(Operator));
 
 	//add the expr we're negating
-	TiXmlElement *LhsNode;
-	LhsNode = ExpNode->InsertEndChild(TiXmlElement("expr"))->ToElement();
-	GetChild(UNARY_EXPR_EXPR)->DumpAsParseTreeNode(LhsNode);
+	XmlOut.OpenElement("expr");
+	GetChild(UNARY_EXPR_EXPR)->DumpAsParseTreeNode(XmlOut);
+	XmlOut.CloseElement();
+
+	XmlOut.CloseElement();
 }
 //-------------------------------------------------------------
 
@@ -52,9 +50,10 @@ CTreeNode* CUnaryExprTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 CTreeNode* CUnaryExprTreeNode::CreateCopy(void)
 {
 	//create the new unary_expr node
-	CTreeNode *NewUnExpr;
-	NewUnExpr = CTreeNodeFactory::GetSingletonPtr()->BuildUnaryExpression(
+	CUnaryExprTreeNode *NewUnExpr;
+	NewUnExpr = (CUnaryExprTreeNode*)CTreeNodeFactory::GetSingletonPtr()->BuildUnaryExpression(
 									GetChild(UNARY_EXPR_EXPR)->CreateCopy(), Operator);
+	NewUnExpr->ExprType = ExprType;
 
 	return NewUnExpr;
 }
@@ -6,6 +6,7 @@
 
 #include "StdHeader.h"
 #include "CVarDeclTreeNode.h"
+#include "CXmlWriter.h"
 #include "CLiteralTreeNode.h"
 #include "CIdentifierTreeNode.h"
 #include "CUnaryExprTreeNode.h"
@@ -26,39 +27,31 @@ CVarDeclTreeNode::CVarDeclTreeNode(void)
 	AllocatedReg = REG_NONE;
 	StackFrameAddr = 0;
 	SpillPoint = 0;
-	DeclPoint;
+	DeclPoint = 0;
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
-void CVarDeclTreeNode::DumpAsParseTreeNode(TiXmlElement *XmlNode)
+void CVarDeclTreeNode::DumpAsParseTreeNode(CXmlWriter &XmlOut)
 {
-	TiXmlElement *VarDeclNode;
-	VarDeclNode = XmlNode->InsertEndChild(TiXmlElement("var_decl"))->ToElement();
+	XmlOut.OpenElement("var_decl");
 
 	//add the const attribute
-	TiXmlElement *ConstNode;
-	ConstNode = VarDeclNode->InsertEndChild(TiXmlElement("is_const"))->ToElement();
-
-	if(IsConst)
-		ConstNode->InsertEndChild(TiXmlText("true"));
-	else
-		ConstNode->InsertEndChild(TiXmlText("false"));
+	XmlOut.WriteElement("is_const", IsConst ? "true" : "false");
 
 	//add the type
-	TiXmlElement *TypeNode;
-	TypeNode = VarDeclNode->InsertEndChild(TiXmlElement("type"))->ToElement();
-	TypeNode->InsertEndChild(TiXmlText(CUtilFuncs::TokenTypeToStr(VarType).c_str()));
+	XmlOut.WriteElement("type", CUtilFuncs::TokenTypeToStr(VarType));
 
 	//add the initialisation expression (if any)
 	if(InitExpression)
 	{
-		TiXmlElement *InitNode;
-		InitNode = VarDeclNode->InsertEndChild(TiXmlElement("initialiser"))->ToElement();
-		InitExpression->DumpAsParseTreeNode(InitNode);
+		XmlOut.OpenElement("initialiser");
+		InitExpression->DumpAsParseTreeNode(XmlOut);
+		XmlOut.CloseElement();
 	}
 
-	VarId->DumpAsParseTreeNode(VarDeclNode);
+	VarId->DumpAsParseTreeNode(XmlOut);
+	XmlOut.CloseElement();
 }
 //-------------------------------------------------------------
 
@@ -84,6 +77,9 @@ void CVarDeclTreeNode::DumpAsMIRTreeNode(ofstream &OutFile)
 //-------------------------------------------------------------
 void CVarDeclTreeNode::DestroyNode(void)
 {
+	if(Arena != NA_HEAP)
+		return;
+
 	if(InitExpression)
 	{
 		InitExpression->DestroyNode();
@@ -111,8 +107,13 @@ CTreeNode* CVarDeclTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 	//copy across the global attribute
 	NewVarDecl->GlobalVar = GlobalVar;
 
-	//add the new var decl to the symbol table
-	CSymbolTable::GetSingletonPtr()->AddSymbol(VarId->IdName, NewVarDecl, 0, VarType);
+	//point the symbol the parser bound this variable to at the new var decl,
+	//any identifiers copied from the parse tree then refer to it
+	SanityCheck(VarId->Binding);
+	NewVarDecl->VarId->Binding = VarId->Binding;
+	VarId->Binding->IdPtr = NewVarDecl;
+	VarId->Binding->SymType = VarType;
+
 	CTreeNodeFactory *TreeNodeFactory = CTreeNodeFactory::GetSingletonPtr();
 
 	//convert the initialisation expression (if any)
@@ -176,7 +177,7 @@ CTreeNode* CVarDeclTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 			InternalError("unknown var decl init expression type");
 		}
 
-		Stmts->AddChild(NewVarDecl);
+		Stmts->AddStmt(NewVarDecl);
 		return AssignExpr;
 	}
 
@@ -193,6 +194,7 @@ CTreeNode* CVarDeclTreeNode::CreateCopy(void)
 		VarId->IdName, IsConst, VarType);
 
 	NewVarDecl->GlobalVar = GlobalVar;
+	NewVarDecl->VarId->Binding = VarId->Binding;
 	return NewVarDecl;
 }
 //-------------------------------------------------------------
@@ -216,8 +218,8 @@ CTreeNode* CVarDeclTreeNode::SimplifyUnaryInitExpr(CVarDeclTreeNode *NewVarDecl,
 		NewVarDecl->VarId->CreateCopy(), Expr);
 
 	//add the var decl, followed by the assignment expression
-	Stmts->AddChild(NewVarDecl);
-	Stmts->AddChild(AssignExpr);
+	Stmts->AddStmt(NewVarDecl);
+	Stmts->AddStmt(AssignExpr);
 
 	//generate a new unary expression, using the variable which
 	//is going to store the new value as the operand since this already
@@ -280,21 +282,16 @@ CTreeNode* CVarDeclTreeNode::SimplifyCallExprInitExpr(CTreeNode *InitExpr,
 	CTreeNode *AssignExpr;
 	CTreeNodeFactory *TreeNodeFactory = CTreeNodeFactory::GetSingletonPtr();
 
-	TempVar = (CVarDeclTreeNode*)TreeNodeFactory->BuildVarDecl(
-								CUtilFuncs::GenCompilerTempName(), false, VarType);
+	TempVar = BuildTempVar(VarType);
 
 	//simplify the call_expr
 	AssignExpr = TreeNodeFactory->BuildAssignmentExpr(
 		TempVar->VarId->CreateCopy(), InitExpr->RewriteIntoMIRForm(Stmts));
 
-	//add the temp var's symbol
-	CSymbolTable::GetSingletonPtr()->AddSymbol(TempVar->VarId->IdName,
-		TempVar, 0, VarType);
-
 	//add the new temp var and it's initialisation to the
 	//statement list
-	Stmts->AddChild(TempVar);
-	Stmts->AddChild(AssignExpr);
+	Stmts->AddStmt(TempVar);
+	Stmts->AddStmt(AssignExpr);
 
 	//assign the return value from the function to this variable
 	return TreeNodeFactory->BuildAssignmentExpr(
@@ -326,7 +323,7 @@ CTreeNode* CVarDeclTreeNode::SimplifyBooleanInitExpr(CTreeNode *InitExpr,
 		NewVarDecl->VarId->CreateCopy(), Expr);
 
 	//add the new var and lhs assignment stmts
-	Stmts->AddChild(NewVarDecl);
+	Stmts->AddStmt(NewVarDecl);
 	return LhsAssign;
 }
 //-------------------------------------------------------------
\ No newline at end of file
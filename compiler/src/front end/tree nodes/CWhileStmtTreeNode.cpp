@@ -6,26 +6,28 @@
 
 #include "StdHeader.h"
 #include "CWhileStmtTreeNode.h"
+#include "CXmlWriter.h"
 #include "CLabelTreeNode.h"
-#include "CGotoExprTreeNode.h"
+#include "CConstantFolder.h"
 
 //-------------------------------------------------------------
-void CWhileStmtTreeNode::DumpAsParseTreeNode(TiXmlElement *XmlNode)
+void CWhileStmtTreeNode::DumpAsParseTreeNode(CXmlWriter &XmlOut)
 {
-	TiXmlElement *IfStmtNode;
-	IfStmtNode = XmlNode->InsertEndChild(TiXmlElement("while_stmt"))->ToElement();
+	XmlOut.OpenElement("while_stmt");
 
 	//add the conditional expr
-	TiXmlElement *CondExprNode;
-	CondExprNode = IfStmtNode->InsertEndChild(TiXmlElement("cond_expr"))->ToElement();
-	GetChild(WHILE_STMT_COND_EXPR)->DumpAsParseTreeNode(CondExprNode);
+	XmlOut.OpenElement("cond_expr");
+	GetChild(WHILE_STMT_COND_EXPR)->DumpAsParseTreeNode(XmlOut);
+	XmlOut.CloseElement();
 
 	//add the body
-	TiXmlElement *StmtBody;
-	StmtBody = IfStmtNode->InsertEndChild(TiXmlElement("while_stmt_body"))->ToElement();
+	XmlOut.OpenElement("while_stmt_body");
 
 	for(unsigned int i = 1; i < GetNumChildren(); i++)
-		GetChild(i)->DumpAsParseTreeNode(StmtBody);
+		GetChild(i)->DumpAsParseTreeNode(XmlOut);
+
+	XmlOut.CloseElement();
+	XmlOut.CloseElement();
 }
 //-------------------------------------------------------------
 
@@ -43,46 +45,26 @@ CTreeNode* CWhileStmtTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 	//  while(a > 0)
 	//    <stmts>
 	//  end_while
-	//into:
-	//  L1: if(a > 0)
+	//into a guarded do..while loop:
+	//      if(a <= 0)
 	//        goto L2;
-	//      goto L3;
-	//  L2: <stmts>
-	//      goto L1;
-	//  L3:
+	//  L1: <stmts>
+	//      if(a > 0)
+	//        goto L1;
+	//  L2:
+	//the condition is lowered twice but only the test at the bottom of the
+	//loop is executed on each iteration
+	CTreeNodeFactory *TreeFactory = CTreeNodeFactory::GetSingletonPtr();
 
-	//add the header label
-	CTreeNode *HeaderLbl;
-	HeaderLbl = CTreeNodeFactory::GetSingletonPtr()->BuildLabel(CUtilFuncs::GenNewLabel());
-	Stmts->AddChild(HeaderLbl);
+	CTreeNode *BodyLbl = TreeFactory->BuildLabel(CUtilFuncs::GenNewLabel());
+	CTreeNode *EndLbl = TreeFactory->BuildLabel(CUtilFuncs::GenNewLabel());
 
-	//rewrite the loop condition into an if statement
-	CTreeNode *LoopCondExpr = GetChild(WHILE_STMT_COND_EXPR)->RewriteIntoMIRForm(Stmts);
+	//skip the loop entirely if the condition is false to begin with
+	AddLoopTest(false, ((CLabelTreeNode*)EndLbl)->Name, Stmts);
 
-	//build the if statement which tests the above cond_expr and a label (L1 in
-	//the above example) for it so we can jump back to the start of the loop after
-	//each iteration
-	CTreeNode *LoopIfStmt;
-  LoopIfStmt = CTreeNodeFactory::GetSingletonPtr()->BuildIfStatement(LoopCondExpr);
-  
-	//add the label and if_stmt to the IR
-	Stmts->AddChild(LoopIfStmt);
-
-	//the following jumps are to the start of the loop body, and to the
-	//end of <stmts> (L2 and L3 in the above example respectively)
-	CTreeNode *StmtStartJmp = CTreeNodeFactory::GetSingletonPtr()->BuildGotoExpr(
-															CUtilFuncs::GenNewLabel());
-	CTreeNode *StmtEndJmp = CTreeNodeFactory::GetSingletonPtr()->BuildGotoExpr(
-															CUtilFuncs::GenNewLabel());
-
-	//add the jump to the loop body to the if stmt, add the jump
-	//to the end of the loop to the IR after the if_stmt
-	LoopIfStmt->GetChild(IF_STMT_BODY)->AddChild(StmtStartJmp);
-	Stmts->AddChild(StmtEndJmp);
-
-	//create and add a label marking the start of <stmts>
-	Stmts->AddChild(CTreeNodeFactory::GetSingletonPtr()->BuildLabel(
-		((CGotoExprTreeNode*)StmtStartJmp)->Target));
+	//add the label marking the start of <stmts> which is where we jump
+	//back to after each iteration
+	Stmts->AddStmt(BodyLbl);
 
 	//add the statements forming the loop body
 	for(unsigned int i = 1; i < GetNumChildren(); i++)
@@ -92,23 +74,70 @@ CTreeNode* CWhileStmtTreeNode::RewriteIntoMIRForm(CTreeNode *Stmts)
 		//cope with nested while/if statements which return NULL 
 		//from MIR lowering
 		if(Temp)
-			Stmts->AddChild(Temp);
+			Stmts->AddStmt(Temp);
 	}
 
-	//add a jump back to the loop header to retest the condition
-	Stmts->AddChild(CTreeNodeFactory::GetSingletonPtr()->BuildGotoExpr(
-		((CLabelTreeNode*)HeaderLbl)->Name));
+	//retest the condition and go round again if it still holds
+	AddLoopTest(true, ((CLabelTreeNode*)BodyLbl)->Name, Stmts);
 
 	//add the label marking the end of the loop which we jump to when
-	//the condition evaluates to false
-	Stmts->AddChild(CTreeNodeFactory::GetSingletonPtr()->BuildLabel(
-		((CGotoExprTreeNode*)StmtEndJmp)->Target));
+	//the condition evaluates to false before the first iteration
+	Stmts->AddStmt(EndLbl);
 
   //nothing to return
 	return NULL;
 }
 //-------------------------------------------------------------
 
+//-------------------------------------------------------------
+void CWhileStmtTreeNode::AddLoopTest(bool JumpIfTrue, const string &Target, CTreeNode *Stmts)
+{
+	CTreeNodeFactory *TreeFactory = CTreeNodeFactory::GetSingletonPtr();
+
+	//rewrite the loop condition so we can test it
+	CTreeNode *LoopCondExpr = GetChild(WHILE_STMT_COND_EXPR)->RewriteIntoMIRForm(Stmts);
+
+	//if the condition is known either always jump or never jump
+	bool Taken;
+
+	if(CConstantFolder::FoldCondition(LoopCondExpr, Taken))
+	{
+		if(Taken == JumpIfTrue)
+			Stmts->AddStmt(TreeFactory->BuildGotoExpr(Target));
+
+		return;
+	}
+
+	//to jump when the condition is false, test the opposite condition
+	if(!JumpIfTrue)
+	{
+		CTreeNode *InvCondExpr = CConstantFolder::InvertCondExpr(LoopCondExpr);
+
+		if(InvCondExpr)
+		{
+			LoopCondExpr = InvCondExpr;
+			JumpIfTrue = true;
+		}
+	}
+
+	CTreeNode *LoopIfStmt = TreeFactory->BuildIfStatement(LoopCondExpr);
+	Stmts->AddStmt(LoopIfStmt);
+
+	if(JumpIfTrue)
+		LoopIfStmt->GetChild(IF_STMT_BODY)->AddChild(TreeFactory->BuildGotoExpr(Target));
+	else
+	{
+		//there's no exact opposite so jump over an unconditional jump to
+		//the target when the condition holds
+		string SkipLbl = CUtilFuncs::GenNewLabel();
+
+		LoopIfStmt->GetChild(IF_STMT_BODY)->AddChild(TreeFactory->BuildGotoExpr(SkipLbl));
+		Stmts->AddStmt(TreeFactory->BuildGotoExpr(Target));
+		Stmts->AddStmt(TreeFactory->BuildLabel(SkipLbl));
+	}
+}
+//-------------------------------------------------------------
+
 //-------------------------------------------------------------
 CTreeNode* CWhileStmtTreeNode::CreateCopy(void)
 {
@@ -0,0 +1,396 @@
+//------------------------------------------------------------------------------------------
+// File: CConstantFolder.cpp
+// Desc: Folds expressions whose value is known at compile time during MIR lowering
+// Auth: Lee Millward
+//------------------------------------------------------------------------------------------
+
+#include "StdHeader.h"
+#include "CConstantFolder.h"
+#include "CLiteralTreeNode.h"
+#include "CLiteralRefTreeNode.h"
+#include "CIdentifierTreeNode.h"
+#include "CBooleanExprTreeNode.h"
+#include "CVarDeclTreeNode.h"
+#include "CSymbolTable.h"
+
+#include <cerrno>
+#include <cfloat>
+#include <climits>
+
+//-------------------------------------------------------------
+CTreeNode* CConstantFolder::FoldArithExpr(CTreeNode *Lhs, CTreeNode *Rhs, TokenType Op,
+																					CTreeNode *Stmts)
+{
+	ConstValue_t LhsVal, RhsVal, Result;
+
+	if(!GetConstValue(Lhs, LhsVal) || !GetConstValue(Rhs, RhsVal))
+		return NULL;
+
+	if(!EvaluateArithOp(LhsVal, RhsVal, Op, Result))
+		return NULL;
+
+	return BuildConstant(Result, Stmts);
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+CTreeNode* CConstantFolder::FoldBooleanExpr(CTreeNode *Lhs, CTreeNode *Rhs, TokenType Op)
+{
+	ConstValue_t LhsVal, RhsVal, Diff;
+
+	if(!GetConstValue(Lhs, LhsVal) || !GetConstValue(Rhs, RhsVal))
+		return NULL;
+
+	//work it out the same way CBooleanExprTreeNode lowers it, relational
+	//operators compare a - b against 0, "and" tests a + b >= 2 and "or"
+	//tests a + b >= 1
+	TokenType CmpOp = Op;
+	int Bound = 0;
+
+	if(Op == TOKTYPE_AND || Op == TOKTYPE_OR)
+	{
+		CmpOp = TOKTYPE_GREATTHANEQ;
+		Bound = (Op == TOKTYPE_AND) ? 2 : 1;
+
+		if(!EvaluateArithOp(LhsVal, RhsVal, TOKTYPE_PLUS, Diff))
+			return NULL;
+	}
+	else if(!EvaluateArithOp(LhsVal, RhsVal, TOKTYPE_MINUS, Diff))
+		return NULL;
+
+	//-1, 0 or 1 depending on which side of the bound the value lies
+	int Sign;
+
+	if(Diff.IsFloat)
+		Sign = (Diff.FloatVal < Bound) ? -1 : (Diff.FloatVal > Bound ? 1 : 0);
+	else
+		Sign = (Diff.IntVal < Bound) ? -1 : (Diff.IntVal > Bound ? 1 : 0);
+
+	bool Result;
+
+	switch(CmpOp)
+	{
+	case TOKTYPE_LESSTHAN:    Result = Sign < 0; break;
+	case TOKTYPE_LESSTHANEQ:  Result = Sign <= 0; break;
+	case TOKTYPE_GREATTHAN:   Result = Sign > 0; break;
+	case TOKTYPE_GREATTHANEQ: Result = Sign >= 0; break;
+	case TOKTYPE_EQUALITY:    Result = Sign == 0; break;
+	case TOKTYPE_NOTEQ:       Result = Sign != 0; break;
+
+	default:
+		return NULL;
+	}
+
+	//the same value lowering a true or false literal gives, typed like
+	//every other integer the folder builds
+	return CTreeNodeFactory::GetSingletonPtr()->BuildLiteral(Result ? "1" : "0",
+		TOKTYPE_INTLITERAL);
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+CTreeNode* CConstantFolder::SimplifyArithExpr(CTreeNode *Lhs, CTreeNode *Rhs, TokenType Op)
+{
+	//find which side is the identifier and which the constant
+	CTreeNode *Var;
+	ConstValue_t Val;
+	bool ConstOnLhs;
+
+	if(Lhs->Code == TC_IDENTIFIER && GetConstValue(Rhs, Val))
+	{
+		Var = Lhs;
+		ConstOnLhs = false;
+	}
+	else if(Rhs->Code == TC_IDENTIFIER && GetConstValue(Lhs, Val))
+	{
+		Var = Rhs;
+		ConstOnLhs = true;
+	}
+	else
+		return NULL;
+
+	//the type of the expression comes from it's LHS so the identifier has to
+	//be the same type as the constant for the result to be unchanged
+	CIdentifierTreeNode *Id = (CIdentifierTreeNode*)Var;
+	SanityCheck(Id->Binding);
+
+	TokenType VarType = Id->Binding->SymType;
+
+	if(VarType != (Val.IsFloat ? TOKTYPE_FLOATTYPE : TOKTYPE_INTEGERTYPE))
+		return NULL;
+
+	bool IsZero = Val.IsFloat ? (Val.FloatVal == 0.0f) : (Val.IntVal == 0);
+	bool IsOne = Val.IsFloat ? (Val.FloatVal == 1.0f) : (Val.IntVal == 1);
+
+	//the value of a lowered expression is read into a temporary there and
+	//then but a plain identifier isn't read until the expression using it
+	//is worked out. A call further along the same expression could change
+	//a global in between, "g * 1 + f()", so only a local or parameter can
+	//take the place of the expression
+	Symbol_t *Sym = Id->Binding;
+	bool CanUseVar = !(Sym->IdPtr->Code == TC_VARDECL
+		&& ((CVarDeclTreeNode*)Sym->IdPtr)->GlobalVar);
+
+	switch(Op)
+	{
+	case TOKTYPE_PLUS:
+		//x + 0 and 0 + x
+		if(IsZero && CanUseVar)
+			return Var;
+		break;
+
+	case TOKTYPE_MINUS:
+		//x - 0
+		if(IsZero && !ConstOnLhs && CanUseVar)
+			return Var;
+		break;
+
+	case TOKTYPE_MULTIPLY:
+		//x * 1 and 1 * x
+		if(IsOne && CanUseVar)
+			return Var;
+
+		//x * 0 and 0 * x, not for floating point where x could be
+		//infinite or NaN
+		if(IsZero && !Val.IsFloat)
+			return CTreeNodeFactory::GetSingletonPtr()->BuildLiteral("0", TOKTYPE_INTLITERAL);
+		break;
+
+	case TOKTYPE_DIVIDE:
+		//x / 1
+		if(IsOne && !ConstOnLhs && CanUseVar)
+			return Var;
+		break;
+
+	default:
+		break;
+	}
+
+	return NULL;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+bool CConstantFolder::FoldCondition(CTreeNode *CondExpr, bool &Taken)
+{
+	ConstValue_t Val;
+
+	//a floating point condition is tested with fxam which also treats
+	//denormals as zero so leave those to the code generator
+	if(!GetConstValue(CondExpr, Val) || Val.IsFloat)
+		return false;
+
+	Taken = (Val.IntVal != 0);
+	return true;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+CTreeNode* CConstantFolder::InvertCondExpr(CTreeNode *CondExpr)
+{
+	if(CondExpr->Code == TC_BOOLEAN_EXPR)
+	{
+		//once lowered only the relational operators are left and each
+		//of those maps onto the complement of the other's jump
+		CBooleanExprTreeNode *BoolExpr = (CBooleanExprTreeNode*)CondExpr;
+
+		switch(BoolExpr->Operator)
+		{
+		case TOKTYPE_LESSTHAN:    BoolExpr->Operator = TOKTYPE_GREATTHANEQ; break;
+		case TOKTYPE_LESSTHANEQ:  BoolExpr->Operator = TOKTYPE_GREATTHAN; break;
+		case TOKTYPE_GREATTHAN:   BoolExpr->Operator = TOKTYPE_LESSTHANEQ; break;
+		case TOKTYPE_GREATTHANEQ: BoolExpr->Operator = TOKTYPE_LESSTHAN; break;
+		case TOKTYPE_EQUALITY:    BoolExpr->Operator = TOKTYPE_NOTEQ; break;
+		case TOKTYPE_NOTEQ:       BoolExpr->Operator = TOKTYPE_EQUALITY; break;
+
+		default:
+			return NULL;
+		}
+
+		return BoolExpr;
+	}
+
+	if(CondExpr->Code == TC_IDENTIFIER)
+	{
+		//if(var) is true when the var is non-zero so test for it being
+		//zero instead, floating point vars are tested with fxam which has
+		//no single opposite
+		CIdentifierTreeNode *Id = (CIdentifierTreeNode*)CondExpr;
+		SanityCheck(Id->Binding);
+
+		TokenType VarType = Id->Binding->SymType;
+
+		if(VarType != TOKTYPE_INTEGERTYPE && VarType != TOKTYPE_BOOLEANTYPE)
+			return NULL;
+
+		CTreeNodeFactory *TreeFactory = CTreeNodeFactory::GetSingletonPtr();
+
+		return TreeFactory->BuildBooleanExpression(CondExpr,
+			TreeFactory->BuildLiteral("0", TOKTYPE_INTLITERAL), TOKTYPE_EQUALITY);
+	}
+
+	return NULL;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+bool CConstantFolder::GetConstValue(CTreeNode *Node, ConstValue_t &Val)
+{
+	//floating point literals are only referred to once lowered
+	if(Node->Code == TC_LITERALREF)
+		Node = Node->GetChild(LITREF_LITERAL);
+
+	if(Node->Code != TC_LITERAL)
+		return false;
+
+	CLiteralTreeNode *Lit = (CLiteralTreeNode*)Node;
+	const char *Str = Lit->LitValue.c_str();
+	char *End;
+
+	//Boolean literals are lowered into 1 and 0
+	if(Lit->LitValue == "true" || Lit->LitValue == "false")
+	{
+		Val.IsFloat = false;
+		Val.IntVal = (Lit->LitValue == "true") ? 1 : 0;
+		return true;
+	}
+
+	switch(Lit->LitType)
+	{
+	case TOKTYPE_INTLITERAL:
+	case TOKTYPE_INTEGERTYPE:
+		{
+			//leave anything which doesn't fit in 32 bits to the assembler
+			errno = 0;
+			long IntVal = strtol(Str, &End, 10);
+
+			if(End == Str || *End || errno == ERANGE || IntVal < INT_MIN || IntVal > INT_MAX)
+				return false;
+
+			Val.IsFloat = false;
+			Val.IntVal = (int)IntVal;
+			return true;
+		}
+
+	case TOKTYPE_FLOATLITERAL:
+	case TOKTYPE_FLOATTYPE:
+		{
+			double FloatVal = strtod(Str, &End);
+
+			if(End == Str || *End || !(FloatVal >= -FLT_MAX && FloatVal <= FLT_MAX))
+				return false;
+
+			//the literal is stored in single precision
+			Val.IsFloat = true;
+			Val.FloatVal = (float)FloatVal;
+			return true;
+		}
+
+	default:
+		break;
+	}
+
+	return false;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+bool CConstantFolder::EvaluateArithOp(const ConstValue_t &Lhs, const ConstValue_t &Rhs,
+																			TokenType Op, ConstValue_t &Result)
+{
+	//mixing types is left to the code generator
+	if(Lhs.IsFloat != Rhs.IsFloat)
+		return false;
+
+	Result.IsFloat = Lhs.IsFloat;
+
+	if(Lhs.IsFloat)
+	{
+		//the FPU works in higher precision then the result is rounded when
+		//it's stored, double precision is enough to round the same way
+		double Val;
+		double L = Lhs.FloatVal;
+		double R = Rhs.FloatVal;
+
+		switch(Op)
+		{
+		case TOKTYPE_PLUS:     Val = L + R; break;
+		case TOKTYPE_MINUS:    Val = L - R; break;
+		case TOKTYPE_MULTIPLY: Val = L * R; break;
+
+		case TOKTYPE_DIVIDE:
+			if(R == 0.0)
+				return false;
+
+			Val = L / R;
+			break;
+
+		default:
+			return false;
+		}
+
+		if(!(Val >= -FLT_MAX && Val <= FLT_MAX))
+			return false;
+
+		Result.FloatVal = (float)Val;
+		return true;
+	}
+
+	//integer arithmetic wraps around the same as the 32 bit instructions
+	unsigned int L = (unsigned int)Lhs.IntVal;
+	unsigned int R = (unsigned int)Rhs.IntVal;
+
+	switch(Op)
+	{
+	case TOKTYPE_PLUS:     Result.IntVal = (int)(L + R); return true;
+	case TOKTYPE_MINUS:    Result.IntVal = (int)(L - R); return true;
+	case TOKTYPE_MULTIPLY: Result.IntVal = (int)(L * R); return true;
+
+	case TOKTYPE_DIVIDE:
+		//the generated code clears edx rather than sign extending into it
+		//before the idiv so it's only got the same result for a positive
+		//dividend
+		if(Rhs.IntVal == 0 || Lhs.IntVal < 0)
+			return false;
+
+		//rounds towards zero like idiv
+		Result.IntVal = Lhs.IntVal / Rhs.IntVal;
+		return true;
+
+	default:
+		break;
+	}
+
+	return false;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+CTreeNode* CConstantFolder::BuildConstant(const ConstValue_t &Val, CTreeNode *Stmts)
+{
+	char Buffer[32];
+
+	if(Val.IsFloat)
+	{
+		//enough digits to get the same value back, the assembler needs
+		//a decimal point to know it's floating point
+		sprintf(Buffer, "%.9g", Val.FloatVal);
+		string Str = Buffer;
+
+		if(Str.find('.') == string::npos)
+		{
+			string::size_type Exp = Str.find('e');
+			Str.insert(Exp == string::npos ? Str.length() : Exp, ".0");
+		}
+
+		//lowering the literal gives it a place in the data section
+		CTreeNode *Lit = CTreeNodeFactory::GetSingletonPtr()->BuildLiteral(Str,
+			TOKTYPE_FLOATLITERAL);
+
+		return Lit->RewriteIntoMIRForm(Stmts);
+	}
+
+	sprintf(Buffer, "%d", Val.IntVal);
+	return CTreeNodeFactory::GetSingletonPtr()->BuildLiteral(Buffer, TOKTYPE_INTLITERAL);
+}
+//-------------------------------------------------------------
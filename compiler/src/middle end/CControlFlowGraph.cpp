@@ -10,6 +10,66 @@
 #include "CLabelTreeNode.h"
 #include "CGotoExprTreeNode.h"
 
+//-------------------------------------------------------------
+void BasicBlock_t::ExtendToStmt(CTreeNode *Stmt)
+{
+	SanityCheck(Stmt && (!LastStmt || Stmt->PrevStmt == LastStmt));
+
+	if(!FirstStmt)
+		FirstStmt = Stmt;
+
+	LastStmt = Stmt;
+	NumStmts++;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void BasicBlock_t::InsertStmtBefore(CTreeNode *Pos, CTreeNode *Stmt)
+{
+	SanityCheck(Pos && NumStmts > 0);
+	FuncBody->InsertBefore(Pos, Stmt);
+
+	if(Pos == FirstStmt)
+		FirstStmt = Stmt;
+
+	NumStmts++;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void BasicBlock_t::InsertStmtAfter(CTreeNode *Pos, CTreeNode *Stmt)
+{
+	SanityCheck(Pos && NumStmts > 0);
+	FuncBody->InsertAfter(Pos, Stmt);
+
+	if(Pos == LastStmt)
+		LastStmt = Stmt;
+
+	NumStmts++;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void BasicBlock_t::RemoveStmt(CTreeNode *Stmt)
+{
+	SanityCheck(Stmt && NumStmts > 0);
+
+	//pull in whichever ends of the block the statement is on
+	if(Stmt == FirstStmt && Stmt == LastStmt)
+	{
+		FirstStmt = NULL;
+		LastStmt = NULL;
+	}
+	else if(Stmt == FirstStmt)
+		FirstStmt = Stmt->NextStmt;
+	else if(Stmt == LastStmt)
+		LastStmt = Stmt->PrevStmt;
+
+	FuncBody->Remove(Stmt);
+	NumStmts--;
+}
+//-------------------------------------------------------------
+
 //-------------------------------------------------------------
 void CControlFlowGraph::BuildControlFlowGraph(CFunctionDeclTreeNode **FnDecl, bool DumpGraph)
 {
@@ -29,28 +89,29 @@ void CControlFlowGraph::BuildControlFlowGraph(CFunctionDeclTreeNode **FnDecl, bo
 //-------------------------------------------------------------
 void CControlFlowGraph::FindBasicBlocks(CFunctionDeclTreeNode **FnDecl)
 {
+	CStmtList *Body = &(*FnDecl)->Body;
+
 	//the parser should have stripped out any empty functions
-	SanityCheck((*FnDecl)->GetNumChildren() > 0);
+	SanityCheck(!Body->Empty());
 
 	//go through the statements comprising the function and partition them
 	//into basic blocks
-	BasicBlock_t *CurrBlock = new BasicBlock_t;
+	BasicBlock_t *CurrBlock = BuildBasicBlock(Body);
 	BasicBlock_t *LastBlock = NULL;
 
 	CurrBlock->ExitBb = false;
 	unsigned int BbIdNo = 0;
 
-	//add the first statement, child 0 of a fndecl is the
-	//parameter list
-	CurrBlock->Stmts.push_back((*FnDecl)->GetChild(1));
+	//add the first statement
+	CurrBlock->ExtendToStmt(Body->Front());
 	CurrBlock->BbId = BbIdNo;
 
 	//process the remaining statements
-	for(unsigned int i = 2; i < (*FnDecl)->GetNumChildren(); i++)
+	for(CTreeNode *Stmt = Body->Front()->NextStmt; Stmt; Stmt = Stmt->NextStmt)
 	{
 		//if the current statement is not a leader, add it to the current block
-		if(!IsLeader((*FnDecl)->GetChild(i)))
-			CurrBlock->Stmts.push_back((*FnDecl)->GetChild(i));
+		if(!IsLeader(Stmt))
+			CurrBlock->ExtendToStmt(Stmt);
 		else
 		{
 			//add the current block to the list of bbs
@@ -58,15 +119,15 @@ void CControlFlowGraph::FindBasicBlocks(CFunctionDeclTreeNode **FnDecl)
 
 			//create a new block and add the current stmt to it
 			LastBlock = CurrBlock;
-			CurrBlock = new BasicBlock_t;
+			CurrBlock = BuildBasicBlock(Body);
 
 			CurrBlock->ExitBb = false;
 			CurrBlock->BbId = ++BbIdNo;
-			CurrBlock->Stmts.push_back((*FnDecl)->GetChild(i));
+			CurrBlock->ExtendToStmt(Stmt);
 
 			//if the last statement in the old block is not a jump, mark it as 
 			//a fall thru block and add the relevant edges
-			CTreeNode *LastStmt = LastBlock->Stmts.back();
+			CTreeNode *LastStmt = LastBlock->LastStmt;
 			if(LastStmt->Code != TC_GOTOEXPR)
 			{
 				//we have the potential to fall thru if the cond expr evaluates to false
@@ -82,7 +143,7 @@ void CControlFlowGraph::FindBasicBlocks(CFunctionDeclTreeNode **FnDecl)
 				{
 					CGotoExprTreeNode *CondGoto;
 					CondGoto = (CGotoExprTreeNode*)LastStmt->GetChild(IF_STMT_BODY)->GetChild(0);
-					m_Edges.insert(make_pair(CondGoto->Target, LastBlock));
+					m_Edges.insert(make_pair(CondGoto->TargetAtom, LastBlock));
 				}
 			}
 			else
@@ -90,7 +151,7 @@ void CControlFlowGraph::FindBasicBlocks(CFunctionDeclTreeNode **FnDecl)
 				//we've got a jump, use the jump target as the key for this 
 			  //basic block when we compute the graph's edges later on
 				CGotoExprTreeNode *GotoExpr = (CGotoExprTreeNode*)LastStmt;
-				m_Edges.insert(make_pair(GotoExpr->Target, LastBlock));
+				m_Edges.insert(make_pair(GotoExpr->TargetAtom, LastBlock));
 			}
 		}
 	}
@@ -99,7 +160,7 @@ void CControlFlowGraph::FindBasicBlocks(CFunctionDeclTreeNode **FnDecl)
 	(*FnDecl)->FuncCFG.push_back(CurrBlock);
 
 	//add an exit block along with an edge to the last block in the function
-	BasicBlock_t *ExitBlock = new BasicBlock_t;
+	BasicBlock_t *ExitBlock = BuildBasicBlock(Body);
 	ExitBlock->Predecessors.insert(CurrBlock);
 	CurrBlock->Successors.insert(ExitBlock);
 
@@ -109,6 +170,23 @@ void CControlFlowGraph::FindBasicBlocks(CFunctionDeclTreeNode **FnDecl)
 }
 //-------------------------------------------------------------
 
+//-------------------------------------------------------------
+BasicBlock_t* CControlFlowGraph::BuildBasicBlock(CStmtList *FuncBody)
+{
+	//blocks live as long as the MIR tree, so put them in the same arena
+	CMemoryArena *Arena = CTreeNodeFactory::GetSingletonPtr()->GetCurrentArena();
+	BasicBlock_t *Bb;
+
+	if(Arena)
+		Bb = Arena->Construct<BasicBlock_t>();
+	else
+		Bb = new BasicBlock_t;
+
+	Bb->FuncBody = FuncBody;
+	return Bb;
+}
+//-------------------------------------------------------------
+
 //-------------------------------------------------------------
 void CControlFlowGraph::ComputeEdges(CFunctionDeclTreeNode **FnDecl)
 {
@@ -117,7 +195,7 @@ void CControlFlowGraph::ComputeEdges(CFunctionDeclTreeNode **FnDecl)
 	for(; BbItr != --(*FnDecl)->FuncCFG.end(); BbItr++)
 	{
 		//get the first statement
-		CTreeNode *FirstStmt = *((*BbItr)->Stmts.begin());
+		CTreeNode *FirstStmt = (*BbItr)->FirstStmt;
 
 		//if the first statement is a label we've got a jump somewhere to
 		//it. Use the info we've gathered during finding the basic blocks to 
@@ -125,11 +203,11 @@ void CControlFlowGraph::ComputeEdges(CFunctionDeclTreeNode **FnDecl)
 		if(FirstStmt->Code == TC_LABEL)
 		{
 			//get the name of the label for the lookup
-			string LblName = ((CLabelTreeNode*)FirstStmt)->Name;
+			Atom LblName = ((CLabelTreeNode*)FirstStmt)->NameAtom;
 
 			//find out which blocks contains a jump to this label as the last stmt
 			//in their respective blocks and add the relevent edges beween them
-			multimap<string, BasicBlock_t*>::iterator EdgeItr;
+			multimap<Atom, BasicBlock_t*>::iterator EdgeItr;
 			for(EdgeItr = m_Edges.lower_bound(LblName); 
 				  EdgeItr != m_Edges.upper_bound(LblName); EdgeItr++)
 			{
@@ -139,7 +217,7 @@ void CControlFlowGraph::ComputeEdges(CFunctionDeclTreeNode **FnDecl)
 		}
 
 		//get the last stmt
-		CTreeNode *LastStmt = *(--(*BbItr)->Stmts.end());
+		CTreeNode *LastStmt = (*BbItr)->LastStmt;
 
 		//if the block terminates with a return stmt, add an edge to the exit block
 		if(LastStmt->Code == TC_RETURNSTMT)
@@ -155,9 +233,14 @@ void CControlFlowGraph::ComputeEdges(CFunctionDeclTreeNode **FnDecl)
 //-------------------------------------------------------------
 bool CControlFlowGraph::IsLeader(CTreeNode *Stmt)
 {
-	//leader statements are jumps and the targets of a jump
+	//leader statements are jumps, the targets of a jump and whatever
+	//follows a jump, an if stmt can fall thru to the next statement
+	//so it has to be the last one in it's block
+	CTreeNode *PrevStmt = Stmt->PrevStmt;
+
 	return Stmt->Code == TC_GOTOEXPR
-		|| Stmt->Code == TC_LABEL;
+		|| Stmt->Code == TC_LABEL
+		|| (PrevStmt && (PrevStmt->Code == TC_GOTOEXPR || PrevStmt->Code == TC_IFSTMT));
 }
 //-------------------------------------------------------------
 
@@ -199,11 +282,10 @@ void CControlFlowGraph::DumpControlFlowGraph(CFunctionDeclTreeNode *FnDecl)
 		DumpFile << ">" << endl;
 
 		//dump the statements which make up this block
-		BasicBlockStmtItr StmtItr = (*itr)->Stmts.begin();
-		for(; StmtItr != (*itr)->Stmts.end(); StmtItr++)
+		for(CTreeNode *Stmt = (*itr)->FirstStmt; Stmt; Stmt = (*itr)->GetNextStmt(Stmt))
 		{
 			DumpFile << "  ";
-			(*StmtItr)->DumpAsMIRTreeNode(DumpFile);
+			Stmt->DumpAsMIRTreeNode(DumpFile);
 			DumpFile << endl;
 		}
 
@@ -0,0 +1,336 @@
+//------------------------------------------------------------------------------------------
+// File: CCopyPropagator.cpp
+// Desc: Removes compiler temporaries which only pass a value on to somewhere else
+// Auth: Lee Millward
+//------------------------------------------------------------------------------------------
+
+#include "StdHeader.h"
+#include "CCopyPropagator.h"
+#include "CTreeNode.h"
+#include "CFunctionDeclTreeNode.h"
+#include "CVarDeclTreeNode.h"
+#include "CIdentifierTreeNode.h"
+#include "CSymbolTable.h"
+
+//-------------------------------------------------------------
+void CCopyPropagator::PropagateCopies(CFunctionDeclTreeNode *FnDecl)
+{
+	m_Body = &FnDecl->Body;
+	m_Refs.clear();
+
+	for(CTreeNode *Stmt = m_Body->Front(); Stmt; Stmt = Stmt->NextStmt)
+		CountRefs(Stmt, 1);
+
+	CTreeNode *Stmt = m_Body->Front();
+
+	while(Stmt)
+	{
+		//temporaries are declared right before they're first assigned
+		if(Stmt->Code == TC_VARDECL && GetTempSymbol(((CVarDeclTreeNode*)Stmt)->VarId))
+		{
+			CVarDeclTreeNode *TempDecl = (CVarDeclTreeNode*)Stmt;
+			CTreeNode *Next;
+
+			if(ForwardTemp(TempDecl, Next) || CoalesceTemp(TempDecl, Next)
+				 || RetargetTemp(TempDecl, Next))
+			{
+				Stmt = Next;
+				continue;
+			}
+		}
+
+		//we've finished with this statement so it's references are
+		//no longer ahead of us
+		CountRefs(Stmt, -1);
+		Stmt = Stmt->NextStmt;
+	}
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+bool CCopyPropagator::ForwardTemp(CVarDeclTreeNode *TempDecl, CTreeNode *&Next)
+{
+	Symbol_t *Temp = TempDecl->VarId->Binding;
+	CTreeNode *Def = TempDecl->NextStmt;
+
+	if(!IsAssignTo(Def, Temp))
+		return false;
+
+	//the temporary has to be assigned the once then read the once, by
+	//the very next statement so nothing can change it's value in between
+	CTreeNode *Use = Def->NextStmt;
+
+	if(!Use || m_Refs[Temp] != 2 || CountRefsTo(Use, Temp) != 1)
+		return false;
+
+	CTreeNode *Val = Def->GetChild(ASSIGN_EXPR_RHS);
+
+	if(!IsSameKindOfValue(Val, TempDecl))
+		return false;
+
+	//"T = <val>; <dest> = T" becomes "<dest> = <val>"
+	if(Use->Code == TC_ASSIGN_EXPR && GetTempSymbol(Use->GetChild(ASSIGN_EXPR_RHS)) == Temp)
+	{
+		CTreeNode *Dest = Use->GetChild(ASSIGN_EXPR_ID);
+		bool CanAssign = IsSameKindOfValue(Dest, TempDecl);
+
+		//the code generator can only store a simple value or another
+		//element to an array element
+		if(Dest->Code == TC_ARRAY_REF)
+		{
+			CanAssign = CanAssign && (Val->Code == TC_IDENTIFIER || Val->Code == TC_LITERAL
+				|| Val->Code == TC_LITERALREF || Val->Code == TC_ARRAY_REF);
+		}
+		else
+		{
+			CanAssign = CanAssign && (Val->Code == TC_IDENTIFIER || Val->Code == TC_LITERAL
+				|| Val->Code == TC_LITERALREF || Val->Code == TC_ARRAY_REF
+				|| Val->Code == TC_CALLEXPR);
+		}
+
+		if(CanAssign)
+		{
+			*Def->GetChildPtr(ASSIGN_EXPR_ID) = Dest;
+
+			//the arena frees the statements we've unlinked
+			m_Body->Remove(TempDecl);
+			m_Body->Remove(Use);
+			m_Refs[Temp] = 0;
+			Next = Def;
+
+			//"y = y" does nothing at all
+			if(Dest->Code == TC_IDENTIFIER && Val->Code == TC_IDENTIFIER
+				 && ((CIdentifierTreeNode*)Dest)->Binding == ((CIdentifierTreeNode*)Val)->Binding)
+			{
+				Next = Def->NextStmt;
+				CountRefs(Def, -1);
+				m_Body->Remove(Def);
+			}
+
+			return true;
+		}
+	}
+
+	//"T = y; <use of T>" becomes "<use of y>"
+	if(Val->Code == TC_IDENTIFIER)
+	{
+		ReplaceRefs(Use, Temp, Val);
+
+		m_Body->Remove(TempDecl);
+		m_Body->Remove(Def);
+		m_Refs[Temp] = 0;
+
+		Next = Use;
+		return true;
+	}
+
+	return false;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+bool CCopyPropagator::CoalesceTemp(CVarDeclTreeNode *TempDecl, CTreeNode *&Next)
+{
+	Symbol_t *Temp = TempDecl->VarId->Binding;
+	CTreeNode *Def = TempDecl->NextStmt;
+
+	if(!IsAssignTo(Def, Temp))
+		return false;
+
+	//look for "T2 = T1" where this is the last time T1 is read, after this
+	//the two are never live at the same time so can share a variable
+	CTreeNode *Src = Def->GetChild(ASSIGN_EXPR_RHS);
+	Symbol_t *SrcTemp = GetTempSymbol(Src);
+
+	if(!SrcTemp || SrcTemp == Temp || m_Refs[SrcTemp] != 1)
+		return false;
+
+	if(!IsSameKindOfValue(Src, TempDecl))
+		return false;
+
+	//rename the remaining references to T2, they all follow the copy
+	int Remaining = m_Refs[Temp] - 1;
+	Next = Def->NextStmt;
+
+	for(CTreeNode *Stmt = Next; Stmt && Remaining > 0; Stmt = Stmt->NextStmt)
+		Remaining -= ReplaceRefs(Stmt, Temp, Src);
+
+	SanityCheck(Remaining == 0);
+
+	m_Refs[SrcTemp] = m_Refs[Temp] - 1;
+	m_Refs[Temp] = 0;
+
+	m_Body->Remove(TempDecl);
+	m_Body->Remove(Def);
+
+	return true;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+bool CCopyPropagator::RetargetTemp(CVarDeclTreeNode *TempDecl, CTreeNode *&Next)
+{
+	Symbol_t *Temp = TempDecl->VarId->Binding;
+	CTreeNode *Def = TempDecl->NextStmt;
+
+	if(!IsAssignTo(Def, Temp))
+		return false;
+
+	//find the end of the statements working out the temporary's value,
+	//"T = y; T = T + 1", the one after has to be the only other reference
+	//to it and copy it to a variable, "x = T"
+	int Remaining = m_Refs[Temp];
+	CTreeNode *Use = Def;
+
+	for(; IsAssignTo(Use, Temp); Use = Use->NextStmt)
+	{
+		//a call could read the variable we're about to write before
+		//the copy would have, which is fine for a single statement
+		//but ForwardTemp's already dealt with those
+		if(Use->GetChild(ASSIGN_EXPR_RHS)->Code == TC_CALLEXPR)
+			return false;
+
+		Remaining -= CountRefsTo(Use, Temp);
+	}
+
+	if(!Use || Remaining != 1 || Use->Code != TC_ASSIGN_EXPR
+		 || GetTempSymbol(Use->GetChild(ASSIGN_EXPR_RHS)) != Temp)
+		return false;
+
+	CTreeNode *Dest = Use->GetChild(ASSIGN_EXPR_ID);
+
+	if(Dest->Code != TC_IDENTIFIER || !IsSameKindOfValue(Dest, TempDecl))
+		return false;
+
+	//the variable can be read to work out the first value, after that
+	//it's overwritten so mustn't be read again until the copy
+	Symbol_t *DestSym = ((CIdentifierTreeNode*)Dest)->Binding;
+	int DestRefs = 0;
+
+	for(CTreeNode *Stmt = Def->NextStmt; Stmt != Use; Stmt = Stmt->NextStmt)
+	{
+		if(CountRefsTo(Stmt, DestSym))
+			return false;
+	}
+
+	//"T = y; T = T + 1; x = T" becomes "x = y; x = x + 1"
+	for(CTreeNode *Stmt = Def; Stmt != Use; Stmt = Stmt->NextStmt)
+		DestRefs += ReplaceRefs(Stmt, Temp, Dest);
+
+	m_Refs[DestSym] += DestRefs - 1;
+	m_Refs[Temp] = 0;
+
+	m_Body->Remove(TempDecl);
+	m_Body->Remove(Use);
+	Next = Def;
+
+	//"x = x" does nothing at all
+	if(IsAssignTo(Def, DestSym) && Def->GetChild(ASSIGN_EXPR_RHS)->Code == TC_IDENTIFIER
+		 && ((CIdentifierTreeNode*)Def->GetChild(ASSIGN_EXPR_RHS))->Binding == DestSym)
+	{
+		Next = Def->NextStmt;
+		CountRefs(Def, -1);
+		m_Body->Remove(Def);
+	}
+
+	return true;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+bool CCopyPropagator::IsAssignTo(CTreeNode *Stmt, Symbol_t *Sym)
+{
+	if(!Stmt || Stmt->Code != TC_ASSIGN_EXPR)
+		return false;
+
+	CTreeNode *Lhs = Stmt->GetChild(ASSIGN_EXPR_ID);
+
+	return Lhs->Code == TC_IDENTIFIER && ((CIdentifierTreeNode*)Lhs)->Binding == Sym;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+Symbol_t* CCopyPropagator::GetTempSymbol(CTreeNode *Expr)
+{
+	if(Expr->Code != TC_IDENTIFIER)
+		return NULL;
+
+	CIdentifierTreeNode *Id = (CIdentifierTreeNode*)Expr;
+
+	if(!Id->Binding || !CUtilFuncs::IsCompilerTempName(Id->IdName))
+		return NULL;
+
+	//strings are only ever referred to by their address
+	if(Id->Binding->SymType == TOKTYPE_STRINGTYPE)
+		return NULL;
+
+	return Id->Binding;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CCopyPropagator::CountRefs(CTreeNode *Expr, int Delta)
+{
+	if(Expr->Code == TC_IDENTIFIER)
+	{
+		Symbol_t *Sym = ((CIdentifierTreeNode*)Expr)->Binding;
+
+		if(Sym)
+			m_Refs[Sym] += Delta;
+
+		return;
+	}
+
+	for(unsigned int i = 0; i < Expr->GetNumChildren(); i++)
+		CountRefs(Expr->GetChild(i), Delta);
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+unsigned int CCopyPropagator::CountRefsTo(CTreeNode *Expr, Symbol_t *Sym)
+{
+	if(Expr->Code == TC_IDENTIFIER)
+		return ((CIdentifierTreeNode*)Expr)->Binding == Sym ? 1 : 0;
+
+	unsigned int Count = 0;
+
+	for(unsigned int i = 0; i < Expr->GetNumChildren(); i++)
+		Count += CountRefsTo(Expr->GetChild(i), Sym);
+
+	return Count;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+unsigned int CCopyPropagator::ReplaceRefs(CTreeNode *Expr, Symbol_t *Sym, CTreeNode *With)
+{
+	unsigned int Count = 0;
+
+	for(unsigned int i = 0; i < Expr->GetNumChildren(); i++)
+	{
+		CTreeNode *Child = Expr->GetChild(i);
+
+		if(Child->Code == TC_IDENTIFIER)
+		{
+			if(((CIdentifierTreeNode*)Child)->Binding == Sym)
+			{
+				*Expr->GetChildPtr(i) = With->CreateCopy();
+				Count++;
+			}
+		}
+		else
+			Count += ReplaceRefs(Child, Sym, With);
+	}
+
+	return Count;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+bool CCopyPropagator::IsSameKindOfValue(CTreeNode *A, CTreeNode *B)
+{
+	//the code generator picks between integer and FPU instructions
+	return CUtilFuncs::ExprRefersToFloatingPointType(A)
+		== CUtilFuncs::ExprRefersToFloatingPointType(B);
+}
+//-------------------------------------------------------------
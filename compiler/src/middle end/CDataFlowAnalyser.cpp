@@ -48,145 +48,94 @@ void CDataFlowAnalyser::AnalyseFunction(CFunctionDeclTreeNode **FnDecl,
 void CDataFlowAnalyser::ComputeUseDefs(BasicBlock_t *Block)
 {
 	SanityCheck(Block);
+	m_CurrBlock = Block;
 
 	//scan each statement looking for definitions
-	list<CTreeNode*>::iterator StmtItr;
-	for(StmtItr = Block->Stmts.begin(); StmtItr != Block->Stmts.end(); StmtItr++)
+	for(CTreeNode *Stmt = Block->FirstStmt; Stmt; Stmt = Block->GetNextStmt(Stmt))
 	{
-		//grab the stmt
-		CTreeNode *Stmt = *StmtItr;
 		++m_CurrStmtNo;
+		Visit(Stmt);
+	}
+}
+//-------------------------------------------------------------
 
-		//filter out useless statements we're not interested in
-		if(Stmt->Code == TC_LABEL || Stmt->Code == TC_GOTOEXPR)
-			continue;
-
-		switch(Stmt->Code)
-		{
-		case TC_VARDECL:
-			{
-				CVarDeclTreeNode *VarDecl = (CVarDeclTreeNode*)Stmt;
-				VarDecl->DeclPoint = m_CurrStmtNo;
-				Block->DefinedVars.insert(VarDecl->VarId);
-				break;
-			}
-
-		case TC_ASSIGN_EXPR:
-			{
-				//find any uses on the RHS
-				ScanStmtForUses(Stmt->GetChild(ASSIGN_EXPR_RHS), Block);
-
-				//add the var being assigned to to the list of def vars, valid
-				//lvalues which could appear are identifiers and array references
-				if(Stmt->GetChild(ASSIGN_EXPR_ID)->Code == TC_IDENTIFIER)
-				{
-					Block->DefinedVars.insert((CIdentifierTreeNode*)Stmt->GetChild(ASSIGN_EXPR_ID));
-				}
-				else if(Stmt->GetChild(ASSIGN_EXPR_ID)->Code == TC_ARRAY_REF)
-					ScanStmtForUses(Stmt->GetChild(ASSIGN_EXPR_ID), Block);
-			
-				break;
-			}
-
-		case TC_RETURNSTMT:
-			{
-				ScanStmtForUses(Stmt->GetChild(RET_STMT_RET_EXPR), Block);
-				break;
-			}
-
-		case TC_IFSTMT:
-			{
-				ScanStmtForUses(Stmt->GetChild(IF_STMT_COND_EXPR), Block);
-				break;
-			}
+//-------------------------------------------------------------
+void CDataFlowAnalyser::VisitVarDecl(CVarDeclTreeNode *VarDecl)
+{
+	VarDecl->DeclPoint = m_CurrStmtNo;
+	m_CurrBlock->DefinedVars.insert(VarDecl->VarId);
+}
+//-------------------------------------------------------------
 
-		case TC_CALLEXPR:
-			{
-				//scan each parameter expr
-				for(unsigned int i = 0; i < Stmt->GetNumChildren(); i++)
-					ScanStmtForUses(Stmt->GetChild(i), Block);
-				break;
-			}
+//-------------------------------------------------------------
+void CDataFlowAnalyser::VisitAssignExpr(CAssignExprTreeNode *AssignExpr)
+{
+	CUseScanner Uses(m_CurrBlock);
 
-		case TC_ARRAYDECL:
-			{
-				//array decls live in the stack frame, not hard registers
-				//so dont mark it as defined
-				break;
-			}
+	//find any uses on the RHS
+	Uses.Visit(AssignExpr->GetChild(ASSIGN_EXPR_RHS));
 
-		case TC_BOOLEAN_EXPR:
-			{
-				ScanStmtForUses(Stmt->GetChild(BLN_EXPR_LHS), Block);
-				ScanStmtForUses(Stmt->GetChild(BLN_EXPR_RHS), Block);
-				break;
-			}
+	//add the var being assigned to to the list of def vars, valid
+	//lvalues which could appear are identifiers and array references
+	CTreeNode *Lhs = AssignExpr->GetChild(ASSIGN_EXPR_ID);
 
-		default:
-			InternalError("unhandled stmt type");
-		}
-	}
+	if(Lhs->Code == TC_IDENTIFIER)
+		m_CurrBlock->DefinedVars.insert((CIdentifierTreeNode*)Lhs);
+	else if(Lhs->Code == TC_ARRAY_REF)
+		Uses.Visit(Lhs);
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
-void CDataFlowAnalyser::ScanStmtForUses(CTreeNode *Stmt, BasicBlock_t *Block)
+void CDataFlowAnalyser::VisitReturnStmt(CReturnStmtTreeNode *RetStmt)
 {
-	SanityCheck(Stmt && Block);
-
-	//discard useless statements
-	if(Stmt->Code == TC_LITERAL || Stmt->Code == TC_LITERALREF)
-		return;
+	CUseScanner(m_CurrBlock).Visit(RetStmt->GetChild(RET_STMT_RET_EXPR));
+}
+//-------------------------------------------------------------
 
-	switch(Stmt->Code)
-	{
-	case TC_IDENTIFIER:
-		{
-			ScanIdentifierNodeForUses(Stmt, Block);
-			break;
-		}
+//-------------------------------------------------------------
+void CDataFlowAnalyser::VisitIfStmt(CIfStmtTreeNode *IfStmt)
+{
+	CUseScanner(m_CurrBlock).Visit(IfStmt->GetChild(IF_STMT_COND_EXPR));
+}
+//-------------------------------------------------------------
 
-	case TC_UNARY_EXPR:
-		{
-			ScanStmtForUses(Stmt->GetChild(UNARY_EXPR_EXPR), Block);
-			break;
-		}
+//-------------------------------------------------------------
+void CDataFlowAnalyser::VisitCallExpr(CCallExprTreeNode *CallExpr)
+{
+	//scan each parameter expr
+	CUseScanner(m_CurrBlock).VisitChildren(CallExpr);
+}
+//-------------------------------------------------------------
 
-	case TC_ARITH_EXPR:
-	case TC_BOOLEAN_EXPR:
-		{
-			//scan both sides of the expr for uses
-			ScanStmtForUses(Stmt->GetChild(ARITH_EXPR_LHS), Block);
-			ScanStmtForUses(Stmt->GetChild(ARITH_EXPR_RHS), Block);
-			break;
-		}
-	case TC_CALLEXPR:
-		{
-			//scan each parameter expr
-			for(unsigned int i = 0; i < Stmt->GetNumChildren(); i++)
-				ScanStmtForUses(Stmt->GetChild(i), Block);
-			break;
-		}
+//-------------------------------------------------------------
+void CDataFlowAnalyser::VisitArrayDecl(CArrayDeclTreeNode *ArrDecl)
+{
+	//array decls live in the stack frame, not hard registers
+	//so dont mark it as defined
+}
+//-------------------------------------------------------------
 
-	case TC_ARRAY_REF:
-		{
-			CArrayRefTreeNode *ArrRef = (CArrayRefTreeNode*)Stmt;
-			Block->UsedVars.insert(ArrRef->ArrName);
-			break;
-		}
+//-------------------------------------------------------------
+void CDataFlowAnalyser::VisitBooleanExpr(CBooleanExprTreeNode *Expr)
+{
+	CUseScanner Uses(m_CurrBlock);
+	Uses.Visit(Expr->GetChild(BLN_EXPR_LHS));
+	Uses.Visit(Expr->GetChild(BLN_EXPR_RHS));
+}
+//-------------------------------------------------------------
 
-	default:
-		InternalError("unhandled expr type");
-	}
+//-------------------------------------------------------------
+void CDataFlowAnalyser::VisitNode(CTreeNode *Node)
+{
+	InternalError("unhandled stmt type");
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
-void CDataFlowAnalyser::ScanIdentifierNodeForUses(CTreeNode *Id, BasicBlock_t *Block)
+void CUseScanner::VisitIdentifier(CIdentifierTreeNode *Id)
 {
-	SanityCheck(Id && Block);
-	CIdentifierTreeNode *IdNode = (CIdentifierTreeNode*)Id;
-	Symbol_t *Sym = CSymbolTable::GetSingletonPtr()->LookupIdentifier(IdNode->IdName, false);
+	Symbol_t *Sym = Id->Binding;
 	SanityCheck(Sym);
 
 	switch(Sym->IdPtr->Code)
@@ -195,17 +144,14 @@ void CDataFlowAnalyser::ScanIdentifierNodeForUses(CTreeNode *Id, BasicBlock_t *B
 	case TC_ARRAY_REF:
 		{
 			//nothing special here, just add the name to the list of used vars
-			Block->UsedVars.insert(IdNode);
+			m_Block->UsedVars.insert(Id);
 			return;
 		}
 
 	case TC_CALLEXPR:
 		{
 			//iterate through any parameters, checking them as we go
-			CCallExprTreeNode *CallExpr = (CCallExprTreeNode*)Sym->IdPtr;
-
-			for(unsigned int i = 0; i < CallExpr->GetNumChildren(); i++)
-				ScanStmtForUses(CallExpr->GetChild(i), Block);
+			VisitChildren(Sym->IdPtr);
 			return;
 		}
 
@@ -222,6 +168,54 @@ void CDataFlowAnalyser::ScanIdentifierNodeForUses(CTreeNode *Id, BasicBlock_t *B
 }
 //-------------------------------------------------------------
 
+//-------------------------------------------------------------
+void CUseScanner::VisitUnaryExpr(CUnaryExprTreeNode *Expr)
+{
+	Visit(Expr->GetChild(UNARY_EXPR_EXPR));
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CUseScanner::VisitArithExpr(CArithExprTreeNode *Expr)
+{
+	//scan both sides of the expr for uses
+	Visit(Expr->GetChild(ARITH_EXPR_LHS));
+	Visit(Expr->GetChild(ARITH_EXPR_RHS));
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CUseScanner::VisitBooleanExpr(CBooleanExprTreeNode *Expr)
+{
+	Visit(Expr->GetChild(BLN_EXPR_LHS));
+	Visit(Expr->GetChild(BLN_EXPR_RHS));
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CUseScanner::VisitCallExpr(CCallExprTreeNode *Expr)
+{
+	//scan each parameter expr
+	VisitChildren(Expr);
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CUseScanner::VisitArrayRef(CArrayRefTreeNode *Ref)
+{
+	//the index is needed to find the element so anything it reads is used too
+	m_Block->UsedVars.insert(Ref->ArrName);
+	Visit(Ref->GetChild(ARR_REF_INDEX));
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CUseScanner::VisitNode(CTreeNode *Node)
+{
+	InternalError("unhandled expr type");
+}
+//-------------------------------------------------------------
+
 //-------------------------------------------------------------
 void CDataFlowAnalyser::DumpDataFlowInformation(list<BasicBlock_t*> &Graph,
 																								string FuncName)
@@ -358,7 +352,7 @@ bool CDataFlowAnalyser::ComputeLiveOutForBlock(BasicBlock_t *Block)
 
 			if(Block->ValsLiveOnExit.empty()
 				 || !includes(Succ->ValsLiveOnEntry.begin(), Succ->ValsLiveOnEntry.end(),
-							Block->ValsLiveOnExit.begin(), Block->ValsLiveOnExit.end()))
+							Block->ValsLiveOnExit.begin(), Block->ValsLiveOnExit.end(), CompIdentifiers()))
 			{
 				//copy those values which are live on entry to the successor 
 				//block to the live on exit of this block
@@ -388,7 +382,7 @@ bool CDataFlowAnalyser::ComputeLiveOutForBlock(BasicBlock_t *Block)
 
 				set_union(LastBlock->ValsLiveOnEntry.begin(), LastBlock->ValsLiveOnEntry.end(),
 					CurrBlock->ValsLiveOnEntry.begin(), CurrBlock->ValsLiveOnEntry.end(),
-					InsItr);
+					InsItr, CompIdentifiers());
 
 				swap(CurrBlock, LastBlock);
 				BasicBlockItr Temp = ++SuccItr;
@@ -411,7 +405,7 @@ bool CDataFlowAnalyser::ComputeLiveOutForBlock(BasicBlock_t *Block)
 		//add any variables which appear in the live on entry but dont also appear
 		//in the live on exit to the current results set
 		set_difference(Block->ValsLiveOnEntry.begin(), Block->ValsLiveOnEntry.end(),
-			Block->DefinedVars.begin(), Block->DefinedVars.end(), InMinDefInsItr);
+			Block->DefinedVars.begin(), Block->DefinedVars.end(), InMinDefInsItr, CompIdentifiers());
 	}
 	else
 	{
@@ -432,15 +426,18 @@ bool CDataFlowAnalyser::ComputeLiveOutForBlock(BasicBlock_t *Block)
 
 	//copy the results to this blocks live on exit set if they're
 	//not in there already, we need this check otherwise we'll end
-	//up in an infinite loop for any block with more than one successor		
+	//up in an infinite loop for any block with more than one successor. 
+	//The sets only ever grow so it's only a change if something was added
 	if(!CompareSets(Block->ValsLiveOnExit, LiveOnExitResults)
 		 && !LiveOnExitResults.empty())
 	{
+		size_t OldSize = Block->ValsLiveOnExit.size();
+
 		insert_iterator< set<CIdentifierTreeNode*, CompIdentifiers> > ResInsItr(
 			Block->ValsLiveOnExit, Block->ValsLiveOnExit.begin());
 
 		copy(LiveOnExitResults.begin(), LiveOnExitResults.end(), ResInsItr);
-		RetVal = true;
+		RetVal = Block->ValsLiveOnExit.size() != OldSize;
 	}
 
 	return RetVal;
@@ -453,12 +450,12 @@ bool CDataFlowAnalyser::ComputeLiveInForBlock(BasicBlock_t *Block)
 	//solve in[n] = use[n] U (out[n] - def[n])
 
 	//compute out[n] - def[n]
-	set<CIdentifierTreeNode*> OutMinDefSet;
-	insert_iterator< set<CIdentifierTreeNode*> > OutMinInsItr(OutMinDefSet,
+	set<CIdentifierTreeNode*, CompIdentifiers> OutMinDefSet;
+	insert_iterator< set<CIdentifierTreeNode*, CompIdentifiers> > OutMinInsItr(OutMinDefSet,
 		OutMinDefSet.begin());
 
 	set_difference(Block->DefinedVars.begin(), Block->DefinedVars.end(),
-		Block->ValsLiveOnExit.begin(), Block->ValsLiveOnExit.end(), OutMinInsItr);
+		Block->ValsLiveOnExit.begin(), Block->ValsLiveOnExit.end(), OutMinInsItr, CompIdentifiers());
 
 	//compute use[n] U (out[n] - def[n]) where the results of
 	//def[n] - out[n] are stored in OutMinDefSet. Store the results
@@ -473,7 +470,7 @@ bool CDataFlowAnalyser::ComputeLiveInForBlock(BasicBlock_t *Block)
 			LiveInResults, LiveInResults.begin());
 
 		set_union(Block->UsedVars.begin(), Block->UsedVars.end(),
-			OutMinDefSet.begin(), OutMinDefSet.end(), ResInsItr);
+			OutMinDefSet.begin(), OutMinDefSet.end(), ResInsItr, CompIdentifiers());
 	}
 	else
 	{
@@ -487,12 +484,14 @@ bool CDataFlowAnalyser::ComputeLiveInForBlock(BasicBlock_t *Block)
 	//out set, copy them in
 	if(!CompareSets(Block->ValsLiveOnEntry, LiveInResults))
 	{
+		size_t OldSize = Block->ValsLiveOnEntry.size();
+
 		insert_iterator< set<CIdentifierTreeNode*, CompIdentifiers> > InsItr(
 			Block->ValsLiveOnEntry, Block->ValsLiveOnEntry.begin());
 
 		copy(LiveInResults.begin(), LiveInResults.end(), 
 			InsItr);
-		return true;
+		return Block->ValsLiveOnEntry.size() != OldSize;
 	}
 
 	return false;
@@ -520,7 +519,7 @@ bool CDataFlowAnalyser::CompareSets(set<CIdentifierTreeNode*, CompIdentifiers> &
 			CIdentifierTreeNode *IdOne = *SetOneItr;
 			CIdentifierTreeNode *IdTwo = *SetTwoItr;
 		
-			if(IdOne->IdName != IdTwo->IdName)
+			if(IdOne->IdAtom != IdTwo->IdAtom || IdOne->Binding != IdTwo->Binding)
 				RetValue = false;
 		}
 	}
@@ -0,0 +1,689 @@
+//------------------------------------------------------------------------------------------
+// File: CMirCache.cpp
+// Desc: On disk cache of lowered MIR trees, keyed by the source they were built from
+// Auth: Lee Millward
+//------------------------------------------------------------------------------------------
+
+#include "StdHeader.h"
+#include "CMirCache.h"
+#include "CGlobalDataStore.h"
+
+#include <windows.h>
+
+//-------------------------------------------------------------
+void CMirCollectArchive::SymbolRef(Symbol_t *&Sym)
+{
+	if(Sym && m_SymbolIds.find(Sym) == m_SymbolIds.end())
+	{
+		m_SymbolIds[Sym] = (int)m_Symbols.size();
+		m_Symbols.push_back(Sym);
+	}
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirCollectArchive::NodeList(list<CTreeNode*> &List)
+{
+	list<CTreeNode*>::iterator Itr;
+	for(Itr = List.begin(); Itr != List.end(); Itr++)
+		AddNode(*Itr);
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirCollectArchive::StmtList(CStmtList &List)
+{
+	for(CTreeNode *Stmt = List.Front(); Stmt; Stmt = Stmt->NextStmt)
+		AddNode(Stmt);
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirCollectArchive::AddNode(CTreeNode *Node)
+{
+	SanityCheck(Node);
+
+	if(m_NodeIds.find(Node) == m_NodeIds.end())
+	{
+		m_NodeIds[Node] = (int)m_Nodes.size();
+		m_Nodes.push_back(Node);
+	}
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirCollectArchive::AddReachable(bool FollowSymbols)
+{
+	CMirNodeTransfer<CMirCollectArchive> Transfer(*this);
+	unsigned int NextSymbol = 0;
+
+	//following a symbol can find more nodes and looking at those
+	//can find more symbols, keep going until nothing new turns up
+	do
+	{
+		for(; m_NextNode < m_Nodes.size(); m_NextNode++)
+		{
+			CTreeNode *Node = m_Nodes[m_NextNode];
+
+			for(unsigned int i = 0; i < Node->GetNumChildren(); i++)
+				AddNode(Node->GetChild(i));
+
+			Transfer.Visit(Node);
+		}
+
+		if(!FollowSymbols)
+			break;
+
+		for(; NextSymbol < m_Symbols.size(); NextSymbol++)
+			AddNode(m_Symbols[NextSymbol]->IdPtr);
+	}
+	while(m_NextNode < m_Nodes.size());
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+int CMirCollectArchive::GetNodeId(CTreeNode *Node)
+{
+	map<CTreeNode*, int>::iterator Itr = m_NodeIds.find(Node);
+	SanityCheck(Itr != m_NodeIds.end());
+	return Itr->second;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+int CMirCollectArchive::GetSymbolId(Symbol_t *Sym)
+{
+	map<Symbol_t*, int>::iterator Itr = m_SymbolIds.find(Sym);
+	SanityCheck(Itr != m_SymbolIds.end());
+	return Itr->second;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirWriteArchive::Int(int &Val)
+{
+	m_Buffer.append((const char*)&Val, sizeof(int));
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirWriteArchive::Bool(bool &Val)
+{
+	m_Buffer.push_back(Val ? 1 : 0);
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirWriteArchive::Str(string &Val)
+{
+	int Len = (int)Val.length();
+	Int(Len);
+	m_Buffer.append(Val);
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirWriteArchive::StringMap(map<string, string> &Map)
+{
+	int Count = (int)Map.size();
+	Int(Count);
+
+	map<string, string>::iterator Itr;
+	for(Itr = Map.begin(); Itr != Map.end(); Itr++)
+	{
+		string Key = Itr->first;
+		Str(Key);
+		Str(Itr->second);
+	}
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirWriteArchive::StringList(vector<string> &List)
+{
+	int Count = (int)List.size();
+	Int(Count);
+
+	for(unsigned int i = 0; i < List.size(); i++)
+		Str(List[i]);
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirWriteArchive::NodeList(list<CTreeNode*> &List)
+{
+	int Count = (int)List.size();
+	Int(Count);
+
+	list<CTreeNode*>::iterator Itr;
+	for(Itr = List.begin(); Itr != List.end(); Itr++)
+		NodeRef(*Itr);
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirWriteArchive::StmtList(CStmtList &List)
+{
+	int Count = (int)List.Size();
+	Int(Count);
+
+	for(CTreeNode *Stmt = List.Front(); Stmt; Stmt = Stmt->NextStmt)
+		NodeRef(Stmt);
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirWriteArchive::SymbolRef(Symbol_t *&Sym)
+{
+	int Id = Sym ? m_Ids.GetSymbolId(Sym) : -1;
+	Int(Id);
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirReadArchive::Int(int &Val)
+{
+	memcpy(&Val, Advance(sizeof(int)), sizeof(int));
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirReadArchive::Bool(bool &Val)
+{
+	Val = (*Advance(1) != 0);
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirReadArchive::Str(string &Val)
+{
+	int Len;
+	Int(Len);
+
+	if(Len < 0)
+		InternalError("corrupt MIR cache file");
+
+	Val.assign(Advance(Len), Len);
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirReadArchive::StringMap(map<string, string> &Map)
+{
+	int Count;
+	Int(Count);
+	Map.clear();
+
+	for(int i = 0; i < Count; i++)
+	{
+		string Key, Value;
+		Str(Key);
+		Str(Value);
+		Map.insert(make_pair(Key, Value));
+	}
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirReadArchive::StringList(vector<string> &List)
+{
+	int Count;
+	Int(Count);
+	List.clear();
+
+	for(int i = 0; i < Count; i++)
+	{
+		string Value;
+		Str(Value);
+		List.push_back(Value);
+	}
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirReadArchive::NodeList(list<CTreeNode*> &List)
+{
+	int Count;
+	Int(Count);
+	List.clear();
+
+	for(int i = 0; i < Count; i++)
+	{
+		CTreeNode *Node;
+		NodeRef(Node);
+		List.push_back(Node);
+	}
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirReadArchive::StmtList(CStmtList &List)
+{
+	int Count;
+	Int(Count);
+	SanityCheck(List.Empty());
+
+	for(int i = 0; i < Count; i++)
+	{
+		CTreeNode *Stmt;
+		NodeRef(Stmt);
+
+		if(!Stmt)
+			InternalError("corrupt MIR cache file");
+
+		List.PushBack(Stmt);
+	}
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirReadArchive::SymbolRef(Symbol_t *&Sym)
+{
+	int Id;
+	Int(Id);
+
+	if(Id < -1 || Id >= (int)m_Symbols.size())
+		InternalError("corrupt MIR cache file");
+
+	Sym = (Id == -1) ? NULL : m_Symbols[Id];
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+CTreeNode* CMirReadArchive::GetNode(int Id)
+{
+	if(Id < -1 || Id >= (int)m_Nodes.size())
+		InternalError("corrupt MIR cache file");
+
+	return (Id == -1) ? NULL : m_Nodes[Id];
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+const char* CMirReadArchive::Advance(size_t Len)
+{
+	if(Len > m_Size - m_Pos)
+		InternalError("corrupt MIR cache file");
+
+	const char *Start = m_Data + m_Pos;
+	m_Pos += Len;
+	return Start;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+CMirCache::CMirCache(const string &CacheDir)
+{
+	m_CacheDir = CacheDir;
+	m_KeyValid = false;
+	m_Hit = false;
+	m_NumHits = 0;
+	m_NumMisses = 0;
+
+	m_MappedFile = NULL;
+	m_FileMapping = NULL;
+	m_MappedView = NULL;
+	m_MappedSize = 0;
+
+	//this fails if the directory's already there, which is fine
+	CreateDirectory(m_CacheDir.c_str(), NULL);
+
+	//pick up the totals from earlier runs
+	ifstream StatsFile((m_CacheDir + "/stats.txt").c_str());
+
+	if(StatsFile.is_open())
+		StatsFile >> m_NumHits >> m_NumMisses;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+CMirCache::~CMirCache(void)
+{
+	UnmapFile();
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+CTreeNode* CMirCache::Lookup(const string &SourceFile)
+{
+	CTreeNode *MirTree = NULL;
+	m_KeyValid = ComputeKey(SourceFile);
+
+	//the atoms have to come out the same as when the tree was saved so
+	//nothing can have been added to the table before we load them
+	if(m_KeyValid && CAtomTable::GetSingletonPtr()->GetNumAtoms() == 0 &&
+	   MapFile(GetCacheFileName()) && m_MappedView)
+	{
+		MirTree = LoadTree(m_MappedView, m_MappedSize);
+	}
+
+	UnmapFile();
+	UpdateStatistics(MirTree != NULL);
+
+	return MirTree;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirCache::Store(CTreeNode *MirTree)
+{
+	if(!m_KeyValid || m_Hit)
+		return;
+
+	//find everything that needs saving. The global variables belong to
+	//CGlobalDataStore rather than the MIR arena so they're added first,
+	//that way we know which nodes to rebuild outside of the arena
+	CGlobalDataStore *GlobalStore = CGlobalDataStore::GetSingletonPtr();
+	CMirCollectArchive Collect;
+
+	GlobalStore->Transfer(Collect);
+	Collect.AddReachable(false);
+	int NumHeapNodes = (int)Collect.GetNodes().size();
+
+	Collect.AddNode(MirTree);
+	Collect.AddReachable(true);
+
+	const vector<CTreeNode*> &Nodes = Collect.GetNodes();
+	const vector<Symbol_t*> &Symbols = Collect.GetSymbols();
+
+	//now write it all out, starting with the key
+	CMirWriteArchive Ar(Collect);
+	TransferHeader(Ar);
+
+	//every atom, in order, so they get the same values when loaded
+	CAtomTable *AtomTable = CAtomTable::GetSingletonPtr();
+	int NumAtoms = (int)AtomTable->GetNumAtoms();
+	Ar.Int(NumAtoms);
+
+	for(int i = 0; i < NumAtoms; i++)
+	{
+		string Name = AtomTable->GetName(i);
+		Ar.Str(Name);
+	}
+
+	//the type of each node so they can all be created before any are read
+	int NumNodes = (int)Nodes.size();
+	Ar.Int(NumNodes);
+	Ar.Int(NumHeapNodes);
+
+	for(int i = 0; i < NumNodes; i++)
+		Ar.Enum(Nodes[i]->Code);
+
+	//the symbols
+	int NumSymbols = (int)Symbols.size();
+	Ar.Int(NumSymbols);
+
+	for(int i = 0; i < NumSymbols; i++)
+		TransferSymbol(Ar, *Symbols[i]);
+
+	//then each node's children and attributes
+	CMirNodeTransfer<CMirWriteArchive> Transfer(Ar);
+
+	for(int i = 0; i < NumNodes; i++)
+	{
+		int NumChildren = (int)Nodes[i]->GetNumChildren();
+		Ar.Int(NumChildren);
+
+		for(int j = 0; j < NumChildren; j++)
+		{
+			CTreeNode *Child = Nodes[i]->GetChild(j);
+			Ar.NodeRef(Child);
+		}
+
+		Transfer.Visit(Nodes[i]);
+	}
+
+	Ar.NodeRef(MirTree);
+	GlobalStore->Transfer(Ar);
+
+	//write to a temporary file first so a half written cache file
+	//never has the name of a real one
+	string CacheFile = GetCacheFileName();
+	string TempFile = CacheFile + ".tmp";
+
+	ofstream OutFile(TempFile.c_str(), ios::out | ios::binary | ios::trunc);
+
+	if(!OutFile.is_open())
+		return;
+
+	OutFile.write(Ar.GetBuffer().data(), (streamsize)Ar.GetBuffer().size());
+	OutFile.close();
+
+	remove(CacheFile.c_str());
+	rename(TempFile.c_str(), CacheFile.c_str());
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirCache::ReportStatistics(void)
+{
+	cout << "MIR cache " << (m_Hit ? "hit" : "miss") << " (" << m_NumHits << " hits, ";
+	cout << m_NumMisses << " misses)" << endl;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+CTreeNode* CMirCache::LoadTree(const char *Data, size_t Size)
+{
+	CMirReadArchive Ar(Data, Size);
+
+	if(!TransferHeader(Ar))
+		return NULL;
+
+	//the atom table is empty so each name gets back the atom it had
+	CAtomTable *AtomTable = CAtomTable::GetSingletonPtr();
+	int NumAtoms;
+	Ar.Int(NumAtoms);
+
+	for(int i = 0; i < NumAtoms; i++)
+	{
+		string Name;
+		Ar.Str(Name);
+		AtomTable->Intern(Name);
+	}
+
+	//create every node up front so they can refer to each other in any
+	//order, the global variables are rebuilt outside of the MIR arena
+	CTreeNodeFactory *TreeNodeFactory = CTreeNodeFactory::GetSingletonPtr();
+	NodeArena PrevArena = TreeNodeFactory->GetNodeArena();
+	int NumNodes, NumHeapNodes;
+
+	Ar.Int(NumNodes);
+	Ar.Int(NumHeapNodes);
+
+	if(NumNodes < 0 || NumHeapNodes < 0 || NumHeapNodes > NumNodes)
+		InternalError("corrupt MIR cache file");
+
+	vector<CTreeNode*> Nodes(NumNodes);
+
+	for(int i = 0; i < NumNodes; i++)
+	{
+		TreeCode Code;
+		Ar.Enum(Code);
+
+		TreeNodeFactory->UseNodeArena(i < NumHeapNodes ? NA_HEAP : NA_MIR);
+		Nodes[i] = TreeNodeFactory->BuildEmptyNode(Code);
+	}
+
+	TreeNodeFactory->UseNodeArena(PrevArena);
+	Ar.SetNodes(Nodes);
+
+	//the symbols don't go in any scope as nothing is looked up by name
+	//from here on, the trees just follow their bindings
+	CSymbolTable *SymTable = CSymbolTable::GetSingletonPtr();
+	vector<Symbol_t*> Symbols;
+	int NumSymbols;
+	Ar.Int(NumSymbols);
+
+	for(int i = 0; i < NumSymbols; i++)
+	{
+		Symbol_t Sym;
+		TransferSymbol(Ar, Sym);
+		Symbols.push_back(SymTable->RestoreSymbol(Sym));
+	}
+
+	Ar.SetSymbols(Symbols);
+
+	//fill in each node
+	CMirNodeTransfer<CMirReadArchive> Transfer(Ar);
+
+	for(int i = 0; i < NumNodes; i++)
+	{
+		int NumChildren;
+		Ar.Int(NumChildren);
+
+		for(int j = 0; j < NumChildren; j++)
+		{
+			CTreeNode *Child;
+			Ar.NodeRef(Child);
+			Nodes[i]->AddChild(Child);
+		}
+
+		Transfer.Visit(Nodes[i]);
+	}
+
+	CTreeNode *MirTree;
+	Ar.NodeRef(MirTree);
+	CGlobalDataStore::GetSingletonPtr()->Transfer(Ar);
+
+	SanityCheck(MirTree && Ar.AtEnd());
+	return MirTree;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+bool CMirCache::ComputeKey(const string &SourceFile)
+{
+	//FNV-1a and djb2 offsets
+	m_Key[0] = 2166136261u;
+	m_Key[1] = 5381;
+
+	if(!HashFile(SourceFile, m_Key))
+		return false;
+
+	//any change to the compiler could change the MIR it produces
+	//so the executable is part of the key too
+	char ExeName[MAX_PATH];
+
+	if(!GetModuleFileName(NULL, ExeName, MAX_PATH))
+		return false;
+
+	return HashFile(ExeName, m_Key);
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+bool CMirCache::HashFile(const string &File, unsigned int *Hash)
+{
+	if(!MapFile(File))
+		return false;
+
+	//the size goes in too so an empty file still changes the hash
+	unsigned int Size = (unsigned int)m_MappedSize;
+	HashBytes((const char*)&Size, sizeof(Size), Hash);
+	HashBytes(m_MappedView, m_MappedSize, Hash);
+
+	UnmapFile();
+	return true;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirCache::HashBytes(const char *Bytes, size_t Len, unsigned int *Hash)
+{
+	unsigned int Fnv = Hash[0];
+	unsigned int Djb = Hash[1];
+
+	for(size_t i = 0; i < Len; i++)
+	{
+		unsigned char Byte = (unsigned char)Bytes[i];
+
+		Fnv = (Fnv ^ Byte) * 16777619u;
+		Djb = (Djb * 33) ^ Byte;
+	}
+
+	Hash[0] = Fnv;
+	Hash[1] = Djb;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+bool CMirCache::MapFile(const string &File)
+{
+	UnmapFile();
+
+	m_MappedFile = CreateFile(File.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+	if(m_MappedFile == INVALID_HANDLE_VALUE)
+	{
+		m_MappedFile = NULL;
+		return false;
+	}
+
+	//an empty file can't be mapped but there's nothing to read anyway
+	m_MappedSize = GetFileSize(m_MappedFile, NULL);
+
+	if(m_MappedSize == 0)
+		return true;
+
+	m_FileMapping = CreateFileMapping(m_MappedFile, NULL, PAGE_READONLY, 0, 0, NULL);
+
+	if(m_FileMapping)
+		m_MappedView = (char*)MapViewOfFile(m_FileMapping, FILE_MAP_READ, 0, 0, 0);
+
+	if(!m_MappedView)
+	{
+		UnmapFile();
+		return false;
+	}
+
+	return true;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirCache::UnmapFile(void)
+{
+	if(m_MappedView)
+		UnmapViewOfFile(m_MappedView);
+
+	if(m_FileMapping)
+		CloseHandle(m_FileMapping);
+
+	if(m_MappedFile)
+		CloseHandle(m_MappedFile);
+
+	m_MappedView = NULL;
+	m_FileMapping = NULL;
+	m_MappedFile = NULL;
+	m_MappedSize = 0;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMirCache::UpdateStatistics(bool Hit)
+{
+	m_Hit = Hit;
+
+	if(Hit)
+		m_NumHits++;
+	else
+		m_NumMisses++;
+
+	ofstream StatsFile((m_CacheDir + "/stats.txt").c_str(), ios::out | ios::trunc);
+
+	if(StatsFile.is_open())
+		StatsFile << m_NumHits << " " << m_NumMisses << endl;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+string CMirCache::GetCacheFileName(void)
+{
+	char Name[32];
+	sprintf(Name, "%08x%08x.mir", m_Key[1], m_Key[0]);
+
+	return m_CacheDir + "/" + Name;
+}
+//-------------------------------------------------------------
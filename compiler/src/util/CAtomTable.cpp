@@ -0,0 +1,119 @@
+//------------------------------------------------------------------------------------------
+// File: CAtomTable.cpp
+// Desc: Interns the names of identifiers, temporaries and labels.
+// Auth: Lee Millward
+//------------------------------------------------------------------------------------------
+
+#include "StdHeader.h"
+#include "CAtomTable.h"
+
+//-------------------------------------------------------------
+CAtomTable::CAtomTable(void)
+{
+	m_Buckets.resize(256, NULL_ATOM);
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+Atom CAtomTable::Intern(const string &Name)
+{
+	unsigned int Hash = HashName(Name);
+	size_t Bucket = FindBucket(Name, Hash);
+
+	if(m_Buckets[Bucket] != NULL_ATOM)
+		return m_Buckets[Bucket];
+
+	//not seen this one before, give it the next atom
+	Atom NewAtom = (Atom)m_Names.size();
+	m_Names.push_back(Name);
+	m_Hashes.push_back(Hash);
+	m_Buckets[Bucket] = NewAtom;
+
+	//keep the load factor under a half so the probe sequences stay short
+	if(m_Names.size() * 2 > m_Buckets.size())
+		GrowBuckets();
+
+	return NewAtom;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+Atom CAtomTable::FindAtom(const string &Name)
+{
+	return m_Buckets[FindBucket(Name, HashName(Name))];
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+const string& CAtomTable::GetName(Atom Name)
+{
+	SanityCheck(Name >= 0 && Name < (Atom)m_Names.size());
+	return m_Names[Name];
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+unsigned int CAtomTable::GetNumAtoms(void)
+{
+	return (unsigned int)m_Names.size();
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+unsigned int CAtomTable::HashName(const string &Name)
+{
+	unsigned int Hash = 2166136261u;
+
+	for(size_t i = 0; i < Name.length(); i++)
+	{
+		Hash ^= (unsigned char)Name[i];
+		Hash *= 16777619u;
+	}
+
+	return Hash;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+size_t CAtomTable::FindBucket(const string &Name, unsigned int Hash)
+{
+	size_t Mask = m_Buckets.size() - 1;
+	size_t Bucket = Hash & Mask;
+
+	//linear probing, only compare the strings if the hashes match
+	while(m_Buckets[Bucket] != NULL_ATOM)
+	{
+		Atom Curr = m_Buckets[Bucket];
+
+		if(m_Hashes[Curr] == Hash && m_Names[Curr] == Name)
+			break;
+
+		Bucket = (Bucket + 1) & Mask;
+	}
+
+	return Bucket;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CAtomTable::GrowBuckets(void)
+{
+	m_Buckets.assign(m_Buckets.size() * 2, NULL_ATOM);
+	size_t Mask = m_Buckets.size() - 1;
+
+	//every name is already unique so just drop each one into the 
+	//first empty bucket from where it hashes to
+	for(size_t i = 0; i < m_Names.size(); i++)
+	{
+		size_t Bucket = m_Hashes[i] & Mask;
+
+		while(m_Buckets[Bucket] != NULL_ATOM)
+			Bucket = (Bucket + 1) & Mask;
+
+		m_Buckets[Bucket] = (Atom)i;
+	}
+}
+//-------------------------------------------------------------
+
+//singleton static member definition
+template<> CAtomTable* ISingleton<CAtomTable>::ms_Singleton = 0;
@@ -0,0 +1,97 @@
+//------------------------------------------------------------------------------------------
+// File: CMemoryArena.cpp
+// Desc: Bump pointer allocator for objects which all die at the same time.
+// Auth: Lee Millward
+//------------------------------------------------------------------------------------------
+
+#include "StdHeader.h"
+#include "CMemoryArena.h"
+
+//-------------------------------------------------------------
+CMemoryArena::CMemoryArena(size_t BlockSize) : m_Next(NULL), m_End(NULL), 
+	m_BlockSize(BlockSize), m_LastObject(NULL), m_NumObjects(0)
+{
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+CMemoryArena::~CMemoryArena(void)
+{
+	Release();
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void* CMemoryArena::Allocate(size_t Size, void (*Destructor)(void*))
+{
+	size_t HeaderSize = AlignSize(sizeof(ArenaObject_t));
+	size_t TotalSize = HeaderSize + AlignSize(Size);
+
+	//start a new block if this one's full, anything too big for
+	//a normal block gets one of it's own
+	if(m_Next == NULL || (size_t)(m_End - m_Next) < TotalSize)
+	{
+		size_t NewBlockSize = max(m_BlockSize, TotalSize);
+		char *NewBlock = new char[NewBlockSize];
+
+		m_Blocks.push_back(NewBlock);
+		m_Next = NewBlock;
+		m_End = NewBlock + NewBlockSize;
+	}
+
+	//link the object in so it's destructor can be run on release
+	ArenaObject_t *Header = (ArenaObject_t*)m_Next;
+	Header->Prev = m_LastObject;
+	Header->Destructor = Destructor;
+
+	m_LastObject = Header;
+	m_NumObjects++;
+
+	void *Mem = m_Next + HeaderSize;
+	m_Next += TotalSize;
+
+	return Mem;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CMemoryArena::Release(void)
+{
+	size_t HeaderSize = AlignSize(sizeof(ArenaObject_t));
+
+	//destroy the objects newest first, the reverse of the order
+	//they were created in
+	while(m_LastObject)
+	{
+		ArenaObject_t *Prev = m_LastObject->Prev;
+		m_LastObject->Destructor((char*)m_LastObject + HeaderSize);
+		m_LastObject = Prev;
+	}
+
+	//now hand the blocks back
+	vector<char*>::iterator Itr = m_Blocks.begin();
+	for(; Itr != m_Blocks.end(); Itr++)
+		delete [] (*Itr);
+
+	m_Blocks.clear();
+	m_Next = NULL;
+	m_End = NULL;
+	m_NumObjects = 0;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+unsigned int CMemoryArena::GetNumObjects(void)
+{
+	return m_NumObjects;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+size_t CMemoryArena::AlignSize(size_t Size)
+{
+	//align everything to the largest type any of our objects hold
+	const size_t Alignment = sizeof(double) > sizeof(void*) ? sizeof(double) : sizeof(void*);
+	return (Size + Alignment - 1) & ~(Alignment - 1);
+}
+//-------------------------------------------------------------
@@ -18,6 +18,9 @@
 #include "CCallExprTreeNode.h"
 #include "CFunctionDeclTreeNode.h"
 
+int CUtilFuncs::ms_TempNum = 0;
+int CUtilFuncs::ms_LabelNum = 0;
+
 //-------------------------------------------------------------
 string CUtilFuncs::TokenTypeToStr(TokenType Tok)
 {
@@ -171,22 +174,36 @@ TokenType CUtilFuncs::ConvertExprContextToTokenType(ExprContext Context)
 //-------------------------------------------------------------
 string CUtilFuncs::GenCompilerTempName(void)
 {
-	static int TempNum = 0;
-	stringstream RetStr;
+	char RetStr[32];
 
-	RetStr << "CompTemp." << TempNum++;
-	return RetStr.str();
+	sprintf(RetStr, "CompTemp.%d", ms_TempNum++);
+	return RetStr;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+bool CUtilFuncs::IsCompilerTempName(const string &Name)
+{
+	//the '.' can't appear in the name of a variable in the source
+	return Name.compare(0, 9, "CompTemp.") == 0;
 }
 //-------------------------------------------------------------
 
 //-------------------------------------------------------------
 string CUtilFuncs::GenNewLabel(void)
 {
-	static int LabelNum = 0;
-	stringstream RetStr;
+	char RetStr[32];
 
-	RetStr << "L" << LabelNum++;
-	return RetStr.str();
+	sprintf(RetStr, "L%d", ms_LabelNum++);
+	return RetStr;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CUtilFuncs::ResetGeneratedNames(void)
+{
+	ms_TempNum = 0;
+	ms_LabelNum = 0;
 }
 //-------------------------------------------------------------
 
@@ -228,10 +245,8 @@ CTreeNode* CUtilFuncs::GetDeclFromNode(CTreeNode *Node)
 		}
 	case TC_IDENTIFIER:
 		{
-			//look the identifier up in the symbol table
-			Symbol_t *Sym = CSymbolTable::GetSingletonPtr()->LookupIdentifier(
-				((CIdentifierTreeNode*)Node)->IdName, false);
-			
+			//follow the identifier to the symbol it was bound to
+			Symbol_t *Sym = ((CIdentifierTreeNode*)Node)->Binding;
 			SanityCheck(Sym);
 			return Sym->IdPtr;
 		}
@@ -240,8 +255,7 @@ CTreeNode* CUtilFuncs::GetDeclFromNode(CTreeNode *Node)
 		{
 			CCallExprTreeNode *CallExpr = (CCallExprTreeNode*)Node;
 
-			Symbol_t *FuncSym = CSymbolTable::GetSingletonPtr()->LookupIdentifier(
-				CallExpr->FuncName, false);
+			Symbol_t *FuncSym = CallExpr->Binding;
 			SanityCheck(FuncSym);
 
 			return FuncSym->IdPtr;
@@ -314,9 +328,8 @@ bool CUtilFuncs::ExprRefersToFloatingPointType(CTreeNode *Expr)
 		{
 			CCallExprTreeNode *CallExpr = (CCallExprTreeNode*)Expr;
 			
-			//lookup the function
-			Symbol_t *Sym = CSymbolTable::GetSingletonPtr()->LookupIdentifier(
-				CallExpr->FuncName, false);
+			//the function the call was bound to
+			Symbol_t *Sym = CallExpr->Binding;
 			SanityCheck(Sym);
 
 			//check the return type of the function
@@ -341,7 +354,12 @@ bool CompBasicBlocks::operator () (const BasicBlock_t *BbOne,
 bool CompIdentifiers::operator () (const CIdentifierTreeNode *IdOne, 
 																	 const CIdentifierTreeNode *IdTwo) const
 {
-	return strcmp(IdOne->IdName.c_str(), IdTwo->IdName.c_str()) < 0;
+	//names can be reused in sibling scopes so fall back on the symbol
+	//each one was bound to to tell those apart
+	if(IdOne->IdAtom != IdTwo->IdAtom)
+		return IdOne->IdAtom < IdTwo->IdAtom;
+
+	return IdOne->Binding < IdTwo->Binding;
 }
 //-------------------------------------------------------------
 
@@ -0,0 +1,135 @@
+//------------------------------------------------------------------------------------------
+// File: CXmlWriter.cpp
+// Desc: Writes an XML document straight out to a file one element at a time.
+// Auth: Lee Millward
+//------------------------------------------------------------------------------------------
+
+#include "StdHeader.h"
+#include "CXmlWriter.h"
+
+//-------------------------------------------------------------
+bool CXmlWriter::Open(const string &FileName)
+{
+	m_File.open(FileName.c_str(), ios::out | ios::trunc);
+	return m_File.is_open();
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CXmlWriter::Close(void)
+{
+	SanityCheck(m_OpenElements.empty());
+	m_File.close();
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CXmlWriter::OpenElement(const string &Name)
+{
+	BeginLine();
+	m_File << '<' << Name;
+
+	//the start tag is finished off by whatever comes next
+	m_OpenElements.push_back(Name);
+	m_StartTagOpen = true;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CXmlWriter::CloseElement(void)
+{
+	SanityCheck(!m_OpenElements.empty());
+
+	string Name = m_OpenElements.back();
+	m_OpenElements.pop_back();
+
+	//nothing was written inside it
+	if(m_StartTagOpen)
+	{
+		m_File << " />";
+		m_StartTagOpen = false;
+	}
+	else
+	{
+		m_File << '\n';
+
+		for(unsigned int i = 0; i < m_OpenElements.size(); i++)
+			m_File << "    ";
+
+		m_File << "</" << Name << '>';
+	}
+
+	//top level elements are each followed by a new line
+	if(m_OpenElements.empty())
+		m_File << '\n';
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CXmlWriter::WriteElement(const string &Name, const string &Text)
+{
+	BeginLine();
+
+	m_File << '<' << Name << '>';
+	WriteEscaped(Text);
+	m_File << "</" << Name << '>';
+
+	if(m_OpenElements.empty())
+		m_File << '\n';
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CXmlWriter::BeginLine(void)
+{
+	if(m_OpenElements.empty())
+		return;
+
+	FinishStartTag();
+	m_File << '\n';
+
+	for(unsigned int i = 0; i < m_OpenElements.size(); i++)
+		m_File << "    ";
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CXmlWriter::FinishStartTag(void)
+{
+	if(m_StartTagOpen)
+	{
+		m_File << '>';
+		m_StartTagOpen = false;
+	}
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+void CXmlWriter::WriteEscaped(const string &Text)
+{
+	for(unsigned int i = 0; i < Text.length(); i++)
+	{
+		unsigned char c = (unsigned char)Text[i];
+
+		switch(c)
+		{
+		case '&':  m_File << "&amp;"; break;
+		case '<':  m_File << "&lt;"; break;
+		case '>':  m_File << "&gt;"; break;
+		case '\"': m_File << "&quot;"; break;
+		case '\'': m_File << "&apos;"; break;
+
+		default:
+			//control characters are written as character references
+			if(c < 32)
+			{
+				char Ref[8];
+				sprintf(Ref, "&#x%02X;", c);
+				m_File << Ref;
+			}
+			else
+				m_File << (char)c;
+		}
+	}
+}
+//-------------------------------------------------------------
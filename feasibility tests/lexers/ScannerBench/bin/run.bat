@@ -0,0 +1,3 @@
+@echo Timing the compiler's scanner over a generated file full of comments
+ScannerBench.exe
+pause
@@ -0,0 +1,109 @@
+//------------------------------------------------------------------------------------------
+// File: Main.cpp
+// Desc: Times the compiler's scanner over a comment heavy source file
+// Auth: Lee Millward
+//------------------------------------------------------------------------------------------
+
+#include "StdHeader.h"
+#include "CLexicalScanner.h"
+
+//the generated file is big enough that the time spent opening
+//it is lost in the noise
+const long GeneratedFileSize = 7 * 1024 * 1024;
+
+//each scan is repeated and the quickest one reported
+const int NumRuns = 5;
+
+//-------------------------------------------------------------
+//write out a file which is mostly long block comments and indentation,
+//this is what the word at a time whitespace and comment skipping is for
+void GenerateSourceFile(const char *File)
+{
+	static const char *Words[] = { "loop", "counter", "updated", "here", "the",
+	                               "because", "of", "is", "reasons" };
+
+	ofstream Out(File);
+	unsigned long Seed = 1;
+	long Size = 0;
+
+	for(int Line = 0; Size < GeneratedFileSize; Line++)
+	{
+		stringstream Stmt;
+
+		//same simple LCG every time so runs on different builds can be compared
+		Seed = Seed * 1103515245 + 12345;
+		int NumWords = 50 + (Seed >> 16) % 200;
+
+		Stmt << "/*";
+
+		for(int i = 0; i < NumWords; i++)
+		{
+			Seed = Seed * 1103515245 + 12345;
+			Stmt << " " << Words[(Seed >> 16) % 9];
+		}
+
+		Stmt << "\n   * more text on a second line\n   */\n";
+		Stmt << string(8 * (Line % 8), ' ') << "x" << Line << " = x" << Line << " + " << Line << ";\n\n";
+
+		Out << Stmt.str();
+		Size += (long)Stmt.str().length();
+	}
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+//scan the whole file, returning the quickest time in seconds
+double TimeScanner(const char *File, bool MapFile, long &NumTokens)
+{
+	double Best = 0;
+
+	for(int Run = 0; Run < NumRuns; Run++)
+	{
+		CLexicalScanner *Scanner = new CLexicalScanner();
+		clock_t Start = clock();
+
+		Scanner->SetInputFile(File, MapFile);
+		NumTokens = 0;
+
+		while(Scanner->HasMoreTokens())
+		{
+			Scanner->GetNextToken();
+			NumTokens++;
+		}
+
+		double Time = (double)(clock() - Start) / CLOCKS_PER_SEC;
+		delete Scanner;
+
+		if(Run == 0 || Time < Best)
+			Best = Time;
+	}
+
+	return Best;
+}
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	//scan the file we're given, otherwise make one up
+	const char *File = "comments.txt";
+
+	if(argc > 1)
+		File = argv[1];
+	else
+		GenerateSourceFile(File);
+
+	long NumTokens;
+	double Time;
+
+	//the buffered scanner skips whitespace and comments a character at a time,
+	//scanning in place it's done a word at a time
+	Time = TimeScanner(File, false, NumTokens);
+	printf("buffered: %ld tokens in %.3fs\n", NumTokens, Time);
+
+	Time = TimeScanner(File, true, NumTokens);
+	printf("in place: %ld tokens in %.3fs\n", NumTokens, Time);
+
+	return 0;
+}
+//-------------------------------------------------------------